@@ -0,0 +1,27 @@
+#ifndef ADC_HAL_H
+#define ADC_HAL_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Hardware seam for the sampling engine: one ADC input behind an analog mux.
+// The ESP32 implementation streams conversions over DMA (Esp32AdcHal.h); the
+// synthetic one generates waveforms on the host (SyntheticAdcHal.h).
+class AdcHal {
+public:
+  virtual ~AdcHal() {}
+
+  virtual bool begin() = 0;
+
+  // Routes a mux channel (0-15) to the ADC. Conversions taken before the
+  // switch are dropped, so the next read() only returns the new channel.
+  virtual void selectChannel(uint8_t channel) = 0;
+
+  // Fills samples with up to count raw 12-bit conversions, waiting at most
+  // timeoutMs for them. Returns how many were written.
+  virtual size_t read(uint16_t* samples, size_t count, uint32_t timeoutMs) = 0;
+
+  virtual uint32_t sampleRateHz() const = 0;
+};
+
+#endif // ADC_HAL_H
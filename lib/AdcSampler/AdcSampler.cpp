@@ -0,0 +1,64 @@
+#include "AdcSampler.h"
+#include <Arduino.h>
+#include <cstring>
+
+AdcSampler::AdcSampler(AdcHal& hal, uint16_t oversample, uint16_t settle)
+  : hal(hal),
+    oversample(oversample == 0 ? 1 : oversample > ADC_MAX_OVERSAMPLE ? ADC_MAX_OVERSAMPLE : oversample),
+    settle(settle > ADC_MAX_OVERSAMPLE ? ADC_MAX_OVERSAMPLE : settle) {
+  memset(&frame, 0, sizeof(frame));
+}
+
+bool AdcSampler::begin(const uint8_t* channels, uint8_t count) {
+  if (count == 0 || count > ADC_MAX_CHANNELS) return false;
+  memset(&frame, 0, sizeof(frame));
+  frame.count = count;
+  memcpy(frame.channels, channels, count);
+  frame.samples = oversample;
+
+  // Default: one decimated value per sweep, i.e. the mean of the block
+  uint8_t shift = 0;
+  while (shift < FILTER_MAX_DECIMATE_SHIFT && (2u << shift) <= oversample) shift++;
+  ChannelFilterConfig mean = { shift, 1, FILTER_IIR_ONE };
+  for (uint8_t i = 0; i < ADC_MAX_CHANNELS; i++) filters[i].configure(mean);
+
+  return hal.begin();
+}
+
+bool AdcSampler::setFilter(uint8_t slot, const ChannelFilterConfig& config) {
+  if (slot >= frame.count) return false;
+  filters[slot].configure(config);
+  return true;
+}
+
+bool AdcSampler::sweep(AdcFrame& out, uint16_t slots) {
+  frame.startUs = micros();
+  frame.missing = 0;
+  frame.fresh = 0;
+
+  for (uint8_t i = 0; i < frame.count; i++) {
+    if (!((slots >> i) & 1u)) continue;
+    hal.selectChannel(frame.channels[i]);
+
+    // Let the mux output and the ADC's sample capacitor settle
+    if (settle && hal.read(scratch, settle, ADC_READ_TIMEOUT_MS) < settle) {
+      frame.missing++;
+      continue;
+    }
+
+    size_t got = hal.read(scratch, oversample, ADC_READ_TIMEOUT_MS);
+    if (got < oversample) {
+      frame.missing++;
+      continue;
+    }
+    filters[i].push(scratch, got);
+    frame.value[i] = filters[i].value();
+    frame.fresh |= 1u << i;
+  }
+
+  frame.durationUs = micros() - frame.startUs;
+  frame.sequence++;
+  frames.write(frame);
+  out = frame;
+  return frame.missing == 0;
+}
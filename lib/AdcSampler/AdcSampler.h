@@ -0,0 +1,69 @@
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "AdcHal.h"
+#include "ChannelFilter.h"
+#include "Seqlock.h"
+
+#define ADC_MAX_CHANNELS 16
+#define ADC_MAX_OVERSAMPLE 64
+#define ADC_DEFAULT_OVERSAMPLE 32
+#define ADC_DEFAULT_SETTLE 4   // conversions dropped after each mux switch
+#define ADC_READ_TIMEOUT_MS 20
+#define ADC_VALUE_FRAC_BITS FILTER_FRAC_BITS
+#define ADC_ALL_SLOTS 0xFFFF
+
+// One back-to-back pass over the configured channels
+struct AdcFrame {
+  uint32_t sequence;
+  uint32_t startUs;    // micros() when the sweep began
+  uint32_t durationUs;
+  uint8_t count;
+  uint8_t channels[ADC_MAX_CHANNELS]; // mux channel of each slot
+  uint16_t value[ADC_MAX_CHANNELS];   // filtered, ADC counts in Q4 (see adcCounts())
+  uint16_t samples;                   // conversions averaged per channel
+  uint16_t missing;                   // channels the HAL failed to deliver for
+  uint16_t fresh;                     // slots swept this time (bit per slot); the others hold older values
+};
+
+// Frame value in (fractional) ADC counts
+inline float adcCounts(uint16_t value) { return value / (float)(1 << ADC_VALUE_FRAC_BITS); }
+
+// Sweeps the mux channels through an AdcHal, runs each channel's conversions
+// through its ChannelFilter, and publishes complete frames through a seqlock so
+// any task can pick up the latest sweep without blocking the sampler.
+// Without setFilter() a channel reports the plain mean of each sweep.
+class AdcSampler {
+public:
+  explicit AdcSampler(AdcHal& hal, uint16_t oversample = ADC_DEFAULT_OVERSAMPLE, uint16_t settle = ADC_DEFAULT_SETTLE);
+
+  // Channels are swept in the given order. False if the list is empty or too long.
+  bool begin(const uint8_t* channels, uint8_t count);
+
+  // Replaces the filter of one slot (begin() order) and clears its history.
+  // Call after begin().
+  bool setFilter(uint8_t slot, const ChannelFilterConfig& config);
+
+  // Runs one sweep over the slots in the mask (bit per slot), publishes it and
+  // copies it to out. Slots left out, or that came back short (false), keep
+  // their previous value.
+  bool sweep(AdcFrame& out, uint16_t slots = ADC_ALL_SLOTS);
+
+  // Latest published frame; false if none yet or the writer kept racing us
+  bool latest(AdcFrame& out) const { return frames.read(out) && out.sequence != 0; }
+
+  uint32_t framesPublished() const { return frames.version(); }
+
+private:
+  AdcHal& hal;
+  uint16_t oversample;
+  uint16_t settle;
+  AdcFrame frame;
+  Seqlock<AdcFrame> frames;
+  uint16_t scratch[ADC_MAX_OVERSAMPLE];
+  ChannelFilter filters[ADC_MAX_CHANNELS];
+};
+
+#endif // ADC_SAMPLER_H
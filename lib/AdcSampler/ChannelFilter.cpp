@@ -0,0 +1,79 @@
+#include "ChannelFilter.h"
+
+ChannelFilter::ChannelFilter() {
+  ChannelFilterConfig passThrough = { 0, 1, FILTER_IIR_ONE };
+  configure(passThrough);
+}
+
+void ChannelFilter::configure(const ChannelFilterConfig& c) {
+  config = c;
+  if (config.decimateShift > FILTER_MAX_DECIMATE_SHIFT) config.decimateShift = FILTER_MAX_DECIMATE_SHIFT;
+  if (config.medianWindow < 1) config.medianWindow = 1;
+  if (config.medianWindow > FILTER_MEDIAN_MAX) config.medianWindow = FILTER_MEDIAN_MAX;
+  if ((config.medianWindow & 1) == 0) config.medianWindow--; // odd, so there is a middle
+  if (config.iirAlpha == 0 || config.iirAlpha > FILTER_IIR_ONE) config.iirAlpha = FILTER_IIR_ONE;
+  reset();
+}
+
+void ChannelFilter::reset() {
+  accum = 0;
+  accumCount = 0;
+  ringHead = 0;
+  ringFill = 0;
+  iirState = 0;
+  output = 0;
+  primed = false;
+}
+
+size_t ChannelFilter::push(const uint16_t* samples, size_t count) {
+  const uint8_t shift = config.decimateShift;
+  const uint8_t block = (uint8_t)(1u << shift);
+  size_t produced = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    accum += samples[i] & 0x0FFF;
+    if (++accumCount < block) continue;
+
+    // Mean in Q4, rounded; 64 x 4095 << 4 still fits easily in 32 bits
+    uint32_t q4 = ((accum << FILTER_FRAC_BITS) + (block >> 1)) >> shift;
+    accum = 0;
+    accumCount = 0;
+    decimated((uint16_t)q4);
+    produced++;
+  }
+  return produced;
+}
+
+void ChannelFilter::decimated(uint16_t x) {
+  if (config.medianWindow > 1) {
+    ring[ringHead] = x;
+    ringHead = (uint8_t)((ringHead + 1) % config.medianWindow);
+    if (ringFill < config.medianWindow) ringFill++;
+    x = median();
+  }
+
+  uint32_t target = (uint32_t)x << FILTER_IIR_BITS;
+  if (!primed || config.iirAlpha >= FILTER_IIR_ONE) {
+    iirState = target; // start from the first value instead of ramping up from 0
+  } else {
+    int64_t step = ((int64_t)target - (int64_t)iirState) * config.iirAlpha;
+    iirState = (uint32_t)((int64_t)iirState + (step >> 16));
+  }
+  output = (uint16_t)((iirState + (1u << (FILTER_IIR_BITS - 1))) >> FILTER_IIR_BITS);
+  primed = true;
+}
+
+// Median of what the ring holds so far (insertion sort; N <= 7)
+uint16_t ChannelFilter::median() const {
+  uint16_t sorted[FILTER_MEDIAN_MAX];
+  for (uint8_t i = 0; i < ringFill; i++) {
+    uint16_t v = ring[i];
+    uint8_t j = i;
+    while (j > 0 && sorted[j - 1] > v) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = v;
+  }
+  return sorted[ringFill / 2];
+}
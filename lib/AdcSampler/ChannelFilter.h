@@ -0,0 +1,64 @@
+#ifndef CHANNEL_FILTER_H
+#define CHANNEL_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Per-channel fixed-point filter chain, run on the raw conversions of one mux
+// channel in arrival order:
+//   1. oversample-and-decimate: average 2^decimateShift raw samples into one
+//      output with FILTER_FRAC_BITS fractional bits (noise acts as dither)
+//   2. median-of-N over the last N decimated values (spike rejection)
+//   3. single-pole IIR: y += alpha * (x - y), alpha in Q16
+// Outputs are ADC counts in Q4 (counts * 16); no floats, no heap.
+
+#define FILTER_FRAC_BITS 4
+#define FILTER_MAX_DECIMATE_SHIFT 6 // 64 samples per output
+#define FILTER_MEDIAN_MAX 7
+#define FILTER_IIR_ONE 65536u       // alpha = 1: IIR stage off
+#define FILTER_IIR_BITS 12          // extra state precision below Q4
+
+// Q16 smoothing factor from a constant in (0, 1]
+#define FILTER_ALPHA(a) ((uint32_t)((a) * 65536.0 + 0.5))
+
+struct ChannelFilterConfig {
+  uint8_t decimateShift; // average 2^shift raw samples per output, 0-6
+  uint8_t medianWindow;  // odd, 1 = off, up to FILTER_MEDIAN_MAX
+  uint32_t iirAlpha;     // Q16, FILTER_IIR_ONE = off
+};
+
+class ChannelFilter {
+public:
+  ChannelFilter();
+
+  // Clamps out-of-range settings and clears the history
+  void configure(const ChannelFilterConfig& config);
+  void reset();
+
+  // Feeds raw 12-bit samples; returns the number of decimated outputs produced
+  size_t push(const uint16_t* samples, size_t count);
+
+  // True once at least one output has been produced
+  bool ready() const { return primed; }
+
+  // Filtered value, ADC counts in Q4
+  uint16_t value() const { return output; }
+
+  const ChannelFilterConfig& settings() const { return config; }
+
+private:
+  void decimated(uint16_t x);
+  uint16_t median() const;
+
+  ChannelFilterConfig config;
+  uint32_t accum;
+  uint8_t accumCount;
+  uint16_t ring[FILTER_MEDIAN_MAX];
+  uint8_t ringHead;
+  uint8_t ringFill;
+  uint32_t iirState; // Q4 << FILTER_IIR_BITS
+  uint16_t output;
+  bool primed;
+};
+
+#endif // CHANNEL_FILTER_H
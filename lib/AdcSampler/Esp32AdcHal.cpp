@@ -0,0 +1,100 @@
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include "Esp32AdcHal.h"
+#include <driver/adc.h>
+
+#define ADC_HAL_DEBUG 1
+
+Esp32AdcHal::Esp32AdcHal(uint8_t adcPin, uint8_t s0, uint8_t s1, uint8_t s2, uint8_t s3)
+  : adcPin(adcPin), selectPins{s0, s1, s2, s3}, adcChannel(-1), selected(-1), running(false),
+    discard(0), chunkLen(0), chunkPos(0) {}
+
+bool Esp32AdcHal::begin() {
+  if (running) return true;
+
+  for (int i = 0; i < 4; i++) pinMode(selectPins[i], OUTPUT);
+
+  // Only ADC1 (GPIO32-39) can run alongside WiFi
+  adcChannel = digitalPinToAnalogChannel(adcPin);
+  if (adcChannel < 0 || adcChannel > 7) {
+    if (ADC_HAL_DEBUG) Serial.printf("ADC: pin %d is not on ADC1\n", adcPin);
+    return false;
+  }
+
+  adc_digi_init_config_t init = {};
+  init.max_store_buf_size = ESP32_ADC_POOL_BYTES;
+  init.conv_num_each_intr = ESP32_ADC_CHUNK_BYTES;
+  init.adc1_chan_mask = BIT(adcChannel);
+  init.adc2_chan_mask = 0;
+  if (adc_digi_initialize(&init) != ESP_OK) return false;
+
+  adc_digi_pattern_config_t pattern = {};
+  pattern.atten = ADC_ATTEN_DB_11; // full range (0-3.9V), as analogSetAttenuation(ADC_11db)
+  pattern.channel = adcChannel;
+  pattern.unit = 0; // ADC1
+  pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+  adc_digi_configuration_t config = {};
+  config.conv_limit_en = ADC_CONV_LIMIT_EN; // required on the ESP32
+  config.conv_limit_num = 250;
+  config.pattern_num = 1;
+  config.adc_pattern = &pattern;
+  config.sample_freq_hz = ESP32_ADC_SAMPLE_RATE;
+  config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+  if (adc_digi_controller_configure(&config) != ESP_OK || adc_digi_start() != ESP_OK) {
+    adc_digi_deinitialize();
+    return false;
+  }
+
+  running = true;
+  if (ADC_HAL_DEBUG) Serial.printf("ADC: DMA sampling GPIO%d (ADC1_CH%d) at %d Hz\n", adcPin, adcChannel, ESP32_ADC_SAMPLE_RATE);
+  return true;
+}
+
+void Esp32AdcHal::selectChannel(uint8_t channel) {
+  // Only the lines that differ: in Gray sweep order that is one per switch
+  uint8_t changed = selected < 0 ? 0x0F : (channel ^ selected) & 0x0F;
+  for (int i = 0; i < 4; i++) {
+    if ((changed >> i) & 1) digitalWrite(selectPins[i], (channel >> i) & 1);
+  }
+  selected = channel & 0x0F;
+
+  // Drop everything converted before the switch: the driver's pool, our
+  // partial chunk, and the chunk the DMA is filling right now.
+  uint32_t got = 0;
+  while (adc_digi_read_bytes(chunk, sizeof(chunk), &got, 0) == ESP_OK && got > 0) {}
+  chunkLen = chunkPos = 0;
+  discard = ESP32_ADC_CHUNK_BYTES / SOC_ADC_DIGI_RESULT_BYTES;
+}
+
+size_t Esp32AdcHal::read(uint16_t* samples, size_t count, uint32_t timeoutMs) {
+  if (!running) return 0;
+  size_t n = 0;
+  uint32_t start = millis();
+
+  while (n < count) {
+    if (chunkPos >= chunkLen) {
+      uint32_t elapsed = millis() - start;
+      if (elapsed >= timeoutMs) break;
+      uint32_t got = 0;
+      esp_err_t err = adc_digi_read_bytes(chunk, sizeof(chunk), &got, timeoutMs - elapsed);
+      if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) break; // INVALID_STATE: pool overflowed, data still valid
+      chunkLen = got;
+      chunkPos = 0;
+      continue;
+    }
+
+    const adc_digi_output_data_t* out = (const adc_digi_output_data_t*)(chunk + chunkPos);
+    chunkPos += SOC_ADC_DIGI_RESULT_BYTES;
+    if (out->type1.channel != adcChannel) continue;
+    if (discard) {
+      discard--;
+      continue;
+    }
+    samples[n++] = out->type1.data;
+  }
+  return n;
+}
+
+#endif // ARDUINO_ARCH_ESP32
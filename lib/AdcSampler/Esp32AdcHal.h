@@ -0,0 +1,39 @@
+#ifndef ESP32_ADC_HAL_H
+#define ESP32_ADC_HAL_H
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <Arduino.h>
+#include "AdcHal.h"
+
+#define ESP32_ADC_SAMPLE_RATE 40000 // Hz; the ESP32 DMA path accepts 20 kHz-2 MHz
+#define ESP32_ADC_CHUNK_BYTES 64    // DMA bytes per interrupt (2 per conversion)
+#define ESP32_ADC_POOL_BYTES 1024
+
+// ADC1 in continuous (I2S/DMA) mode on the mux output pin, plus the four mux
+// select lines. Uses the IDF 4.4 adc_digi driver that ships with Arduino-ESP32
+// 2.x; analogRead() must not be used on ADC1 while this is running.
+class Esp32AdcHal : public AdcHal {
+public:
+  Esp32AdcHal(uint8_t adcPin, uint8_t s0, uint8_t s1, uint8_t s2, uint8_t s3);
+
+  bool begin() override;
+  void selectChannel(uint8_t channel) override;
+  size_t read(uint16_t* samples, size_t count, uint32_t timeoutMs) override;
+  uint32_t sampleRateHz() const override { return ESP32_ADC_SAMPLE_RATE; }
+
+private:
+  uint8_t adcPin;
+  uint8_t selectPins[4];
+  int8_t adcChannel;
+  int8_t selected;  // channel on the select lines, -1 before the first switch
+  bool running;
+  size_t discard;   // conversions still to drop after a mux switch
+  uint8_t chunk[ESP32_ADC_CHUNK_BYTES];
+  size_t chunkLen;  // bytes in chunk
+  size_t chunkPos;  // next unread byte
+};
+
+#endif // ARDUINO_ARCH_ESP32
+
+#endif // ESP32_ADC_HAL_H
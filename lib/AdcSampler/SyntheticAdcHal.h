@@ -0,0 +1,67 @@
+#ifndef SYNTHETIC_ADC_HAL_H
+#define SYNTHETIC_ADC_HAL_H
+
+#include <cmath>
+#include <cstring>
+#include "AdcHal.h"
+
+// Host stand-in for the mux + ADC: each channel produces offset + a sine of the
+// given amplitude/period + uniform noise, plus an optional step at the end of
+// every pulse period, clamped to 12 bits. Time advances one sample per
+// conversion, so a sweep sees the same stream the DMA would.
+struct SyntheticWaveform {
+  float offset;          // counts
+  float amplitude;       // counts
+  uint32_t periodSamples; // 0 = DC
+  uint16_t noise;         // peak counts
+  uint32_t pulseEvery;    // conversions, 0 = no pulses
+  uint32_t pulseLength;   // conversions at the end of each period
+  float pulse;            // counts added during a pulse
+};
+
+class SyntheticAdcHal : public AdcHal {
+public:
+  explicit SyntheticAdcHal(uint32_t sampleRate = 40000) : rate(sampleRate), selected(0), clock(0), rng(2463534242u) {
+    memset(waves, 0, sizeof(waves));
+  }
+
+  void setWaveform(uint8_t channel, const SyntheticWaveform& wave) {
+    if (channel < 16) waves[channel] = wave;
+  }
+
+  bool begin() override { return true; }
+  void selectChannel(uint8_t channel) override { selected = channel & 0x0F; }
+
+  size_t read(uint16_t* samples, size_t count, uint32_t) override {
+    const SyntheticWaveform& w = waves[selected];
+    for (size_t i = 0; i < count; i++, clock++) {
+      float v = w.offset;
+      if (w.periodSamples) v += w.amplitude * sinf(6.2831853f * (float)(clock % w.periodSamples) / (float)w.periodSamples);
+      if (w.pulseEvery && clock % w.pulseEvery >= w.pulseEvery - w.pulseLength) v += w.pulse;
+      if (w.noise) v += (float)((int32_t)(nextRandom() % (2u * w.noise + 1)) - (int32_t)w.noise);
+      samples[i] = v <= 0 ? 0 : v >= 4095 ? 4095 : (uint16_t)(v + 0.5f);
+    }
+    return count;
+  }
+
+  uint32_t sampleRateHz() const override { return rate; }
+
+  // Simulated time, in conversions since start
+  uint32_t conversions() const { return clock; }
+
+private:
+  uint32_t nextRandom() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+  }
+
+  SyntheticWaveform waves[16];
+  uint32_t rate;
+  uint8_t selected;
+  uint32_t clock;
+  uint32_t rng;
+};
+
+#endif // SYNTHETIC_ADC_HAL_H
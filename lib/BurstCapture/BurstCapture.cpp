@@ -0,0 +1,282 @@
+#include "BurstCapture.h"
+#include <cstring>
+
+// -------- Rules --------
+BurstConfig defaultBurstConfig() {
+  static const BurstRule board[] = {
+    {1, 1450, 0, 160}, // battery current
+    {5, 1280, 0, 160}, // charg current
+  };
+  BurstConfig config;
+  memset(&config, 0, sizeof(config));
+  config.version = BURST_FORMAT_VERSION;
+  config.count = sizeof(board) / sizeof(board[0]);
+  memcpy(config.rules, board, sizeof(board));
+  return config;
+}
+
+bool validBurstConfig(const BurstConfig& config) {
+  if (config.version != BURST_FORMAT_VERSION || config.count > BURST_MAX_RULES) return false;
+  uint32_t channels = 0;
+  for (uint8_t i = 0; i < config.count; i++) {
+    const BurstRule& r = config.rules[i];
+    if (r.channel >= 16 || (channels >> r.channel) & 1u) return false;
+    if (r.above == 0 && r.below == 0 && r.slope == 0) return false;
+    if (r.above > 4095 || r.below > 4095 || r.slope > 4095) return false;
+    channels |= 1u << r.channel;
+  }
+  return true;
+}
+
+int findBurstRule(const BurstConfig& config, uint8_t channel) {
+  for (uint8_t i = 0; i < config.count && i < BURST_MAX_RULES; i++) {
+    if (config.rules[i].channel == channel) return i;
+  }
+  return -1;
+}
+
+bool setBurstRule(BurstConfig& config, const BurstRule& rule) {
+  int i = findBurstRule(config, rule.channel);
+  if (i < 0) {
+    if (config.count >= BURST_MAX_RULES) return false;
+    i = config.count++;
+  }
+  config.rules[i] = rule;
+  return true;
+}
+
+bool removeBurstRule(BurstConfig& config, uint8_t channel) {
+  int i = findBurstRule(config, channel);
+  if (i < 0) return false;
+  config.count--;
+  memmove(&config.rules[i], &config.rules[i + 1], (config.count - i) * sizeof(BurstRule));
+  memset(&config.rules[config.count], 0, sizeof(BurstRule));
+  return true;
+}
+
+// -------- Capture --------
+BurstCapture::BurstCapture()
+  : appliedVersion(0), turn(0), capture_rule(-1), post_remaining(0), record_ready(false), trigger_count(0),
+    capture_count(0), dropped_count(0) {
+  memset(&active, 0, sizeof(active));
+  memset(rings, 0, sizeof(rings));
+  memset(&record, 0, sizeof(record));
+  pending.write(defaultBurstConfig());
+}
+
+bool BurstCapture::setConfig(const BurstConfig& config) {
+  if (!validBurstConfig(config)) return false;
+  pending.write(config);
+  return true;
+}
+
+BurstConfig BurstCapture::config() const {
+  BurstConfig config = active;
+  pending.read(config);
+  return config;
+}
+
+// New rules start with empty rings; a window in progress is abandoned
+void BurstCapture::refreshConfig() {
+  uint32_t version = pending.version();
+  BurstConfig config;
+  if (version == appliedVersion || !pending.read(config)) return;
+  appliedVersion = version;
+  active = config;
+  memset(rings, 0, sizeof(rings));
+  turn = 0;
+  capture_rule = -1;
+  post_remaining = 0;
+}
+
+int BurstCapture::nextChannel() {
+  refreshConfig();
+  if (capture_rule >= 0) return active.rules[capture_rule].channel;
+  if (active.count == 0) return -1;
+  if (turn >= active.count) turn = 0;
+  return active.rules[turn++].channel;
+}
+
+void BurstCapture::feed(uint8_t channel, const uint16_t* raw, size_t n, uint32_t startUs, uint32_t startMs, bool gap) {
+  int rule = findBurstRule(active, channel);
+  if (rule < 0) return;
+  for (size_t i = 0; i + BURST_DECIMATE <= n; i += BURST_DECIMATE) {
+    uint32_t sum = 0;
+    for (size_t j = 0; j < BURST_DECIMATE; j++) sum += raw[i + j];
+    uint32_t offsetUs = (uint32_t)(i / BURST_DECIMATE) * BURST_TICK_US;
+    uint16_t value = (uint16_t)((sum << 4) / BURST_DECIMATE); // Q4
+    sample(rule, value, (uint16_t)((startUs + offsetUs) / BURST_TICK_US), startMs + offsetUs / 1000, gap && i == 0);
+  }
+}
+
+void BurstCapture::sample(uint8_t rule, uint16_t value, uint16_t tick, uint32_t ms, bool gap) {
+  Ring& ring = rings[rule];
+
+  // Mid-window: straight into the record, no tests
+  if (capture_rule == (int8_t)rule && post_remaining > 0) {
+    record.value[record.count] = value;
+    record.tick[record.count] = tick;
+    record.count++;
+    if (--post_remaining == 0) {
+      capture_rule = -1;
+      capture_count++;
+      record_ready.store(true, std::memory_order_release);
+    }
+    ring.hasPrevious = false;
+    return;
+  }
+
+  const BurstRule& r = active.rules[rule];
+  uint16_t counts = value >> 4;
+  uint8_t cause = 0;
+  if (r.above && counts >= r.above) cause |= BURST_ABOVE;
+  if (r.below && counts <= r.below) cause |= BURST_BELOW;
+  if (r.slope && ring.hasPrevious && !gap) {
+    uint16_t previous = ring.previous >> 4;
+    uint16_t step = counts > previous ? counts - previous : previous - counts;
+    if (step >= r.slope) cause |= BURST_SLOPE;
+  }
+  ring.previous = value;
+  ring.hasPrevious = true;
+
+  ring.value[ring.head] = value;
+  ring.tick[ring.head] = tick;
+  ring.head = (ring.head + 1) % BURST_PRE_SAMPLES;
+  if (ring.fill < BURST_PRE_SAMPLES) ring.fill++;
+
+  if (!cause) {
+    ring.armed = true;
+    return;
+  }
+  if (!ring.armed || capture_rule >= 0) return;
+  ring.armed = false;
+  trigger(rule, cause, ms);
+}
+
+// The ring (trigger sample last) becomes the head of the record; the rest
+// comes from the post window
+void BurstCapture::trigger(uint8_t rule, uint8_t cause, uint32_t ms) {
+  trigger_count++;
+  if (record_ready.load(std::memory_order_acquire)) {
+    dropped_count++;
+    return;
+  }
+  Ring& ring = rings[rule];
+  uint16_t first = (ring.head + BURST_PRE_SAMPLES - ring.fill) % BURST_PRE_SAMPLES;
+  for (uint16_t i = 0; i < ring.fill; i++) {
+    uint16_t at = (first + i) % BURST_PRE_SAMPLES;
+    record.value[i] = ring.value[at];
+    record.tick[i] = ring.tick[at];
+  }
+  record.channel = active.rules[rule].channel;
+  record.cause = cause;
+  record.count = ring.fill;
+  record.triggerIndex = ring.fill - 1;
+  record.triggerMs = ms;
+  ring.fill = 0;
+  capture_rule = rule;
+  post_remaining = BURST_POST_SAMPLES;
+}
+
+// -------- Blob --------
+// Counts every byte of an encoding and stores those that fall in
+// [skip, skip + size), so one pass sizes it and later ones fill it piecewise
+struct BlobWriter {
+  uint8_t* out;
+  size_t skip, size, at;
+  void put(uint8_t b) {
+    if (at >= skip && at - skip < size) out[at - skip] = b;
+    at++;
+  }
+  void varint(uint32_t v) {
+    do {
+      put((uint8_t)((v & 0x7F) | (v > 0x7F ? 0x80 : 0)));
+      v >>= 7;
+    } while (v);
+  }
+};
+
+static bool getVarint(const uint8_t* data, size_t length, size_t& at, uint32_t& v) {
+  v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (at >= length) return false;
+    uint8_t b = data[at++];
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+static uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// version, channel, cause, then varints: tick us, trigger ms, count, trigger
+// index, first tick; then runs of (ticks skipped, length, value deltas...)
+static size_t writeBurst(const BurstRecord& record, BlobWriter& w) {
+  if (record.count > BURST_MAX_SAMPLES) return 0;
+  w.put(BURST_FORMAT_VERSION);
+  w.put(record.channel);
+  w.put(record.cause);
+  uint32_t header[] = { BURST_TICK_US, record.triggerMs, record.count, record.triggerIndex,
+                        record.count ? record.tick[0] : 0u };
+  for (uint32_t v : header) w.varint(v);
+
+  uint16_t previous = 0;
+  for (uint16_t i = 0; i < record.count;) {
+    uint16_t skipped = i ? (uint16_t)(record.tick[i] - record.tick[i - 1] - 1) : 0;
+    uint16_t end = i + 1;
+    while (end < record.count && (uint16_t)(record.tick[end] - record.tick[end - 1]) == 1) end++;
+    w.varint(skipped);
+    w.varint(end - i);
+    for (; i < end; i++) {
+      w.varint(zigzag((int32_t)record.value[i] - previous));
+      previous = record.value[i];
+    }
+  }
+  return w.at;
+}
+
+size_t encodeBurst(const BurstRecord& record, uint8_t* out, size_t outSize) {
+  BlobWriter w = { out, 0, outSize, 0 };
+  size_t length = writeBurst(record, w);
+  return length <= outSize ? length : 0;
+}
+
+size_t encodeBurstPart(const BurstRecord& record, size_t offset, uint8_t* out, size_t outSize) {
+  BlobWriter w = { out, offset, outSize, 0 };
+  return writeBurst(record, w);
+}
+
+bool decodeBurst(const uint8_t* data, size_t length, BurstRecord& out) {
+  if (length < 3 || data[0] != BURST_FORMAT_VERSION) return false;
+  out.channel = data[1];
+  out.cause = data[2];
+  size_t at = 3;
+  uint32_t tickUs, triggerMs, count, triggerIndex, tick;
+  if (!getVarint(data, length, at, tickUs) || !getVarint(data, length, at, triggerMs) ||
+      !getVarint(data, length, at, count) || !getVarint(data, length, at, triggerIndex) ||
+      !getVarint(data, length, at, tick)) {
+    return false;
+  }
+  if (tickUs != BURST_TICK_US || count > BURST_MAX_SAMPLES || (count && triggerIndex >= count)) return false;
+  out.triggerMs = triggerMs;
+  out.count = (uint16_t)count;
+  out.triggerIndex = (uint16_t)triggerIndex;
+
+  uint16_t previous = 0;
+  for (uint32_t i = 0; i < count;) {
+    uint32_t skipped, run;
+    if (!getVarint(data, length, at, skipped) || !getVarint(data, length, at, run)) return false;
+    if (run == 0 || run > count - i) return false;
+    if (i) tick += skipped + 1;
+    for (uint32_t j = 0; j < run; j++, i++) {
+      uint32_t delta;
+      if (!getVarint(data, length, at, delta)) return false;
+      previous = (uint16_t)(previous + unzigzag(delta));
+      out.value[i] = previous;
+      out.tick[i] = (uint16_t)(tick + j);
+    }
+    tick += run - 1;
+  }
+  return at == length;
+}
@@ -0,0 +1,149 @@
+#ifndef BURST_CAPTURE_H
+#define BURST_CAPTURE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Seqlock.h"
+
+// Event-triggered capture of fast transients (inrush, faults) that fall
+// between the 1 s sweeps. Between sweeps the sensor task parks the mux on the
+// armed channels (BurstWatcher) and feeds their conversions here, decimated to
+// BURST_RATE_HZ. Every sample goes into the channel's pre-trigger ring and is
+// checked against the channel's rule; the first one that fires freezes the
+// ring plus BURST_POST_SAMPLES more from that channel alone into a
+// BurstRecord, which another task publishes and then releases.
+
+#define BURST_MAX_RULES 4
+#define BURST_DECIMATE 8        // conversions averaged per sample
+#define BURST_RATE_HZ 5000      // samples/s at the ESP32 HAL's 40 kHz
+#define BURST_TICK_US (1000000 / BURST_RATE_HZ)
+#define BURST_PRE_SAMPLES 512   // up to the trigger, ~100 ms of the channel's own samples
+#define BURST_POST_SAMPLES 1024 // after it, ~200 ms without gaps
+#define BURST_MAX_SAMPLES (BURST_PRE_SAMPLES + BURST_POST_SAMPLES)
+#define BURST_FORMAT_VERSION 1  // bump when BurstConfig or the blob format changes
+
+// Why a rule fired (bits)
+enum BurstCause : uint8_t {
+  BURST_ABOVE = 1, // sample >= above
+  BURST_BELOW = 2, // sample <= below
+  BURST_SLOPE = 4  // |sample - previous sample| >= slope
+};
+
+// Thresholds in ADC counts (the decimated mean), 0 = that test is off
+struct BurstRule {
+  uint8_t channel; // mux channel
+  uint16_t above;
+  uint16_t below;
+  uint16_t slope;  // counts per sample (1 / BURST_RATE_HZ)
+};
+
+// Plain data, stored in NVS as-is
+struct BurstConfig {
+  uint8_t version;
+  uint8_t count;
+  BurstRule rules[BURST_MAX_RULES];
+};
+
+// Battery (ch1) and charger (ch5) current: ~12 A on the ACS712-30A
+// (82 counts/A over the channel's offset), or a 2 A step within one sample
+BurstConfig defaultBurstConfig();
+
+// Rules on distinct channels 0-15, each with at least one test on
+bool validBurstConfig(const BurstConfig& config);
+
+// Replaces the rule on the same channel or appends it; false if full
+bool setBurstRule(BurstConfig& config, const BurstRule& rule);
+// False if no rule is on that channel
+bool removeBurstRule(BurstConfig& config, uint8_t channel);
+// Index of the rule on a channel, -1 if none
+int findBurstRule(const BurstConfig& config, uint8_t channel);
+
+// A frozen window. Samples are in time order; ticks (1 / BURST_RATE_HZ each,
+// wrapping) place them in time, so the gaps in the pre-trigger part, when the
+// mux was on other armed channels, are kept.
+struct BurstRecord {
+  uint8_t channel;
+  uint8_t cause;          // BurstCause bits
+  uint16_t count;
+  uint16_t triggerIndex;  // sample that fired
+  uint32_t triggerMs;     // millis() of that sample
+  uint16_t value[BURST_MAX_SAMPLES]; // counts in Q4, like AdcFrame
+  uint16_t tick[BURST_MAX_SAMPLES];
+};
+
+// Compact form for MQTT: a small header, then runs of consecutive ticks with
+// each value as a zigzag varint delta from the one before (1 byte per sample
+// on a quiet signal, 2 on a steep edge). Returns the length, 0 if out is too
+// small; BURST_BLOB_MAX always fits, however the samples are spread.
+#define BURST_BLOB_MAX (24 + BURST_MAX_SAMPLES * 9)
+size_t encodeBurst(const BurstRecord& record, uint8_t* out, size_t outSize);
+// The same encoding from byte offset on, at most outSize bytes of it, for
+// streaming it out in small pieces instead of holding all of it. Returns the
+// full length (0 for a bad record), so (record, 0, nullptr, 0) just sizes it.
+size_t encodeBurstPart(const BurstRecord& record, size_t offset, uint8_t* out, size_t outSize);
+
+// Host/server side of the above
+bool decodeBurst(const uint8_t* data, size_t length, BurstRecord& out);
+
+class BurstCapture {
+public:
+  BurstCapture();
+
+  // False (and nothing changed) if not valid. Any task; taken up by the
+  // watcher between samples.
+  bool setConfig(const BurstConfig& config);
+  BurstConfig config() const;
+
+  // Watcher: channel to read next, -1 if no rule is armed. While a window is
+  // being captured that is its channel; otherwise the armed channels take
+  // turns, one block each.
+  int nextChannel();
+
+  // Watcher: n raw conversions of one channel, back to back, averaged by
+  // BURST_DECIMATE (a partial group at the end is dropped). The first was
+  // taken at startUs / startMs. After a mux switch pass gap, so no slope is
+  // computed across it.
+  void feed(uint8_t channel, const uint16_t* raw, size_t n, uint32_t startUs, uint32_t startMs, bool gap);
+
+  bool capturing() const { return post_remaining > 0; }
+
+  // Consumer (any one task): the frozen window, nullptr if none; release()
+  // once it has been published so the next trigger can capture
+  const BurstRecord* ready() const { return record_ready.load(std::memory_order_acquire) ? &record : nullptr; }
+  void release() { record_ready.store(false, std::memory_order_release); }
+
+  uint32_t triggers() const { return trigger_count; }
+  uint32_t captures() const { return capture_count; }
+  uint32_t dropped() const { return dropped_count; } // fired while the last window was still unpublished
+
+private:
+  struct Ring {
+    uint16_t value[BURST_PRE_SAMPLES];
+    uint16_t tick[BURST_PRE_SAMPLES];
+    uint16_t head;
+    uint16_t fill;
+    bool hasPrevious;
+    uint16_t previous;
+    bool armed;         // fires again only after a sample that passes every test
+  };
+
+  void refreshConfig();
+  void sample(uint8_t rule, uint16_t value, uint16_t tick, uint32_t ms, bool gap);
+  void trigger(uint8_t rule, uint8_t cause, uint32_t ms);
+
+  Seqlock<BurstConfig> pending;
+  uint32_t appliedVersion;
+  BurstConfig active;
+  Ring rings[BURST_MAX_RULES];
+  uint8_t turn;          // rule whose channel is watched next
+  int8_t capture_rule;   // rule being captured, -1 if none
+  uint16_t post_remaining;
+  BurstRecord record;
+  std::atomic<bool> record_ready;
+  uint32_t trigger_count;
+  uint32_t capture_count;
+  uint32_t dropped_count;
+};
+
+#endif // BURST_CAPTURE_H
@@ -0,0 +1,49 @@
+#include "BurstWatcher.h"
+#include <Arduino.h>
+
+BurstWatcher::BurstWatcher(AdcHal& hal, BurstCapture& capture)
+  : hal(hal), capture(capture), block_count(0), short_reads(0) {}
+
+void BurstWatcher::watch(uint32_t durationMs) {
+  uint32_t startUs = micros(), startMs = millis();
+  uint32_t rate = hal.sampleRateHz();
+  uint64_t budget = (uint64_t)durationMs * rate / 1000;
+  uint64_t done = 0;
+  int current = -1;
+
+  while (true) {
+    int channel = capture.nextChannel();
+    if (channel < 0) break;
+
+    // The sweep left the mux elsewhere, so the first block is always a switch.
+    // Only whole decimation groups that fit the budget are read, so the next
+    // sweep is not held up.
+    bool gap = channel != current;
+    if (budget - done < (gap ? ADC_DEFAULT_SETTLE : 0) + BURST_DECIMATE) break;
+    if (gap) {
+      hal.selectChannel((uint8_t)channel);
+      current = channel;
+      size_t settled = hal.read(block, ADC_DEFAULT_SETTLE, ADC_READ_TIMEOUT_MS);
+      done += settled;
+      if (settled < ADC_DEFAULT_SETTLE) {
+        short_reads++;
+        break;
+      }
+    }
+
+    uint64_t left = budget - done;
+    size_t want = left < BURST_BLOCK ? (size_t)(left - left % BURST_DECIMATE) : BURST_BLOCK;
+    size_t got = hal.read(block, want, ADC_READ_TIMEOUT_MS);
+    uint32_t offsetUs = (uint32_t)(done * 1000000 / rate);
+    capture.feed((uint8_t)channel, block, got, startUs + offsetUs, startMs + offsetUs / 1000, gap);
+    done += got;
+    block_count++;
+    if (got < want) {
+      short_reads++;
+      break;
+    }
+  }
+
+  uint32_t watchedMs = (uint32_t)(done * 1000 / rate);
+  if (watchedMs < durationMs) vTaskDelay((durationMs - watchedMs) / portTICK_PERIOD_MS);
+}
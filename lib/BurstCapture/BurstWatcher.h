@@ -0,0 +1,37 @@
+#ifndef BURST_WATCHER_H
+#define BURST_WATCHER_H
+
+#include <cstdint>
+#include "AdcHal.h"
+#include "AdcSampler.h"
+#include "BurstCapture.h"
+
+#define BURST_BLOCK 256 // conversions per read (6.4 ms at 40 kHz), a multiple of BURST_DECIMATE
+
+// Spends the sensor task's idle time between sweeps reading the armed
+// channels at the full ADC rate into a BurstCapture. It runs in the task that
+// owns the AdcHal, so it never contends with the sweep for the mux, and
+// returns in time for the next one.
+class BurstWatcher {
+public:
+  BurstWatcher(AdcHal& hal, BurstCapture& capture);
+
+  // Watches for durationMs, then returns, cutting the last block short rather
+  // than running over. Time is counted in conversions (the DMA runs off the
+  // crystal), so sample times are exact within a block and within a settle
+  // period across mux switches. With no rule armed, or once the HAL stops
+  // delivering, it just sleeps out the rest.
+  void watch(uint32_t durationMs);
+
+  uint32_t blocks() const { return block_count; }
+  uint32_t shortReads() const { return short_reads; }
+
+private:
+  AdcHal& hal;
+  BurstCapture& capture;
+  uint16_t block[BURST_BLOCK];
+  uint32_t block_count;
+  uint32_t short_reads;
+};
+
+#endif // BURST_WATCHER_H
@@ -0,0 +1,165 @@
+#include "Calibration.h"
+#include "SensorMath.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#define NOMINAL_FULL_SCALE_MV 3900.0f // 11dB attenuation, used without eFuse data
+
+ChannelCalibration makeCalibration(CalibrationKind kind, uint8_t channel) {
+  ChannelCalibration cal;
+  memset(&cal, 0, sizeof(cal));
+  cal.version = CAL_FORMAT_VERSION;
+  cal.kind = kind;
+  cal.channel = channel;
+  cal.gain = 1.0f;
+  return cal;
+}
+
+static float rawToX(uint16_t raw, bool useEfuse, RawToMillivolts toMillivolts) {
+  if (!useEfuse) return raw;
+  if (toMillivolts) return (float)toMillivolts(raw);
+  return raw * NOMINAL_FULL_SCALE_MV / 4095.0f;
+}
+
+// -------- Fitting --------
+bool fitCalibration(const CalibrationPoint* points, uint8_t count, bool piecewise, bool useEfuse,
+                    RawToMillivolts toMillivolts, ChannelCalibration& out) {
+  if (count < 2) return false;
+  if (count > CAL_MAX_POINTS) count = CAL_MAX_POINTS;
+
+  CalibrationPoint sorted[CAL_MAX_POINTS];
+  for (uint8_t i = 0; i < count; i++) {
+    CalibrationPoint p = points[i];
+    p.x = rawToX((uint16_t)(p.x + 0.5f), useEfuse, toMillivolts);
+    uint8_t j = i;
+    while (j > 0 && sorted[j - 1].x > p.x) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = p;
+  }
+
+  ChannelCalibration cal = makeCalibration(piecewise ? CAL_POINTS : CAL_LINEAR, out.channel);
+  cal.useEfuse = useEfuse;
+  cal.zeroBelow = out.zeroBelow;
+
+  if (piecewise) {
+    for (uint8_t i = 1; i < count; i++) {
+      if (sorted[i].x == sorted[i - 1].x) return false; // two values for one reading
+    }
+    cal.pointCount = count;
+    memcpy(cal.points, sorted, count * sizeof(CalibrationPoint));
+  } else {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      sx += sorted[i].x;
+      sy += sorted[i].value;
+      sxx += (double)sorted[i].x * sorted[i].x;
+      sxy += (double)sorted[i].x * sorted[i].value;
+    }
+    double denom = count * sxx - sx * sx;
+    if (fabs(denom) < 1e-9) return false;
+    cal.gain = (float)((count * sxy - sx * sy) / denom);
+    cal.offset = (float)((sy - cal.gain * sx) / count);
+  }
+
+  out = cal;
+  return true;
+}
+
+// -------- Tables --------
+CalibrationTables::CalibrationTables() : toMillivolts(nullptr) {
+  for (uint8_t ch = 0; ch < CAL_MAX_CHANNELS; ch++) {
+    curves[ch] = makeCalibration(CAL_LINEAR, ch);
+    tables[ch] = nullptr;
+    owns[ch] = false;
+  }
+}
+
+CalibrationTables::~CalibrationTables() { release(); }
+
+bool CalibrationTables::set(uint8_t channel, const ChannelCalibration& cal) {
+  if (channel >= CAL_MAX_CHANNELS || cal.version != CAL_FORMAT_VERSION || cal.kind > CAL_POINTS) return false;
+  if (cal.kind == CAL_POINTS && (cal.pointCount < 2 || cal.pointCount > CAL_MAX_POINTS)) return false;
+  curves[channel] = cal;
+  curves[channel].channel = channel;
+  return true;
+}
+
+void CalibrationTables::release() {
+  for (uint8_t ch = 0; ch < CAL_MAX_CHANNELS; ch++) {
+    if (owns[ch]) free(tables[ch]);
+    tables[ch] = nullptr;
+    owns[ch] = false;
+  }
+}
+
+size_t CalibrationTables::tableCount() const {
+  size_t n = 0;
+  for (uint8_t ch = 0; ch < CAL_MAX_CHANNELS; ch++) n += owns[ch];
+  return n;
+}
+
+float CalibrationTables::evaluate(const ChannelCalibration& cal, uint16_t raw) const {
+  float v;
+  switch (cal.kind) {
+    case CAL_DEFAULT_VOLTAGE:
+      return sensorVoltage(raw); // carries its own "below 5 V reads 0" rule
+    case CAL_DEFAULT_CURRENT:
+      return sensorCurrent(raw, cal.channel);
+    case CAL_LINEAR:
+      v = cal.gain * rawToX(raw, cal.useEfuse, toMillivolts) + cal.offset;
+      break;
+    case CAL_POINTS: {
+      float x = rawToX(raw, cal.useEfuse, toMillivolts);
+      const CalibrationPoint* p = cal.points;
+      uint8_t n = cal.pointCount;
+      // Extrapolate the end segments
+      uint8_t seg = 0;
+      while (seg + 2 < n && x > p[seg + 1].x) seg++;
+      float t = (x - p[seg].x) / (p[seg + 1].x - p[seg].x);
+      v = p[seg].value + t * (p[seg + 1].value - p[seg].value);
+      break;
+    }
+    default:
+      return 0;
+  }
+  return v < cal.zeroBelow ? 0 : v;
+}
+
+bool CalibrationTables::compile(const uint8_t* channels, uint8_t count) {
+  release();
+  bool ok = true;
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t ch = channels[i] & (CAL_MAX_CHANNELS - 1);
+    if (tables[ch]) continue; // listed twice
+
+    // The channel number only changes the result for the built-in current curve
+    ChannelCalibration key = curves[ch];
+    if (key.kind != CAL_DEFAULT_CURRENT) key.channel = 0;
+
+    for (uint8_t j = 0; j < i && !tables[ch]; j++) {
+      uint8_t other = channels[j] & (CAL_MAX_CHANNELS - 1);
+      ChannelCalibration otherKey = curves[other];
+      if (otherKey.kind != CAL_DEFAULT_CURRENT) otherKey.channel = 0;
+      if (tables[other] && memcmp(&key, &otherKey, sizeof(key)) == 0) tables[ch] = tables[other];
+    }
+    if (tables[ch]) continue;
+
+    int16_t* table = (int16_t*)malloc(CAL_TABLE_SIZE * sizeof(int16_t));
+    if (!table) {
+      ok = false;
+      continue;
+    }
+    for (uint16_t raw = 0; raw < CAL_TABLE_SIZE; raw++) {
+      float v = evaluate(curves[ch], raw);
+      float scaled = v <= 0 ? 0 : roundf(v * CAL_SCALE);
+      table[raw] = (int16_t)(scaled > 32767 ? 32767 : scaled);
+    }
+    tables[ch] = table;
+    owns[ch] = true;
+  }
+  return ok;
+}
@@ -0,0 +1,100 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Per-channel ADC calibration. Each mux channel has a curve (built-in formula,
+// gain/offset line, or piecewise-linear points) which compile() turns into a
+// 4096-entry raw-count -> value table, so converting a sample is a table
+// lookup plus an integer interpolation. Channels with identical curves share a
+// table.
+
+#define CAL_MAX_CHANNELS 16
+#define CAL_MAX_POINTS 8
+#define CAL_TABLE_SIZE 4096
+#define CAL_SCALE 100        // table entries are value * CAL_SCALE (0.01 units)
+#define CAL_FRAC_BITS 4      // convert() takes ADC counts in Q4 (AdcFrame values)
+#define CAL_FORMAT_VERSION 1 // bump when ChannelCalibration changes layout
+
+enum CalibrationKind : uint8_t {
+  CAL_DEFAULT_VOLTAGE, // sensorVoltage() from SensorMath.h
+  CAL_DEFAULT_CURRENT, // sensorCurrent() with this channel's built-in offset
+  CAL_LINEAR,          // gain * x + offset
+  CAL_POINTS           // piecewise linear through points, sorted by x
+};
+
+struct CalibrationPoint {
+  float x;     // raw ADC counts, or millivolts when useEfuse is set
+  float value; // engineering units (V, A)
+};
+
+// Plain data, stored in NVS as-is. Always start from makeCalibration() so the
+// padding is zeroed and curves can be compared with memcmp.
+struct ChannelCalibration {
+  uint8_t version;
+  CalibrationKind kind;
+  uint8_t channel;    // mux channel (only matters for CAL_DEFAULT_CURRENT)
+  uint8_t useEfuse;   // x is eFuse-characterised millivolts instead of raw counts
+  uint8_t pointCount;
+  float gain;
+  float offset;
+  float zeroBelow;    // results below this read as 0; negatives always clamp to 0
+  CalibrationPoint points[CAL_MAX_POINTS];
+};
+
+ChannelCalibration makeCalibration(CalibrationKind kind, uint8_t channel);
+
+// Least-squares line through the points (n >= 2, x not all equal), or with
+// piecewise set, a curve through up to CAL_MAX_POINTS of them sorted by x.
+// Points are in raw counts; useEfuse converts them to millivolts first. out's
+// channel and zeroBelow are kept, everything else is replaced.
+typedef uint32_t (*RawToMillivolts)(uint16_t raw);
+bool fitCalibration(const CalibrationPoint* points, uint8_t count, bool piecewise, bool useEfuse,
+                    RawToMillivolts toMillivolts, ChannelCalibration& out);
+
+class CalibrationTables {
+public:
+  CalibrationTables();
+  ~CalibrationTables();
+
+  // eFuse ADC characterisation for useEfuse curves; without it, millivolts are
+  // assumed linear over the 11dB range
+  void setMillivoltsConverter(RawToMillivolts fn) { toMillivolts = fn; }
+
+  // Replaces a channel's curve; takes effect at the next compile()
+  bool set(uint8_t channel, const ChannelCalibration& cal);
+  const ChannelCalibration& get(uint8_t channel) const { return curves[channel & (CAL_MAX_CHANNELS - 1)]; }
+
+  // (Re)builds the tables for the given channels. False if out of memory; the
+  // affected channels then convert to 0.
+  bool compile(const uint8_t* channels, uint8_t count);
+
+  // ADC counts in Q4 -> value * CAL_SCALE
+  int32_t convert(uint8_t channel, uint16_t q4) const {
+    const int16_t* table = tables[channel & (CAL_MAX_CHANNELS - 1)];
+    if (!table) return 0;
+    uint32_t i = q4 >> CAL_FRAC_BITS;
+    if (i >= CAL_TABLE_SIZE - 1) return table[CAL_TABLE_SIZE - 1];
+    int32_t a = table[i];
+    int32_t b = table[i + 1];
+    // No interpolation across a zeroed region ("below 5 V reads 0")
+    if (a == 0 || b == 0) return a;
+    int32_t frac = q4 & ((1 << CAL_FRAC_BITS) - 1);
+    return a + (((b - a) * frac) >> CAL_FRAC_BITS);
+  }
+
+  size_t tableCount() const;
+  size_t tableBytes() const { return tableCount() * CAL_TABLE_SIZE * sizeof(int16_t); }
+
+private:
+  void release();
+  float evaluate(const ChannelCalibration& cal, uint16_t raw) const;
+
+  ChannelCalibration curves[CAL_MAX_CHANNELS];
+  int16_t* tables[CAL_MAX_CHANNELS]; // may alias: channels with equal curves share
+  bool owns[CAL_MAX_CHANNELS];
+  RawToMillivolts toMillivolts;
+};
+
+#endif // CALIBRATION_H
@@ -0,0 +1,71 @@
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include "CalibrationStore.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <esp_adc_cal.h>
+
+#define CAL_DEBUG 1
+#define CAL_NAMESPACE "calib"
+#define CAL_DEFAULT_VREF 1100 // mV, used if the eFuse has no Vref
+
+static Preferences calPrefs;
+
+static void channelKey(uint8_t channel, char* key) {
+  snprintf(key, 8, "ch%u", channel);
+}
+
+uint8_t loadCalibration(CalibrationTables& tables, const uint8_t* channels, uint8_t count) {
+  uint8_t found = 0;
+  if (!calPrefs.begin(CAL_NAMESPACE, true)) return 0; // nothing stored yet
+
+  for (uint8_t i = 0; i < count; i++) {
+    char key[8];
+    channelKey(channels[i], key);
+    ChannelCalibration cal;
+    if (calPrefs.getBytesLength(key) != sizeof(cal)) continue;
+    calPrefs.getBytes(key, &cal, sizeof(cal));
+    if (tables.set(channels[i], cal)) {
+      found++;
+    } else if (CAL_DEBUG) {
+      Serial.printf("Calibration for ch%u ignored (format %u)\n", channels[i], cal.version);
+    }
+  }
+  calPrefs.end();
+  return found;
+}
+
+bool saveCalibration(uint8_t channel, const ChannelCalibration& cal) {
+  if (!calPrefs.begin(CAL_NAMESPACE, false)) return false;
+  char key[8];
+  channelKey(channel, key);
+  bool ok = calPrefs.putBytes(key, &cal, sizeof(cal)) == sizeof(cal);
+  calPrefs.end();
+  return ok;
+}
+
+bool eraseCalibration(uint8_t channel) {
+  if (!calPrefs.begin(CAL_NAMESPACE, false)) return false;
+  char key[8];
+  channelKey(channel, key);
+  bool ok = !calPrefs.isKey(key) || calPrefs.remove(key);
+  calPrefs.end();
+  return ok;
+}
+
+uint32_t efuseMillivolts(uint16_t raw) {
+  static esp_adc_cal_characteristics_t chars;
+  static bool characterised = false;
+  if (!characterised) {
+    esp_adc_cal_value_t source = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, CAL_DEFAULT_VREF, &chars);
+    characterised = true;
+    if (CAL_DEBUG) {
+      Serial.printf("ADC characterised from %s\n",
+                    source == ESP_ADC_CAL_VAL_EFUSE_TP ? "eFuse two-point" :
+                    source == ESP_ADC_CAL_VAL_EFUSE_VREF ? "eFuse Vref" : "default Vref");
+    }
+  }
+  return esp_adc_cal_raw_to_voltage(raw, &chars);
+}
+
+#endif // ARDUINO_ARCH_ESP32
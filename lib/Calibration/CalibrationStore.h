@@ -0,0 +1,22 @@
+#ifndef CALIBRATION_STORE_H
+#define CALIBRATION_STORE_H
+
+#include "Calibration.h"
+
+// NVS persistence ("calib" namespace, one blob per mux channel) and the eFuse
+// ADC characterisation. ESP32 only.
+
+// Overrides the curves of the listed channels with any stored ones; returns
+// how many were found
+uint8_t loadCalibration(CalibrationTables& tables, const uint8_t* channels, uint8_t count);
+
+bool saveCalibration(uint8_t channel, const ChannelCalibration& cal);
+
+// Forgets a channel's stored curve (it falls back to the built-in one)
+bool eraseCalibration(uint8_t channel);
+
+// Raw 12-bit ADC1 reading at 11dB -> millivolts, using the chip's eFuse Vref or
+// two-point data. Characterised once on first use.
+uint32_t efuseMillivolts(uint16_t raw);
+
+#endif // CALIBRATION_STORE_H
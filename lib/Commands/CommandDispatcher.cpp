@@ -0,0 +1,28 @@
+#include "CommandDispatcher.h"
+
+CommandResult dispatchCommand(const char* payload, size_t length, const CommandHandler* handlers, size_t handlerCount) {
+  JsonToken tokens[COMMAND_MAX_TOKENS];
+  int count = jsonTokenize(payload, length, tokens, COMMAND_MAX_TOKENS);
+  if (count < 1 || tokens[0].type != JSON_TOK_OBJECT) return CMD_PARSE_ERROR;
+
+  JsonView view(payload, tokens, count);
+  int cmd = view.find("cmd");
+  if (cmd < 0) return CMD_UNKNOWN;
+
+  for (size_t i = 0; i < handlerCount; i++) {
+    if (view.isString(cmd, handlers[i].name)) {
+      return handlers[i].handle(view) ? CMD_OK : CMD_BAD_ARGS;
+    }
+  }
+  return CMD_UNKNOWN;
+}
+
+const char* commandResultName(CommandResult result) {
+  switch (result) {
+    case CMD_OK: return "ok";
+    case CMD_PARSE_ERROR: return "parse error";
+    case CMD_UNKNOWN: return "unknown command";
+    case CMD_BAD_ARGS: return "bad arguments";
+    default: return "?";
+  }
+}
@@ -0,0 +1,30 @@
+#ifndef COMMAND_DISPATCHER_H
+#define COMMAND_DISPATCHER_H
+
+#include <cstddef>
+#include "JsonTokenizer.h"
+
+// Inbound commands are small JSON objects naming the command in "cmd", e.g.
+//   {"cmd":"interval","ms":10000}
+// The handler gets a view over the tokenized message for its arguments.
+
+#define COMMAND_MAX_TOKENS 24
+
+enum CommandResult {
+  CMD_OK,
+  CMD_PARSE_ERROR, // not a JSON object, or too many tokens
+  CMD_UNKNOWN,     // missing or unrecognised "cmd"
+  CMD_BAD_ARGS     // handler rejected the arguments
+};
+
+struct CommandHandler {
+  const char* name;
+  bool (*handle)(const JsonView& args);
+};
+
+// Tokenizes payload in place (no copy, no heap) and runs the matching handler
+CommandResult dispatchCommand(const char* payload, size_t length, const CommandHandler* handlers, size_t handlerCount);
+
+const char* commandResultName(CommandResult result);
+
+#endif // COMMAND_DISPATCHER_H
@@ -0,0 +1,251 @@
+#include "JsonTokenizer.h"
+#include <cstring>
+
+static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+static bool isHex(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// Scans a string starting after the opening quote; returns the index of the
+// closing quote, or a JsonParseError
+static int scanString(const char* js, size_t length, size_t pos) {
+  for (size_t i = pos; i < length; i++) {
+    char c = js[i];
+    if (c == '"') return (int)i;
+    if ((unsigned char)c < 0x20) return JSON_ERROR_INVALID;
+    if (c == '\\') {
+      if (++i >= length) return JSON_ERROR_PARTIAL;
+      switch (js[i]) {
+        case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+          break;
+        case 'u':
+          for (int k = 0; k < 4; k++) {
+            if (++i >= length) return JSON_ERROR_PARTIAL;
+            if (!isHex(js[i])) return JSON_ERROR_INVALID;
+          }
+          break;
+        default:
+          return JSON_ERROR_INVALID;
+      }
+    }
+  }
+  return JSON_ERROR_PARTIAL;
+}
+
+// Validates a number per the JSON grammar
+static bool validNumber(const char* s, size_t n) {
+  size_t i = 0;
+  if (i < n && s[i] == '-') i++;
+  if (i >= n) return false;
+  if (s[i] == '0') {
+    i++;
+  } else if (s[i] >= '1' && s[i] <= '9') {
+    while (i < n && s[i] >= '0' && s[i] <= '9') i++;
+  } else {
+    return false;
+  }
+  if (i < n && s[i] == '.') {
+    i++;
+    if (i >= n || s[i] < '0' || s[i] > '9') return false;
+    while (i < n && s[i] >= '0' && s[i] <= '9') i++;
+  }
+  if (i < n && (s[i] == 'e' || s[i] == 'E')) {
+    i++;
+    if (i < n && (s[i] == '+' || s[i] == '-')) i++;
+    if (i >= n || s[i] < '0' || s[i] > '9') return false;
+    while (i < n && s[i] >= '0' && s[i] <= '9') i++;
+  }
+  return i == n;
+}
+
+static bool validPrimitive(const char* s, size_t n) {
+  if (n == 4 && (memcmp(s, "true", 4) == 0 || memcmp(s, "null", 4) == 0)) return true;
+  if (n == 5 && memcmp(s, "false", 5) == 0) return true;
+  return validNumber(s, n);
+}
+
+int jsonTokenize(const char* js, size_t length, JsonToken* tokens, int maxTokens) {
+  enum Expect { EXPECT_VALUE, EXPECT_KEY, EXPECT_COLON, EXPECT_COMMA, EXPECT_END };
+
+  if (length > 0xFFFF) return JSON_ERROR_INVALID;
+
+  int count = 0;
+  int parent = -1;
+  Expect expect = EXPECT_VALUE;
+  bool justOpened = false; // container opened and still empty: a close is allowed
+
+  for (size_t i = 0; i < length; i++) {
+    char c = js[i];
+    if (isSpace(c)) continue;
+
+    // --- Closing a container ---
+    if ((c == '}' || c == ']') &&
+        (expect == EXPECT_COMMA || (justOpened && (expect == EXPECT_KEY || expect == EXPECT_VALUE)))) {
+      if (parent < 0) return JSON_ERROR_INVALID;
+      JsonTokenType want = c == '}' ? JSON_TOK_OBJECT : JSON_TOK_ARRAY;
+      if (tokens[parent].type != want) return JSON_ERROR_INVALID;
+      tokens[parent].end = (uint16_t)(i + 1);
+      parent = tokens[parent].parent;
+      expect = parent < 0 ? EXPECT_END : EXPECT_COMMA;
+      justOpened = false;
+      continue;
+    }
+
+    switch (expect) {
+      case EXPECT_END:
+        return JSON_ERROR_INVALID; // trailing data after the document
+
+      case EXPECT_COLON:
+        if (c != ':') return JSON_ERROR_INVALID;
+        expect = EXPECT_VALUE;
+        continue;
+
+      case EXPECT_COMMA:
+        if (c != ',') return JSON_ERROR_INVALID;
+        expect = tokens[parent].type == JSON_TOK_OBJECT ? EXPECT_KEY : EXPECT_VALUE;
+        continue;
+
+      case EXPECT_KEY:
+        if (c != '"') return JSON_ERROR_INVALID;
+        break;
+
+      case EXPECT_VALUE:
+        break;
+    }
+
+    // --- A new token (key or value) ---
+    if (count >= maxTokens) return JSON_ERROR_NOMEM;
+    JsonToken& tok = tokens[count];
+    tok.parent = (int16_t)parent;
+    tok.size = 0;
+    tok.start = (uint16_t)i;
+    bool isKey = expect == EXPECT_KEY;
+    if (parent >= 0 && (isKey || tokens[parent].type == JSON_TOK_ARRAY)) tokens[parent].size++;
+    justOpened = false;
+
+    if (c == '{' || c == '[') {
+      tok.type = c == '{' ? JSON_TOK_OBJECT : JSON_TOK_ARRAY;
+      tok.end = 0;
+      parent = count++;
+      expect = c == '{' ? EXPECT_KEY : EXPECT_VALUE;
+      justOpened = true;
+      continue;
+    }
+
+    if (c == '"') {
+      int close = scanString(js, length, i + 1);
+      if (close < 0) return close;
+      tok.type = JSON_TOK_STRING;
+      tok.start = (uint16_t)(i + 1);
+      tok.end = (uint16_t)close;
+      i = (size_t)close;
+    } else if (isKey) {
+      return JSON_ERROR_INVALID;
+    } else {
+      size_t j = i;
+      while (j < length && !isSpace(js[j]) && js[j] != ',' && js[j] != ']' && js[j] != '}' && js[j] != ':') j++;
+      if (!validPrimitive(js + i, j - i)) {
+        return (j == length && j - i < 5) ? JSON_ERROR_PARTIAL : JSON_ERROR_INVALID;
+      }
+      tok.type = JSON_TOK_PRIMITIVE;
+      tok.end = (uint16_t)j;
+      i = j - 1;
+    }
+    count++;
+
+    if (isKey) expect = EXPECT_COLON;
+    else expect = parent < 0 ? EXPECT_END : EXPECT_COMMA;
+  }
+
+  return expect == EXPECT_END ? count : JSON_ERROR_PARTIAL;
+}
+
+// -------- JsonView --------
+bool JsonView::tokenEquals(int tok, const char* s) const {
+  size_t n = tokens[tok].end - tokens[tok].start;
+  return strlen(s) == n && memcmp(js + tokens[tok].start, s, n) == 0;
+}
+
+int JsonView::find(const char* key) const {
+  if (count < 1 || tokens[0].type != JSON_TOK_OBJECT) return -1;
+  int i = 1;
+  while (i + 1 < count) {
+    int value = i + 1;
+    if (tokens[i].type == JSON_TOK_STRING && tokens[i].parent == 0 && tokenEquals(i, key)) return value;
+    // Skip the value's subtree: every token that starts inside it
+    int next = value + 1;
+    if (tokens[value].type == JSON_TOK_OBJECT || tokens[value].type == JSON_TOK_ARRAY) {
+      while (next < count && tokens[next].start < tokens[value].end) next++;
+    }
+    i = next;
+  }
+  return -1;
+}
+
+bool JsonView::isString(int tok, const char* value) const {
+  return tok >= 0 && tok < count && tokens[tok].type == JSON_TOK_STRING && tokenEquals(tok, value);
+}
+
+bool JsonView::getString(const char* key, const char*& value, size_t& length) const {
+  int tok = find(key);
+  if (tok < 0 || tokens[tok].type != JSON_TOK_STRING) return false;
+  value = js + tokens[tok].start;
+  length = tokens[tok].end - tokens[tok].start;
+  return true;
+}
+
+bool JsonView::getInt(const char* key, long& value) const { return toInt(find(key), value); }
+bool JsonView::getFloat(const char* key, float& value) const { return toFloat(find(key), value); }
+
+bool JsonView::getBool(const char* key, bool& value) const {
+  int tok = find(key);
+  if (tok < 0 || tokens[tok].type != JSON_TOK_PRIMITIVE) return false;
+  if (tokenEquals(tok, "true")) value = true;
+  else if (tokenEquals(tok, "false")) value = false;
+  else return false;
+  return true;
+}
+
+bool JsonView::toInt(int tok, long& value) const {
+  if (tok < 0 || tok >= count || tokens[tok].type != JSON_TOK_PRIMITIVE) return false;
+  const char* p = js + tokens[tok].start;
+  const char* end = js + tokens[tok].end;
+  bool negative = p < end && *p == '-';
+  if (negative) p++;
+  if (p >= end) return false;
+  unsigned long v = 0;
+  for (; p < end; p++) {
+    if (*p < '0' || *p > '9') return false; // fractions/exponents are not integers
+    unsigned long next = v * 10 + (unsigned long)(*p - '0');
+    if (next / 10 != v || next > 0x7FFFFFFFul) return false;
+    v = next;
+  }
+  value = negative ? -(long)v : (long)v;
+  return true;
+}
+
+bool JsonView::toFloat(int tok, float& value) const {
+  if (tok < 0 || tok >= count || tokens[tok].type != JSON_TOK_PRIMITIVE) return false;
+  const char* p = js + tokens[tok].start;
+  const char* end = js + tokens[tok].end;
+  if (!validNumber(p, end - p)) return false;
+  bool negative = *p == '-';
+  if (negative) p++;
+  float v = 0.0f;
+  for (; p < end && *p >= '0' && *p <= '9'; p++) v = v * 10.0f + (float)(*p - '0');
+  if (p < end && *p == '.') {
+    float scale = 0.1f;
+    for (p++; p < end && *p >= '0' && *p <= '9'; p++, scale *= 0.1f) v += (float)(*p - '0') * scale;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    p++;
+    bool negExp = p < end && *p == '-';
+    if (p < end && (*p == '+' || *p == '-')) p++;
+    int e = 0;
+    for (; p < end && e < 64; p++) e = e * 10 + (*p - '0');
+    while (e-- > 0) v = negExp ? v * 0.1f : v * 10.0f;
+  }
+  value = negative ? -v : v;
+  return true;
+}
@@ -0,0 +1,62 @@
+#ifndef JSON_TOKENIZER_H
+#define JSON_TOKENIZER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// In-place JSON tokenizer (jsmn-style). It never copies or allocates: tokens are
+// offsets into the caller's buffer, which does not need to be NUL-terminated, so
+// it can run directly over PubSubClient's receive buffer.
+
+enum JsonTokenType : uint8_t {
+  JSON_TOK_OBJECT,
+  JSON_TOK_ARRAY,
+  JSON_TOK_STRING,    // start/end exclude the quotes; escapes are left as-is
+  JSON_TOK_PRIMITIVE  // number, true, false or null
+};
+
+struct JsonToken {
+  JsonTokenType type;
+  uint16_t start;
+  uint16_t end;    // one past the last byte
+  uint16_t size;   // objects: number of keys, arrays: number of elements
+  int16_t parent;  // index of the enclosing container, -1 for the root
+};
+
+enum JsonParseError {
+  JSON_ERROR_INVALID = -1, // malformed input
+  JSON_ERROR_NOMEM = -2,   // more tokens than the caller provided
+  JSON_ERROR_PARTIAL = -3  // input ended inside a value
+};
+
+// Tokenizes one JSON document. Returns the number of tokens used, or a
+// JsonParseError. Inputs longer than 65535 bytes are rejected.
+int jsonTokenize(const char* js, size_t length, JsonToken* tokens, int maxTokens);
+
+// Read-only accessors over a tokenized document whose root is an object
+class JsonView {
+public:
+  JsonView(const char* js, const JsonToken* tokens, int count) : js(js), tokens(tokens), count(count) {}
+
+  // Index of the value token for a top-level key, or -1
+  int find(const char* key) const;
+
+  bool isString(int tok, const char* value) const;
+  bool getString(const char* key, const char*& value, size_t& length) const;
+  bool getInt(const char* key, long& value) const;
+  bool getFloat(const char* key, float& value) const;
+  bool getBool(const char* key, bool& value) const;
+
+  // Parse a primitive token without needing a NUL terminator
+  bool toInt(int tok, long& value) const;
+  bool toFloat(int tok, float& value) const;
+
+private:
+  bool tokenEquals(int tok, const char* s) const;
+
+  const char* js;
+  const JsonToken* tokens;
+  int count;
+};
+
+#endif // JSON_TOKENIZER_H
@@ -16,8 +16,6 @@
 #define CHARACTERISTIC_UUID_GPRS_USER "beb5483e-36e1-4688-b7f5-ea07361b26b8"
 #define CHARACTERISTIC_UUID_GPRS_PASS "beb5483e-36e1-4688-b7f5-ea07361b26b9"
 
-#define PUBLISH_DELAY 5000
-
 // Signal strength thresholds
 const int WIFI_RSSI_THRESHOLD = -70; // dBm
 const int CELLULAR_CSQ_THRESHOLD = 10; // 0-31 scale
@@ -30,6 +28,13 @@ TinyGsmClient gsmClient(modem);
 
 PubSubClient mqttClient;
 WiFiClient wifiClient;
+
+// The task's work between its delays (network waits included), and the two
+// calls in it that can block for seconds (Profiler.h)
+PROFILE_SPAN(connectivitySpan, "conn.task");
+PROFILE_SPAN(monitorSpan, "conn.monitor");
+PROFILE_SPAN(mqttConnectSpan, "conn.mqtt_connect");
+
 Preferences prefs;
 
 // Single instances for BLE callbacks to prevent memory leaks
@@ -51,6 +56,8 @@ struct BleHandles {
 // Define the global status object here, as declared in the header
 Status status;
 
+static MqttMessageHandler messageHandler = nullptr;
+
 // Forward declaration for the function in main.cpp
 // void startWebServer();
 
@@ -262,18 +269,37 @@ bool connectCellular() {
     }
 }
 
+void setMqttMessageHandler(MqttMessageHandler handler) {
+  messageHandler = handler;
+}
+
 void mqttCallback(char* topic, byte* payload, unsigned int length) {
-  if (length >= sizeof(status.lastReceivedMessage)) {
-    length = sizeof(status.lastReceivedMessage) - 1; // Prevent buffer overflow
+  if (DEBUG) Serial.printf("Received on %s: %.*s\n", topic, (int)length, (const char*)payload);
+  // Handled in place: the payload is only valid until we return
+  if (messageHandler) messageHandler((const char*)payload, length);
+}
+
+// Telemetry is published from the client's buffer, which must hold the whole
+// packet: the largest frame on the longest telemetry topic. PubSubClient's
+// default 256 B is smaller than a full JSON keyframe.
+static size_t telemetryPacketMax() {
+  const char* topics[] = {config.publishTopic, config.publishTopicDelta, config.publishTopicCbor,
+                          config.publishTopicCborDelta, config.publishTopicBackfill};
+  size_t largest = 0;
+  for (size_t i = 0; i < sizeof(topics) / sizeof(topics[0]); i++) {
+    size_t size = mqttPacketSize(topics[i], TELEMETRY_PAYLOAD_MAX);
+    if (size > largest) largest = size;
   }
-  strncpy(status.lastReceivedMessage, (char*)payload, length);
-  status.lastReceivedMessage[length] = '\0'; // Null-terminate
-  if (DEBUG) Serial.println("Received on " + String(topic) + ": " + String(status.lastReceivedMessage));
+  return largest;
 }
 
 void connectMQTT() {
+  PROFILE_SCOPE(mqttConnectSpan);
   mqttClient.setServer(config.broker, config.mqttPort);
   mqttClient.setCallback(mqttCallback);
+  if (mqttClient.getBufferSize() < telemetryPacketMax() && !mqttClient.setBufferSize(telemetryPacketMax())) {
+    Serial.println("MQTT buffer allocation failed");
+  }
   if (status.activeConnection == "WiFi") {
     status.wifiRssi = WiFi.RSSI();
     // if (DEBUG) Serial.println("WiFi connected, RSSI: " + String(status.wifiRssi));
@@ -285,6 +311,7 @@ void connectMQTT() {
   }
   if (mqttClient.connect(config.clientId, config.mqttUsername, config.mqttPassword)) {
     status.mqttConnected = true;
+    status.mqttSessions++;
     mqttClient.subscribe(config.subscribeTopic);
     if (DEBUG) Serial.println("MQTT Connected, Subscribed to: " + String(config.subscribeTopic));
   } else {
@@ -294,6 +321,7 @@ void connectMQTT() {
 }
 
 void monitorConnectivity() {
+  PROFILE_SCOPE(monitorSpan);
   // Handle BLE updates
   if (status.bleDeviceConnected && status.wifiCredentialsUpdated) {
     status.wifiCredentialsUpdated = false;
@@ -383,13 +411,12 @@ void monitorConnectivityTask(void *pvParameters) {
   loadGprsCredentials();
   setupBLE();
   // wifiClient.setCACert(emqx_ca);
+  PROFILE_TASK(connectivitySpan);
   
   while (1) {
-    // stack watermark
-    // UBaseType_t stackHighWaterMark = uxTaskGetStackHighWaterMark(NULL);
-    // Serial.printf("MonitorConnectivity stack remaining: %d bytes\n", stackHighWaterMark * sizeof(StackType_t));
     // Reset the watchdog at the beginning of each loop iteration.
     esp_task_wdt_reset();
+    PROFILE_SCOPE(connectivitySpan);
 
     if(DEBUG) Serial.println();
     if(DEBUG) Serial.println("Monitoring connectivity...");
@@ -412,31 +439,99 @@ void monitorConnectivityTask(void *pvParameters) {
       status.mqttConnected = false;
     }
     if(DEBUG) Serial.println();
+    PROFILE_SCOPE_END(connectivitySpan);
     vTaskDelay(500 / portTICK_PERIOD_MS);
   }
 }
 
-void sendDataToMQTT(const char* data) {
+PayloadFormat activePayloadFormat() {
+  return status.activeConnection == "Cellular" ? config.cellularPayload : config.wifiPayload;
+}
+
+static bool publishPayload(const char* topic, const uint8_t* data, size_t length, bool printable,
+                           bool rateLimited = true) {
   // Guard: Only proceed if we have an active connection and MQTT is connected.
   if (status.activeConnection == "None" || !mqttClient.connected()) {
-    return;
+    return false;
   }
 
-  // Rate-limit publishing to once every 5 seconds.
+  // Rate-limit publishing (every 5 seconds by default), unless a snapshot was requested.
   static unsigned long lastPublish = 0;
-  if (millis() - lastPublish < PUBLISH_DELAY) {
-    return;
+  if (rateLimited && !status.snapshotRequested && millis() - lastPublish < config.publishIntervalMs) {
+    return false;
   }
 
   try{
-    bool published = mqttClient.publish(config.publishTopic, data);
+    bool published = mqttClient.publish(topic, data, length);
     if (published) {
-      Serial.println("Published to " + String(config.publishTopic) + ": " + data);
-      lastPublish = millis();
+      if (printable) Serial.println("Published to " + String(topic) + ": " + (const char*)data);
+      else Serial.printf("Published to %s: %u bytes\n", topic, (unsigned)length);
+      if (rateLimited) {
+        lastPublish = millis();
+        status.snapshotRequested = false;
+      }
+      return true;
     } else {
-      Serial.println("MQTT publish failed for topic " + String(config.publishTopic));
+      Serial.println("MQTT publish failed for topic " + String(topic));
     }
   } catch (...) {
     Serial.println("MQTT publish exception");
   }
-}
\ No newline at end of file
+  return false;
+}
+
+bool sendDataToMQTT(const char* data, bool delta) {
+  return publishPayload(delta ? config.publishTopicDelta : config.publishTopic, (const uint8_t*)data, strlen(data), true);
+}
+
+bool sendDataToMQTT(const uint8_t* data, size_t length, bool delta) {
+  return publishPayload(delta ? config.publishTopicCborDelta : config.publishTopicCbor, data, length, false);
+}
+
+bool sendBackfillToMQTT(const uint8_t* data, size_t length) {
+  return publishPayload(config.publishTopicBackfill, data, length, false, false);
+}
+
+// Streamed through the client, so the payload need not fit its buffer (sized
+// for telemetry frames, see telemetryPacketMax(); only the header goes there).
+// The payload comes from source in chunks of a small stack buffer.
+#define MQTT_STREAM_CHUNK 128
+static bool publishStreamed(const char* topic, size_t length, MqttPayloadSource source, const void* context) {
+  if (!mqttClient.beginPublish(topic, length, false)) {
+    Serial.println("MQTT publish failed for topic " + String(topic));
+    return false;
+  }
+  uint8_t chunk[MQTT_STREAM_CHUNK];
+  size_t written = 0;
+  while (written < length) {
+    size_t n = source(written, chunk, min(length - written, sizeof(chunk)), context);
+    if (n == 0 || mqttClient.write(chunk, n) != n) break;
+    written += n;
+  }
+  if (!mqttClient.endPublish() || written != length) {
+    Serial.println("MQTT publish failed for topic " + String(topic));
+    return false;
+  }
+  Serial.printf("Published to %s: %u bytes\n", topic, (unsigned)length);
+  return true;
+}
+
+bool sendBurstToMQTT(size_t length, MqttPayloadSource source, const void* context) {
+  if (status.activeConnection == "None" || !mqttClient.connected()) return false;
+  if (status.activeConnection == "Cellular" && !config.cellularBursts) return false;
+  return publishStreamed(config.publishTopicBurst, length, source, context);
+}
+
+#if PROFILER
+// A payload already held in full
+static size_t copyPayload(size_t offset, uint8_t* out, size_t size, const void* context) {
+  memcpy(out, (const uint8_t*)context + offset, size);
+  return size;
+}
+
+bool sendProfileToMQTT(const char* json, size_t length) {
+  if (status.activeConnection == "None" || !mqttClient.connected()) return false;
+  if (status.activeConnection == "Cellular" && !config.cellularProfile) return false;
+  return publishStreamed(config.publishTopicProfile, length, copyPayload, json);
+}
+#endif
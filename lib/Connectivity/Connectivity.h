@@ -18,9 +18,13 @@
 #include <Preferences.h>
 // #include <GsmClient.h>
 #include <esp_task_wdt.h>
+#include "Profiler.h"
+#include "MqttPacket.h"
 // #include "CACerts.h"
 // #include "esp32_cert_bundle.h"
 
+#define PUBLISH_DELAY 5000 // default telemetry publish interval (ms)
+
 void saveCredentials();
 void loadCredentials();
 void saveGprsCredentials();
@@ -32,7 +36,32 @@ void connectMQTT();
 // void updateDisplay();
 void monitorConnectivity();
 void monitorConnectivityTask(void *pvParameters);
-void sendDataToMQTT(const char* data);
+// Return true only if the payload was handed to the broker (false when offline
+// or rate-limited). Delta messages go to the ".../delta" topics.
+bool sendDataToMQTT(const char* data, bool delta = false);
+bool sendDataToMQTT(const uint8_t* data, size_t length, bool delta = false);
+// A full CBOR frame logged while offline, on publishTopicBackfill. Not
+// rate-limited; false only when offline or the publish fails.
+bool sendBackfillToMQTT(const uint8_t* data, size_t length);
+// Fills out with up to size bytes of a payload from offset on and returns how
+// many, so a large one can be produced piecewise while it is written out
+typedef size_t (*MqttPayloadSource)(size_t offset, uint8_t* out, size_t size, const void* context);
+// A burst capture blob of length bytes on publishTopicBurst, pulled from
+// source a chunk at a time so neither the caller nor the client's buffer
+// holds all of it. Not rate-limited; false when offline, on cellular (see
+// Config::cellularBursts) or when the publish fails.
+bool sendBurstToMQTT(size_t length, MqttPayloadSource source, const void* context);
+#if PROFILER
+// Span and task timings (Profiler.h) as JSON on publishTopicProfile, streamed
+// like the bursts; false when offline, on cellular (see
+// Config::cellularProfile) or when the publish fails.
+bool sendProfileToMQTT(const char* json, size_t length);
+#endif
+
+// Called from the connectivity task for every message on subscribeTopic. The
+// payload points into the MQTT client's receive buffer and is not NUL-terminated.
+typedef void (*MqttMessageHandler)(const char* payload, size_t length);
+void setMqttMessageHandler(MqttMessageHandler handler);
 
 // Only declare, do NOT initialize here!
 // extern String activeConnection;
@@ -42,17 +71,24 @@ void sendDataToMQTT(const char* data);
 
 // extern WiFiClientSecure wifiClient;
 
+// Telemetry encoding used on each link
+enum PayloadFormat {
+    PAYLOAD_JSON,
+    PAYLOAD_CBOR  // TelemetryCbor.h, published on Config::publishTopicCbor
+};
+
 struct Status {
     String activeConnection = "None";
     long wifiRssi = -100;
     int16_t cellularCsq = 0;
     bool mqttConnected = false;
+    uint32_t mqttSessions = 0; // bumped on every successful broker connect
     bool bleDeviceConnected = false;
     bool wifiCredentialsUpdated = false;
     bool gprsCredentialsUpdated = false;
     bool gsmActive = false;
     bool switchNetwork = false;
-    char lastReceivedMessage[256] = "None";
+    volatile bool snapshotRequested = false; // publish a keyframe now, ignoring the rate limit
 };
 
 struct Config {
@@ -70,6 +106,24 @@ struct Config {
     const char* mqttPassword = "cleanenvpass";
     const char* subscribeTopic = "cleanenv/stdin";
     const char* publishTopic = "cleanenv/stdout";
+    const char* publishTopicCbor = "cleanenv/stdout/cbor";
+    // Changed fields only; apply on top of the last keyframe from the topics above
+    const char* publishTopicDelta = "cleanenv/stdout/delta";
+    const char* publishTopicCborDelta = "cleanenv/stdout/cbor/delta";
+    // CBOR frames recorded during an outage, oldest first, replayed after reconnect
+    const char* publishTopicBackfill = "cleanenv/stdout/cbor/backfill";
+    // Transient captures (BurstCapture.h blobs), one per message
+    const char* publishTopicBurst = "cleanenv/stdout/burst";
+    // Span and task timings, once per profile window (PROFILER builds)
+    const char* publishTopicProfile = "cleanenv/stdout/profile";
+    volatile uint32_t publishIntervalMs = PUBLISH_DELAY; // changed by the "interval" command
+    // The cellular link is a 9600-baud UART billed per byte: send binary there
+    PayloadFormat wifiPayload = PAYLOAD_JSON;
+    PayloadFormat cellularPayload = PAYLOAD_CBOR;
+    // A capture is up to ~14 KB: over cellular it waits for WiFi unless set
+    bool cellularBursts = false;
+    // A few KB a minute: likewise
+    bool cellularProfile = false;
 };
 
 extern Config config;
@@ -79,6 +133,8 @@ extern PubSubClient mqttClient;
 // --- Global Objects ---
 // HardwareSerial SerialAT(2);  // UART1 for SIM900A
 extern TinyGsm modem;
+
+PayloadFormat activePayloadFormat();
 // TinyGsmClient gsmClient(modem);
 
 #endif // CONNECTIVITY_H
\ No newline at end of file
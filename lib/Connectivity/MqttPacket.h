@@ -0,0 +1,21 @@
+#ifndef MQTT_PACKET_H
+#define MQTT_PACKET_H
+
+#include <cstddef>
+#include <cstring>
+
+// Largest telemetry payload published in one piece: every TELEMETRY_FIELDS
+// entry at its widest, as JSON (CBOR is about a third of that). The bench's
+// "serialize" report fails if the schema outgrows it.
+#define TELEMETRY_PAYLOAD_MAX 640
+
+// PUBLISH fixed header (type byte and up to 4 length bytes) plus the topic's
+// 2-byte length prefix
+#define MQTT_PUBLISH_OVERHEAD 7
+
+// What PubSubClient's buffer must hold to publish payloadLength bytes on topic
+inline size_t mqttPacketSize(const char* topic, size_t payloadLength) {
+  return MQTT_PUBLISH_OVERHEAD + strlen(topic) + payloadLength;
+}
+
+#endif // MQTT_PACKET_H
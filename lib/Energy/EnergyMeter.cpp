@@ -0,0 +1,215 @@
+#include "EnergyMeter.h"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+// -------- Stored form --------
+EnergyCounters makeEnergyCounters(float capacityAh) {
+  EnergyCounters c;
+  memset(&c, 0, sizeof(c));
+  c.version = ENERGY_FORMAT_VERSION;
+  c.capacityUc = (int64_t)(capacityAh * UC_PER_AH);
+  return c;
+}
+
+uint32_t energyChecksum(const EnergyCounters& counters) {
+  const uint8_t* p = (const uint8_t*)&counters;
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < offsetof(EnergyCounters, crc); i++) {
+    crc ^= p[i];
+    for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+bool validEnergyCounters(const EnergyCounters& counters) {
+  return counters.version == ENERGY_FORMAT_VERSION && counters.capacityUc > 0 &&
+         counters.crc == energyChecksum(counters);
+}
+
+bool newerEnergyCounters(const EnergyCounters& a, const EnergyCounters& b, EnergyCounters& out) {
+  bool aValid = validEnergyCounters(a), bValid = validEnergyCounters(b);
+  if (!aValid && !bValid) return false;
+  if (aValid && bValid) out = (int32_t)(a.sequence - b.sequence) > 0 ? a : b;
+  else out = aValid ? a : b;
+  return true;
+}
+
+// Resting voltage -> SOC of a Li-ion cell (typical NMC curve)
+static const float OCV_VOLTS[] = { 3.00f, 3.45f, 3.68f, 3.74f, 3.77f, 3.79f, 3.82f, 3.87f, 3.92f, 3.98f, 4.06f, 4.20f };
+static const float OCV_SOC[] = { 0, 5, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100 };
+static const int OCV_POINTS = sizeof(OCV_VOLTS) / sizeof(OCV_VOLTS[0]);
+
+float cellSoc(float cellVolts) {
+  if (!(cellVolts > OCV_VOLTS[0])) return 0;
+  for (int i = 1; i < OCV_POINTS; i++) {
+    if (cellVolts <= OCV_VOLTS[i]) {
+      float t = (cellVolts - OCV_VOLTS[i - 1]) / (OCV_VOLTS[i] - OCV_VOLTS[i - 1]);
+      return OCV_SOC[i - 1] + t * (OCV_SOC[i] - OCV_SOC[i - 1]);
+    }
+  }
+  return 100;
+}
+
+// -------- Meter --------
+EnergyMeter::EnergyMeter(float capacityAh)
+  : totals(makeEnergyCounters(capacityAh)), saved(totals), saved_ms(0), force_save(false), started(false),
+    last_ms(0), teg(), charger(), battery(), chargeIn(), chargeOut(), resting(false), rest_since_ms(0),
+    gap_count(0), save_count(0) {}
+
+void EnergyMeter::restore(const EnergyCounters& stored, uint32_t nowMs) {
+  if (!validEnergyCounters(stored)) return;
+  totals = stored;
+  saved = stored;
+  saved_ms = nowMs;
+  force_save = false;
+  started = false;
+}
+
+bool EnergyMeter::railPower(const TelemetryFrame& readings, TelemetryField volts, TelemetryField amps, float& watts) {
+  if (!readings.has(volts) || !readings.has(amps)) return false;
+  watts = readings.getFloat(volts) * readings.getFloat(amps);
+  return true;
+}
+
+// Trapezoid from the previous value; W x ms x 1000 = uJ, A x ms x 1000 = uC
+void EnergyMeter::integrate(Rail& rail, bool present, float value, int64_t& counter, uint32_t dtMs) {
+  if (present && rail.valid && dtMs > 0) {
+    float increment = (rail.value + value) * 0.5f * (float)dtMs * 1000.0f;
+    if (increment > 0) counter += (int64_t)(increment + 0.5f);
+  }
+  rail.valid = present;
+  rail.value = value;
+}
+
+void EnergyMeter::update(const TelemetryFrame& readings, uint32_t nowMs) {
+  uint32_t dtMs = started ? nowMs - last_ms : 0;
+  if (dtMs > ENERGY_MAX_GAP_MS) {
+    gap_count++;
+    dtMs = 0; // restart every rail from this reading
+  }
+  started = true;
+  last_ms = nowMs;
+
+  float watts = 0;
+  bool present = railPower(readings, TEL_T_V, TEL_T_C, watts);
+  integrate(teg, present, watts, totals.tegUj, dtMs);
+  present = railPower(readings, TEL_C_V, TEL_C_C, watts);
+  integrate(charger, present, watts, totals.chargerUj, dtMs);
+  present = railPower(readings, TEL_B_V, TEL_B_C, watts);
+  integrate(battery, present, watts, totals.batteryOutUj, dtMs);
+
+  // --- Coulomb counting ---
+  int64_t in = totals.chargeInUc, out = totals.chargeOutUc;
+  integrate(chargeIn, readings.has(TEL_C_C), readings.getFloat(TEL_C_C), totals.chargeInUc, dtMs);
+  integrate(chargeOut, readings.has(TEL_B_C), readings.getFloat(TEL_B_C), totals.chargeOutUc, dtMs);
+  totals.remainingUc += (totals.chargeInUc - in) - (totals.chargeOutUc - out);
+  if (totals.remainingUc < 0) totals.remainingUc = 0;
+  if (totals.remainingUc > totals.capacityUc) totals.remainingUc = totals.capacityUc;
+
+  // --- State of charge: from the voltage until counted, re-anchored at rest ---
+  float volts = readings.getFloat(TEL_B_V);
+  if (!totals.socKnown && volts > 0) {
+    totals.remainingUc = (int64_t)(totals.capacityUc * (cellSoc(volts / BATTERY_CELLS) / 100.0));
+    totals.socKnown = 1;
+  }
+  trackRest(readings, nowMs);
+}
+
+// Coulomb counts drift (sensor offset, self-discharge); a battery that has sat
+// without current settles to a voltage that gives its SOC directly
+void EnergyMeter::trackRest(const TelemetryFrame& readings, uint32_t nowMs) {
+  bool still = readings.has(TEL_C_C) && readings.has(TEL_B_C) && readings.getFloat(TEL_C_C) < BATTERY_REST_A &&
+               readings.getFloat(TEL_B_C) < BATTERY_REST_A && readings.getFloat(TEL_B_V) > 0;
+  if (!still) {
+    resting = false;
+    return;
+  }
+  if (!resting) {
+    resting = true;
+    rest_since_ms = nowMs;
+    return;
+  }
+  if (nowMs - rest_since_ms < BATTERY_REST_MS) return;
+  totals.remainingUc = (int64_t)(totals.capacityUc * (cellSoc(readings.getFloat(TEL_B_V) / BATTERY_CELLS) / 100.0));
+  totals.socKnown = 1;
+  rest_since_ms = nowMs;
+}
+
+float EnergyMeter::soc() const {
+  if (!totals.socKnown) return NAN;
+  return (float)(100.0 * totals.remainingUc / totals.capacityUc);
+}
+
+void EnergyMeter::publish(TelemetryFrame& readings) const {
+  readings.set<TEL_T_WH>((float)(totals.tegUj / UJ_PER_WH));
+  readings.set<TEL_C_WH>((float)(totals.chargerUj / UJ_PER_WH));
+  readings.set<TEL_B_WH>((float)(totals.batteryOutUj / UJ_PER_WH));
+  readings.set<TEL_B_AH>((float)((totals.chargeInUc - totals.chargeOutUc) / UC_PER_AH));
+  if (totals.socKnown) readings.set<TEL_SOC>(soc());
+  else readings.unset(TEL_SOC);
+}
+
+// -------- Commands --------
+void EnergyMeter::reset() {
+  uint32_t sequence = totals.sequence;
+  int64_t capacity = totals.capacityUc;
+  totals = makeEnergyCounters(1);
+  totals.capacityUc = capacity;
+  totals.sequence = sequence; // so the slots keep ordering
+  teg.valid = charger.valid = battery.valid = chargeIn.valid = chargeOut.valid = false;
+  force_save = true;
+}
+
+void EnergyMeter::setSoc(float percent) {
+  if (!(percent >= 0 && percent <= 100)) return;
+  totals.remainingUc = (int64_t)(totals.capacityUc * (percent / 100.0));
+  totals.socKnown = 1;
+  force_save = true;
+}
+
+void EnergyMeter::setCapacity(float ah) {
+  if (!(ah > 0)) return;
+  int64_t capacity = (int64_t)(ah * UC_PER_AH);
+  totals.remainingUc = (int64_t)((double)totals.remainingUc * capacity / totals.capacityUc);
+  totals.capacityUc = capacity;
+  force_save = true;
+}
+
+// -------- Save schedule --------
+static int64_t moved(int64_t a, int64_t b) {
+  return a > b ? a - b : b - a;
+}
+
+bool EnergyMeter::saveDue(uint32_t nowMs) const {
+  if (force_save) return true;
+  uint32_t elapsed = nowMs - saved_ms;
+  if (elapsed < ENERGY_SAVE_MIN_MS) return false;
+
+  int64_t energy = moved(totals.tegUj, saved.tegUj);
+  if (moved(totals.chargerUj, saved.chargerUj) > energy) energy = moved(totals.chargerUj, saved.chargerUj);
+  if (moved(totals.batteryOutUj, saved.batteryOutUj) > energy) energy = moved(totals.batteryOutUj, saved.batteryOutUj);
+  double socPercent = 100.0 * moved(totals.remainingUc, saved.remainingUc) / totals.capacityUc;
+  if (energy >= ENERGY_SAVE_DELTA_UJ || socPercent >= ENERGY_SAVE_DELTA_SOC || totals.socKnown != saved.socKnown) {
+    return true;
+  }
+
+  bool changed = energy > 0 || totals.chargeInUc != saved.chargeInUc || totals.chargeOutUc != saved.chargeOutUc ||
+                 totals.remainingUc != saved.remainingUc;
+  return changed && elapsed >= ENERGY_SAVE_MAX_MS;
+}
+
+EnergyCounters EnergyMeter::checkpoint() const {
+  EnergyCounters next = totals;
+  next.sequence = totals.sequence + 1;
+  next.crc = energyChecksum(next);
+  return next;
+}
+
+void EnergyMeter::markSaved(const EnergyCounters& stored, uint32_t nowMs) {
+  totals.sequence = stored.sequence;
+  saved = stored;
+  saved_ms = nowMs;
+  force_save = false;
+  save_count++;
+}
@@ -0,0 +1,125 @@
+#ifndef ENERGY_METER_H
+#define ENERGY_METER_H
+
+#include <cstdint>
+#include "Telemetry.h"
+
+// On-device energy accounting: every sensor sample integrates the power of
+// the TEG, charger and battery rails (trapezoid rule over the real interval
+// since the previous one) into Wh counters, counts the battery's charge in and out
+// (coulombs) and tracks its state of charge.
+//
+// Power flows TEG -> charger -> battery -> load. The ACS712 readings are
+// unsigned, so direction comes from the sensor: c_c is charge into the
+// battery, b_c is the load drawn from it. Charger efficiency over any window
+// is the ratio of the c_wh and t_wh deltas.
+
+#define ENERGY_FORMAT_VERSION 1   // bump when EnergyCounters changes layout
+#define ENERGY_MAX_GAP_MS 10000   // longer between readings: not integrated across
+
+#define BATTERY_CELLS 3           // Li-ion in series (12.6 V full)
+#define BATTERY_CAPACITY_AH 10.0f // until set with the "energy" command
+#define BATTERY_REST_A 0.05f      // below this in and out, the battery is at rest...
+#define BATTERY_REST_MS 1800000   // ...and after 30 min its voltage resets the SOC
+
+// Wear-aware save schedule: not more often than every 10 min, and only when a
+// counter moved by 0.5 Wh (or the SOC by 1 %); anything else within 6 h
+#define ENERGY_SAVE_MIN_MS 600000
+#define ENERGY_SAVE_MAX_MS 21600000
+#define ENERGY_SAVE_DELTA_UJ 1800000000LL // 0.5 Wh
+#define ENERGY_SAVE_DELTA_SOC 1.0f
+
+#define UJ_PER_WH 3.6e9
+#define UC_PER_AH 3.6e9
+
+// Plain data, stored in NVS as-is in two alternating slots (EnergyStore.h).
+// Energy in microjoules and charge in microcoulombs, so a second's increment
+// is never lost to float rounding however large the totals grow.
+struct EnergyCounters {
+  uint8_t version;
+  uint8_t socKnown;       // remainingUc is an estimate, not a placeholder
+  uint16_t reserved;
+  uint32_t sequence;      // saves so far: the newer slot has the higher one
+  int64_t tegUj;          // harvested by the TEG
+  int64_t chargerUj;      // delivered by the charger into the battery
+  int64_t batteryOutUj;   // drawn from the battery by the load
+  int64_t chargeInUc;     // coulombs into the battery (c_c)
+  int64_t chargeOutUc;    // coulombs out of the battery (b_c)
+  int64_t remainingUc;    // charge left, 0..capacityUc
+  int64_t capacityUc;
+  uint32_t crc;           // CRC-32 of everything above
+};
+
+// Zeroed counters for a battery of this capacity, SOC unknown
+EnergyCounters makeEnergyCounters(float capacityAh);
+
+// Version and CRC check
+bool validEnergyCounters(const EnergyCounters& counters);
+uint32_t energyChecksum(const EnergyCounters& counters);
+
+// Newer of two stored slots, skipping ones that are not valid; false if
+// neither is
+bool newerEnergyCounters(const EnergyCounters& a, const EnergyCounters& b, EnergyCounters& out);
+
+// Li-ion state of charge (%) from the resting voltage of one cell
+float cellSoc(float cellVolts);
+
+class EnergyMeter {
+public:
+  explicit EnergyMeter(float capacityAh = BATTERY_CAPACITY_AH);
+
+  // Counters as loaded from storage; they count as saved
+  void restore(const EnergyCounters& stored, uint32_t nowMs);
+
+  // Integrates every rail from the previous reading to this one. Rails whose
+  // fields are missing, and gaps over ENERGY_MAX_GAP_MS, are skipped.
+  void update(const TelemetryFrame& readings, uint32_t nowMs);
+
+  // Sets t_wh, c_wh, b_wh, b_ah and, once known, soc
+  void publish(TelemetryFrame& readings) const;
+
+  // Commands. Reset zeroes every counter (capacity kept, SOC from the next
+  // voltage); setSoc overrides the estimate; setCapacity keeps the SOC.
+  void reset();
+  void setSoc(float percent);
+  void setCapacity(float ah);
+
+  // True when the counters have moved enough, or long enough ago, to be
+  // worth a flash write (see ENERGY_SAVE_*)
+  bool saveDue(uint32_t nowMs) const;
+
+  // Counters to store now, with the next sequence and the CRC filled in;
+  // markSaved() once they are written
+  EnergyCounters checkpoint() const;
+  void markSaved(const EnergyCounters& stored, uint32_t nowMs);
+
+  const EnergyCounters& counters() const { return totals; }
+  float soc() const; // %, NAN until known
+  uint32_t gaps() const { return gap_count; }
+  uint32_t saves() const { return save_count; }
+
+private:
+  // Previous reading of one integrated quantity (W or A)
+  struct Rail {
+    bool valid;
+    float value;
+  };
+
+  static bool railPower(const TelemetryFrame& readings, TelemetryField volts, TelemetryField amps, float& watts);
+  static void integrate(Rail& rail, bool present, float value, int64_t& counter, uint32_t dtMs);
+  void trackRest(const TelemetryFrame& readings, uint32_t nowMs);
+
+  EnergyCounters totals;
+  EnergyCounters saved;  // as of the last markSaved()/restore()
+  uint32_t saved_ms;
+  bool force_save;
+  bool started;
+  uint32_t last_ms;
+  Rail teg, charger, battery, chargeIn, chargeOut;
+  bool resting;
+  uint32_t rest_since_ms;
+  uint32_t gap_count;
+  uint32_t save_count;
+};
+
+#endif // ENERGY_METER_H
@@ -0,0 +1,36 @@
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include "EnergyStore.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <cstring>
+
+#define ENERGY_NAMESPACE "energy"
+
+static const char* const slotKeys[2] = { "slot0", "slot1" };
+
+static bool readSlot(Preferences& prefs, uint8_t slot, EnergyCounters& out) {
+  if (prefs.getBytesLength(slotKeys[slot]) != sizeof(out)) return false;
+  return prefs.getBytes(slotKeys[slot], &out, sizeof(out)) == sizeof(out);
+}
+
+bool loadEnergy(EnergyCounters& out) {
+  Preferences prefs;
+  if (!prefs.begin(ENERGY_NAMESPACE, true)) return false; // nothing stored yet
+  EnergyCounters slots[2];
+  memset(slots, 0, sizeof(slots));
+  readSlot(prefs, 0, slots[0]);
+  readSlot(prefs, 1, slots[1]);
+  prefs.end();
+  return newerEnergyCounters(slots[0], slots[1], out);
+}
+
+bool saveEnergy(const EnergyCounters& counters) {
+  Preferences prefs;
+  if (!prefs.begin(ENERGY_NAMESPACE, false)) return false;
+  bool ok = prefs.putBytes(slotKeys[counters.sequence & 1], &counters, sizeof(counters)) == sizeof(counters);
+  prefs.end();
+  return ok;
+}
+
+#endif // ARDUINO_ARCH_ESP32
@@ -0,0 +1,17 @@
+#ifndef ENERGY_STORE_H
+#define ENERGY_STORE_H
+
+#include "EnergyMeter.h"
+
+// NVS persistence of the energy counters ("energy" namespace). Saves
+// alternate between two keys by sequence number, and each slot carries a CRC,
+// so a power cut during a write leaves the previous slot intact and load
+// picks the newest one that checks out. ESP32 only.
+
+// False if neither slot holds valid counters
+bool loadEnergy(EnergyCounters& out);
+
+// Writes the slot the sequence number selects (see EnergyMeter::checkpoint())
+bool saveEnergy(const EnergyCounters& counters);
+
+#endif // ENERGY_STORE_H
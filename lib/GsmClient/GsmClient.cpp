@@ -243,6 +243,7 @@ int GsmClient::available() {
           // just drain any unexpected characters to avoid locking up
           serial.read();
       }
+    }
   }
   return rxBufferAvailable(); // Will likely be 0, original logic was flawed.
 }
@@ -298,7 +299,7 @@ void GsmClient::stop() {
 
 // connected and bool
 uint8_t GsmClient::connected() { return isConnected ? 1 : 0; }
-GsmClient::operator bool() const { return isConnected; }
+GsmClient::operator bool() { return isConnected; }
 
 // CSQ
 int GsmClient::csq() {
@@ -0,0 +1,261 @@
+#include "Profiler.h"
+
+#if PROFILER
+
+#include "Seqlock.h"
+#if !defined(ARDUINO_ARCH_ESP32)
+#include <chrono>
+#endif
+
+static ProfileSpan* spans[PROFILE_MAX_SPANS];
+static std::atomic<uint8_t> span_count(0);
+
+// Registered tasks: filled in by profileTask(), then marked ready for
+// profileTick(), which alone touches busyUs
+struct ProfileTaskEntry {
+  std::atomic<bool> ready;
+  const ProfileSpan* busy;
+  TaskHandle_t handle;
+  char name[16];
+  int8_t core;
+  uint64_t busyUs; // at the start of the window
+};
+static ProfileTaskEntry task_entries[PROFILE_MAX_TASKS];
+static std::atomic<uint8_t> task_count(0);
+static bool window_started = false;
+static uint32_t window_start_ms;
+static ProfileTasks task_window; // profileTick() only
+static Seqlock<ProfileTasks> published_tasks;
+
+uint8_t profileBucket(uint32_t us) {
+  if (us < 2) return 0;
+  uint8_t k = 31 - __builtin_clz(us);
+  return k < PROFILE_BUCKETS ? k : PROFILE_BUCKETS - 1;
+}
+
+uint32_t profileQuantileUs(const ProfileStats& stats, float p) {
+  if (!stats.count) return 0;
+  uint32_t rank = (uint32_t)(p * stats.count + 0.5f);
+  if (rank < 1) rank = 1;
+  uint32_t seen = 0;
+  for (uint8_t k = 0; k < PROFILE_BUCKETS - 1; k++) {
+    seen += stats.buckets[k];
+    if (seen >= rank) {
+      uint32_t upper = (2u << k) - 1;
+      return upper < stats.maxUs ? upper : stats.maxUs;
+    }
+  }
+  return stats.maxUs;
+}
+
+ProfileSpan::ProfileSpan(const char* name)
+  : span_name(name), seq(0), count(0), max_us(0), total_lo(0), total_hi(0) {
+  for (uint8_t k = 0; k < PROFILE_BUCKETS; k++) buckets[k].store(0, std::memory_order_relaxed);
+  uint8_t index = span_count.load(std::memory_order_relaxed);
+  while (index < PROFILE_MAX_SPANS &&
+         !span_count.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+  }
+  if (index < PROFILE_MAX_SPANS) spans[index] = this;
+}
+
+// Sequence-locked like Seqlock.h, but updated in place: the owner is the only
+// writer, so each word is a plain load and store
+void ProfileSpan::record(uint32_t us) {
+  uint32_t s = seq.load(std::memory_order_relaxed);
+  seq.store(s + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  if (us > max_us.load(std::memory_order_relaxed)) max_us.store(us, std::memory_order_relaxed);
+  uint32_t lo = total_lo.load(std::memory_order_relaxed);
+  total_lo.store(lo + us, std::memory_order_relaxed);
+  if (lo + us < lo) total_hi.store(total_hi.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic<uint32_t>& bucket = buckets[profileBucket(us)];
+  bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+  seq.store(s + 2, std::memory_order_release);
+}
+
+bool ProfileSpan::read(ProfileStats& out) const {
+  for (int attempts = 8; attempts > 0; attempts--) {
+    uint32_t s = seq.load(std::memory_order_acquire);
+    if (s & 1u) continue;
+    out.count = count.load(std::memory_order_relaxed);
+    out.maxUs = max_us.load(std::memory_order_relaxed);
+    out.totalUs = ((uint64_t)total_hi.load(std::memory_order_relaxed) << 32) | total_lo.load(std::memory_order_relaxed);
+    for (uint8_t k = 0; k < PROFILE_BUCKETS; k++) out.buckets[k] = buckets[k].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq.load(std::memory_order_relaxed) == s) return true;
+  }
+  return false;
+}
+
+uint8_t profileSpanCount() {
+  uint8_t n = span_count.load(std::memory_order_acquire);
+  return n < PROFILE_MAX_SPANS ? n : PROFILE_MAX_SPANS;
+}
+
+const ProfileSpan* profileSpan(uint8_t index) { return index < profileSpanCount() ? spans[index] : nullptr; }
+
+#if defined(ARDUINO_ARCH_ESP32)
+uint32_t profileCyclesPerUs() {
+  static uint32_t per_us = 0;
+  if (!per_us) per_us = ESP.getCpuFreqMHz();
+  return per_us;
+}
+#else
+uint32_t profileCycles() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t profileCyclesPerUs() { return 1000; }
+#endif
+
+static uint64_t spanTotalUs(const ProfileSpan* span) {
+  ProfileStats stats;
+  return span->read(stats) ? stats.totalUs : 0;
+}
+
+void profileTask(const ProfileSpan& busy) {
+  uint8_t index = task_count.load(std::memory_order_relaxed);
+  while (index < PROFILE_MAX_TASKS &&
+         !task_count.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+  }
+  if (index >= PROFILE_MAX_TASKS) return;
+  ProfileTaskEntry& entry = task_entries[index];
+  entry.busy = &busy;
+  entry.busyUs = spanTotalUs(&busy);
+#if defined(ARDUINO_ARCH_ESP32)
+  entry.handle = xTaskGetCurrentTaskHandle();
+  strncpy(entry.name, pcTaskGetName(NULL), sizeof(entry.name) - 1);
+  BaseType_t core = xTaskGetAffinity(NULL);
+  entry.core = core == tskNO_AFFINITY ? -1 : (int8_t)core;
+#else
+  entry.handle = nullptr;
+  strncpy(entry.name, "host", sizeof(entry.name) - 1);
+  entry.core = -1;
+#endif
+  entry.ready.store(true, std::memory_order_release);
+}
+
+bool profileTick(uint32_t nowMs) {
+  if (!window_started) {
+    window_started = true;
+    window_start_ms = nowMs;
+    return false;
+  }
+  uint32_t elapsed = nowMs - window_start_ms;
+  if (elapsed < PROFILE_WINDOW_MS) return false;
+  window_start_ms = nowMs;
+
+  uint8_t n = task_count.load(std::memory_order_relaxed);
+  if (n > PROFILE_MAX_TASKS) n = PROFILE_MAX_TASKS;
+  task_window.count = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    ProfileTaskEntry& entry = task_entries[i];
+    if (!entry.ready.load(std::memory_order_acquire)) continue;
+    ProfileTaskStats& stats = task_window.tasks[task_window.count++];
+    uint64_t busy = spanTotalUs(entry.busy);
+    memcpy(stats.name, entry.name, sizeof(stats.name));
+    stats.core = entry.core;
+    stats.cpuPercent = (busy - entry.busyUs) / (elapsed * 10.0f); // us over ms, in %
+    entry.busyUs = busy;
+#if defined(ARDUINO_ARCH_ESP32)
+    stats.stackFree = uxTaskGetStackHighWaterMark(entry.handle); // bytes on ESP-IDF
+#else
+    stats.stackFree = 0;
+#endif
+  }
+  task_window.sequence++;
+  task_window.windowMs = elapsed;
+  published_tasks.write(task_window);
+  return true;
+}
+
+bool profileTasks(ProfileTasks& out) { return published_tasks.read(out); }
+
+void writeProfileJson(JsonWriter& w) {
+  ProfileStats stats;
+  w.beginObject();
+  w.key("now_ms");
+  w.value((unsigned int)millis());
+  w.key("spans");
+  w.beginArray();
+  for (uint8_t i = 0; i < profileSpanCount(); i++) {
+    const ProfileSpan* span = profileSpan(i);
+    if (!span || !span->read(stats)) continue;
+    w.item();
+    w.beginObject();
+    w.key("name");
+    w.value(span->name());
+    w.key("n");
+    w.value((unsigned int)stats.count);
+    w.key("mean_us");
+    w.value((unsigned int)(stats.count ? stats.totalUs / stats.count : 0));
+    w.key("p50_us");
+    w.value((unsigned int)profileQuantileUs(stats, 0.5f));
+    w.key("p99_us");
+    w.value((unsigned int)profileQuantileUs(stats, 0.99f));
+    w.key("max_us");
+    w.value((unsigned int)stats.maxUs);
+    // Bucket k counts 2^k..2^(k+1) - 1 us; trailing empty buckets are left out
+    uint8_t used = PROFILE_BUCKETS;
+    while (used > 0 && !stats.buckets[used - 1]) used--;
+    w.key("log2_us");
+    w.beginArray();
+    for (uint8_t k = 0; k < used; k++) {
+      w.item();
+      w.value((unsigned int)stats.buckets[k]);
+    }
+    w.endArray();
+    w.endObject();
+  }
+  w.endArray();
+
+  ProfileTasks tasks;
+  memset(&tasks, 0, sizeof(tasks));
+  w.key("tasks");
+  w.beginArray();
+  if (profileTasks(tasks)) {
+    for (uint8_t i = 0; i < tasks.count; i++) {
+      const ProfileTaskStats& t = tasks.tasks[i];
+      w.item();
+      w.beginObject();
+      w.key("name");
+      w.value(t.name);
+      w.key("core");
+      w.value((int)t.core);
+      w.key("cpu");
+      w.value(t.cpuPercent, 1);
+      w.key("stack_free");
+      w.value((unsigned int)t.stackFree);
+      w.endObject();
+    }
+  }
+  w.endArray();
+  w.key("window_ms");
+  w.value((unsigned int)tasks.windowMs);
+  w.endObject();
+}
+
+void printProfile(Print& out) {
+  ProfileStats stats;
+  for (uint8_t i = 0; i < profileSpanCount(); i++) {
+    const ProfileSpan* span = profileSpan(i);
+    if (!span || !span->read(stats) || !stats.count) continue;
+    out.printf("Span %s: %lu runs, mean %lu us, p50 <= %lu us, p99 <= %lu us, max %lu us\n", span->name(),
+               (unsigned long)stats.count, (unsigned long)(stats.totalUs / stats.count),
+               (unsigned long)profileQuantileUs(stats, 0.5f), (unsigned long)profileQuantileUs(stats, 0.99f),
+               (unsigned long)stats.maxUs);
+  }
+  ProfileTasks tasks;
+  if (!profileTasks(tasks)) return;
+  for (uint8_t i = 0; i < tasks.count; i++) {
+    const ProfileTaskStats& t = tasks.tasks[i];
+    out.printf("Task %s (core %d): %.1f %% busy over %lu ms, %lu B stack free\n", t.name, t.core, t.cpuPercent,
+               (unsigned long)tasks.windowMs, (unsigned long)t.stackFree);
+  }
+}
+
+#endif // PROFILER
@@ -0,0 +1,150 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "JsonWriter.h"
+
+// Timing instrumentation, built with -D PROFILER=1 (platformio.ini). With it
+// off the macros below expand to nothing and none of this is compiled in.
+//
+//   PROFILE_SPAN(lcdSpan, "loop.lcd");       // file scope: a named span
+//   { PROFILE_SCOPE(lcdSpan); ... }          // time this block into it
+//   PROFILE_SCOPE_END(lcdSpan);              // ... or stop before the block ends
+//   PROFILE_TASK(loopSpan);                  // the calling task is busy while
+//                                            // loopSpan is running
+//
+// A span keeps a count, the total and longest duration and a log2 histogram
+// (bucket k holds 2^k to 2^(k+1) - 1 us; bucket 0 also takes 0 and 1 us, the
+// last bucket everything longer). Durations come from the cycle counter, or
+// the tick count once they are too long for it (17.9 s at 240 MHz); since the
+// counter is per core, spans belong on tasks pinned to one. A span is recorded
+// by one task and may be read from any.
+#ifndef PROFILER
+#define PROFILER 0
+#endif
+
+#define PROFILE_BUCKETS 24
+#define PROFILE_MAX_SPANS 16
+#define PROFILE_MAX_TASKS 8
+#define PROFILE_WINDOW_MS 60000 // task CPU and stack are sampled over this
+
+#if PROFILER
+
+struct ProfileStats {
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  uint32_t buckets[PROFILE_BUCKETS];
+};
+
+uint8_t profileBucket(uint32_t us);
+
+// Upper bound of the bucket the p-th quantile (0..1) falls in, capped at the
+// longest duration seen; 0 if nothing was recorded
+uint32_t profileQuantileUs(const ProfileStats& stats, float p);
+
+class ProfileSpan {
+public:
+  // Registers the span (up to PROFILE_MAX_SPANS; later ones are timed but not listed)
+  explicit ProfileSpan(const char* name);
+
+  // Owning task only
+  void record(uint32_t us);
+
+  // Any task; false if the owner kept writing through every attempt
+  bool read(ProfileStats& out) const;
+
+  const char* name() const { return span_name; }
+
+private:
+  const char* span_name;
+  std::atomic<uint32_t> seq; // odd while record() is updating
+  std::atomic<uint32_t> count;
+  std::atomic<uint32_t> max_us;
+  std::atomic<uint32_t> total_lo;
+  std::atomic<uint32_t> total_hi;
+  std::atomic<uint32_t> buckets[PROFILE_BUCKETS];
+};
+
+uint8_t profileSpanCount();
+const ProfileSpan* profileSpan(uint8_t index);
+
+// Cycle counter and cycles per microsecond (the host counts nanoseconds)
+#if defined(ARDUINO_ARCH_ESP32)
+inline uint32_t profileCycles() { return ESP.getCycleCount(); }
+#else
+uint32_t profileCycles();
+#endif
+uint32_t profileCyclesPerUs();
+
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfileSpan& span)
+    : span(span), start_ticks(xTaskGetTickCount()), start_cycles(profileCycles()), running(true) {}
+  ~ProfileScope() { stop(); }
+
+  void stop() {
+    if (!running) return;
+    uint32_t cycles = profileCycles() - start_cycles;
+    uint32_t ms = (xTaskGetTickCount() - start_ticks) * portTICK_PERIOD_MS;
+    running = false;
+    span.record(ms < 10000 ? cycles / profileCyclesPerUs() : ms * 1000u);
+  }
+
+private:
+  ProfileSpan& span;
+  TickType_t start_ticks;
+  uint32_t start_cycles;
+  bool running;
+};
+
+// A registered task over the last window: how much of it the task's busy
+// span ran for, and the least stack it has had left
+struct ProfileTaskStats {
+  char name[16];
+  int8_t core;          // -1: not pinned (or not known, on the host)
+  float cpuPercent;
+  uint32_t stackFree;   // bytes, 0 on the host
+};
+
+struct ProfileTasks {
+  uint32_t sequence;    // windows sampled so far
+  uint32_t windowMs;
+  uint8_t count;
+  ProfileTaskStats tasks[PROFILE_MAX_TASKS];
+};
+
+// Registers the calling task; busy is the span covering its work between waits
+void profileTask(const ProfileSpan& busy);
+
+// One task, regularly: samples the registered tasks every PROFILE_WINDOW_MS.
+// True when it did.
+bool profileTick(uint32_t nowMs);
+
+// Any task: the last window sampled (sequence 0 before the first)
+bool profileTasks(ProfileTasks& out);
+
+// Spans and the last task window, for /profile and the profile topic
+void writeProfileJson(JsonWriter& w);
+
+// The same as a table, for the serial log
+void printProfile(Print& out);
+
+#define PROFILE_CAT_(a, b) a##b
+#define PROFILE_CAT(a, b) PROFILE_CAT_(a, b)
+#define PROFILE_SPAN(var, name) static ProfileSpan var(name)
+#define PROFILE_SCOPE(var) ProfileScope PROFILE_CAT(profile_scope_, var)(var)
+#define PROFILE_SCOPE_END(var) PROFILE_CAT(profile_scope_, var).stop()
+#define PROFILE_TASK(var) profileTask(var)
+
+#else
+
+#define PROFILE_SPAN(var, name)
+#define PROFILE_SCOPE(var)
+#define PROFILE_SCOPE_END(var)
+#define PROFILE_TASK(var)
+
+#endif // PROFILER
+
+#endif // PROFILER_H
@@ -0,0 +1,23 @@
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include "Esp32FlashPartition.h"
+
+bool Esp32FlashPartition::begin() {
+  if (partition) return true;
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)subtype, label);
+  return partition != nullptr;
+}
+
+bool Esp32FlashPartition::read(uint32_t offset, void* dst, size_t length) {
+  return partition && esp_partition_read(partition, offset, dst, length) == ESP_OK;
+}
+
+bool Esp32FlashPartition::write(uint32_t offset, const void* src, size_t length) {
+  return partition && esp_partition_write(partition, offset, src, length) == ESP_OK;
+}
+
+bool Esp32FlashPartition::eraseSector(uint32_t offset) {
+  return partition && esp_partition_erase_range(partition, offset, sectorSize()) == ESP_OK;
+}
+
+#endif // ARDUINO_ARCH_ESP32
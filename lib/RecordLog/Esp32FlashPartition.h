@@ -0,0 +1,30 @@
+#ifndef ESP32_FLASH_PARTITION_H
+#define ESP32_FLASH_PARTITION_H
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "FlashPartition.h"
+
+// A data partition from the partition table, found by subtype and label
+// (custom_partition.csv: "userdata", subtype 0x81)
+class Esp32FlashPartition : public FlashPartition {
+public:
+  Esp32FlashPartition(const char* label, uint8_t subtype) : label(label), subtype(subtype), partition(nullptr) {}
+
+  bool begin() override;
+  uint32_t size() const override { return partition ? partition->size : 0; }
+  bool read(uint32_t offset, void* dst, size_t length) override;
+  bool write(uint32_t offset, const void* src, size_t length) override;
+  bool eraseSector(uint32_t offset) override;
+
+private:
+  const char* label;
+  uint8_t subtype;
+  const esp_partition_t* partition;
+};
+
+#endif // ARDUINO_ARCH_ESP32
+
+#endif // ESP32_FLASH_PARTITION_H
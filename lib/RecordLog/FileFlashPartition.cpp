@@ -0,0 +1,63 @@
+#if !defined(ARDUINO_ARCH_ESP32)
+
+#include "FileFlashPartition.h"
+#include <cstring>
+
+FileFlashPartition::FileFlashPartition(uint32_t size, const char* path, uint32_t sectorSize)
+  : image(size - size % sectorSize, 0xFF), eraseCounts(size / sectorSize, 0), sector(sectorSize), path(path),
+    file(nullptr), budget(-1), written(0) {}
+
+FileFlashPartition::~FileFlashPartition() {
+  if (file) fclose(file);
+}
+
+bool FileFlashPartition::begin() {
+  if (!path || file) return true;
+  file = fopen(path, "r+b");
+  if (file) {
+    size_t n = fread(image.data(), 1, image.size(), file);
+    if (n < image.size()) memset(image.data() + n, 0xFF, image.size() - n); // grown: new space is erased
+  } else {
+    file = fopen(path, "w+b");
+  }
+  if (!file) return false;
+  flush(0, image.size());
+  return true;
+}
+
+void FileFlashPartition::flush(uint32_t offset, size_t length) {
+  if (!file) return;
+  fseek(file, offset, SEEK_SET);
+  fwrite(image.data() + offset, 1, length, file);
+  fflush(file);
+}
+
+bool FileFlashPartition::read(uint32_t offset, void* dst, size_t length) {
+  if (offset > image.size() || length > image.size() - offset) return false;
+  memcpy(dst, image.data() + offset, length);
+  return true;
+}
+
+bool FileFlashPartition::write(uint32_t offset, const void* src, size_t length) {
+  if (offset > image.size() || length > image.size() - offset || budget == 0) return false;
+  size_t n = length;
+  if (budget > 0 && (int64_t)n > budget) n = (size_t)budget;
+
+  const uint8_t* in = (const uint8_t*)src;
+  for (size_t i = 0; i < n; i++) image[offset + i] &= in[i];
+  written += n;
+  flush(offset, n);
+
+  if (budget > 0) budget -= (int64_t)n;
+  return n == length;
+}
+
+bool FileFlashPartition::eraseSector(uint32_t offset) {
+  if (offset % sector != 0 || offset >= image.size() || budget == 0) return false;
+  memset(image.data() + offset, 0xFF, sector);
+  eraseCounts[offset / sector]++;
+  flush(offset, sector);
+  return true;
+}
+
+#endif // !ARDUINO_ARCH_ESP32
@@ -0,0 +1,51 @@
+#ifndef FILE_FLASH_PARTITION_H
+#define FILE_FLASH_PARTITION_H
+
+#if !defined(ARDUINO_ARCH_ESP32)
+
+#include <cstdio>
+#include <vector>
+#include "FlashPartition.h"
+
+// Host stand-in for a flash partition. The image lives in memory and, with a
+// path, is loaded from and written through to a file, so a log survives
+// between runs like it survives a reboot. Writes AND into the image (NOR:
+// bits only go 1 -> 0) and erases are counted per sector.
+//
+// failAfter(n) simulates a power cut: the write that crosses the n-th byte
+// from now is torn (only the bytes before the cut land) and every write and
+// erase after it fails, until powerOn().
+class FileFlashPartition : public FlashPartition {
+public:
+  explicit FileFlashPartition(uint32_t size, const char* path = nullptr, uint32_t sectorSize = 4096);
+  ~FileFlashPartition();
+
+  bool begin() override;
+  uint32_t size() const override { return (uint32_t)image.size(); }
+  uint32_t sectorSize() const override { return sector; }
+  bool read(uint32_t offset, void* dst, size_t length) override;
+  bool write(uint32_t offset, const void* src, size_t length) override;
+  bool eraseSector(uint32_t offset) override;
+
+  void failAfter(uint32_t bytes) { budget = (int64_t)bytes; }
+  void powerOn() { budget = -1; }
+  bool powerLost() const { return budget == 0; }
+
+  uint32_t erases(uint32_t sectorIndex) const { return eraseCounts[sectorIndex]; }
+  uint64_t bytesWritten() const { return written; }
+
+private:
+  void flush(uint32_t offset, size_t length);
+
+  std::vector<uint8_t> image;
+  std::vector<uint32_t> eraseCounts;
+  uint32_t sector;
+  const char* path;
+  FILE* file;
+  int64_t budget; // bytes until the power cut, -1 = none
+  uint64_t written;
+};
+
+#endif // !ARDUINO_ARCH_ESP32
+
+#endif // FILE_FLASH_PARTITION_H
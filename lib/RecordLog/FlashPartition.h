@@ -0,0 +1,25 @@
+#ifndef FLASH_PARTITION_H
+#define FLASH_PARTITION_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Raw access to a flash data partition with NOR semantics: erase sets a whole
+// sector to 0xFF, writes can only clear bits. Esp32FlashPartition.h wraps the
+// esp_partition API; FileFlashPartition.h emulates it on the host.
+class FlashPartition {
+public:
+  virtual ~FlashPartition() {}
+
+  virtual bool begin() = 0;
+
+  virtual uint32_t size() const = 0;
+  virtual uint32_t sectorSize() const { return 4096; }
+
+  // Offsets are relative to the start of the partition
+  virtual bool read(uint32_t offset, void* dst, size_t length) = 0;
+  virtual bool write(uint32_t offset, const void* src, size_t length) = 0;
+  virtual bool eraseSector(uint32_t offset) = 0;
+};
+
+#endif // FLASH_PARTITION_H
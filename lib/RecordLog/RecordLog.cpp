@@ -0,0 +1,352 @@
+#include "RecordLog.h"
+#include <cstring>
+
+#define RECORD_FLAG_UNSENT 0x01
+#define FREE_LENGTH 0xFFFF
+
+static uint32_t align4(uint32_t n) { return (n + 3) & ~3u; }
+
+// Reflected CRC-32 (IEEE), four bits at a time from a 16-entry table
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+  static const uint32_t table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+  };
+  crc = ~crc;
+  while (length--) {
+    crc ^= *data++;
+    crc = (crc >> 4) ^ table[crc & 0x0F];
+    crc = (crc >> 4) ^ table[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+static bool isNewer(uint32_t a, uint32_t b) { return (int32_t)(a - b) > 0; }
+
+RecordLog::RecordLog(FlashPartition& flash)
+  : flash(flash), sectorBytes(0), sectorCount(0), headSector(0), headSequence(0), headOffset(0), nextRecord(1),
+    aheadErase(-1), ready(false) {
+  memset(sectorSequences, 0, sizeof(sectorSequences));
+  memset(sectorErases, 0, sizeof(sectorErases));
+  memset(&unsent, 0, sizeof(unsent));
+  memset(&counters, 0, sizeof(counters));
+}
+
+size_t RecordLog::maxPayload() const {
+  size_t room = sectorBytes - RECORD_LOG_SECTOR_HEADER - RECORD_LOG_RECORD_HEADER;
+  return room < FREE_LENGTH ? room : FREE_LENGTH - 1;
+}
+
+// -------- Sectors --------
+bool RecordLog::sectorHeader(uint32_t index, SectorHeader& h) {
+  return flash.read(sectorOffset(index), &h, sizeof(h)) && h.magic == RECORD_LOG_MAGIC;
+}
+
+// length is a multiple of 4; only those bytes are read, so a short check near
+// the end of a sector does not see the next one's header
+static bool sectorBlank(FlashPartition& flash, uint32_t offset, uint32_t length) {
+  uint32_t chunk[64];
+  for (uint32_t pos = 0; pos < length; pos += sizeof(chunk)) {
+    uint32_t n = length - pos < sizeof(chunk) ? length - pos : sizeof(chunk);
+    if (!flash.read(offset + pos, chunk, n)) return false;
+    for (size_t i = 0; i < n / 4; i++) {
+      if (chunk[i] != 0xFFFFFFFFu) return false;
+    }
+  }
+  return true;
+}
+
+bool RecordLog::eraseSector(uint32_t index) {
+  if (sectorSequences[index] != 0) {
+    // Recycling the oldest sector: account for what it held
+    uint32_t offset = sectorOffset(index) + RECORD_LOG_SECTOR_HEADER;
+    uint32_t end = sectorOffset(index) + sectorBytes;
+    RecordHeader h;
+    while (readRecord(offset, end, h, true)) {
+      counters.records--;
+      counters.usedBytes -= align4(RECORD_LOG_RECORD_HEADER + h.length);
+      if (h.flags & RECORD_FLAG_UNSENT) {
+        counters.unsent--;
+        counters.dropped++;
+      }
+      offset += align4(RECORD_LOG_RECORD_HEADER + h.length);
+    }
+    sectorSequences[index] = 0;
+  }
+  if (!flash.eraseSector(sectorOffset(index))) return false;
+  sectorErases[index]++;
+  return true;
+}
+
+// The magic is written last, so a header torn by a power cut never looks valid
+bool RecordLog::openSector(uint32_t index) {
+  SectorHeader h = { RECORD_LOG_MAGIC, headSequence + 1, sectorErases[index] };
+  uint32_t base = sectorOffset(index);
+  if (!flash.write(base + 4, &h.sequence, 8) || !flash.write(base, &h.magic, 4)) return false;
+  headSector = index;
+  headSequence = h.sequence;
+  headOffset = base + RECORD_LOG_SECTOR_HEADER;
+  sectorSequences[index] = h.sequence;
+  aheadErase = (int32_t)nextSector(index);
+  return true;
+}
+
+bool RecordLog::format() {
+  for (uint32_t i = 0; i < sectorCount; i++) sectorSequences[i] = 0;
+  if (!eraseSector(0)) return false;
+  headSequence = 0;
+  return openSector(0);
+}
+
+// -------- Records --------
+uint32_t RecordLog::recordCrc(const RecordHeader& h, uint32_t payloadOffset) {
+  uint8_t head[7];
+  memcpy(head, &h.length, 2);
+  head[2] = h.type;
+  memcpy(head + 3, &h.sequence, 4);
+  uint32_t crc = crc32Update(0, head, sizeof(head));
+
+  uint8_t chunk[64];
+  for (uint32_t pos = 0; pos < h.length; pos += sizeof(chunk)) {
+    uint32_t n = h.length - pos < sizeof(chunk) ? h.length - pos : sizeof(chunk);
+    if (!flash.read(payloadOffset + pos, chunk, n)) return ~h.crc;
+    crc = crc32Update(crc, chunk, n);
+  }
+  return crc;
+}
+
+// A well-formed record at offset that ends before end (and, with checkCrc,
+// whose payload matches). False for free space and for torn records.
+bool RecordLog::readRecord(uint32_t offset, uint32_t end, RecordHeader& h, bool checkCrc) {
+  if (offset + RECORD_LOG_RECORD_HEADER > end || !flash.read(offset, &h, sizeof(h))) return false;
+  if (h.length == FREE_LENGTH || offset + align4(RECORD_LOG_RECORD_HEADER + h.length) > end) return false;
+  return !checkCrc || recordCrc(h, offset + RECORD_LOG_RECORD_HEADER) == h.crc;
+}
+
+// -------- Recovery --------
+bool RecordLog::begin() {
+  ready = false;
+  if (!flash.begin()) return false;
+  sectorBytes = flash.sectorSize();
+  sectorCount = flash.size() / sectorBytes;
+  if (sectorCount > RECORD_LOG_MAX_SECTORS) sectorCount = RECORD_LOG_MAX_SECTORS;
+  if (sectorCount < 2) return false;
+  memset(&counters, 0, sizeof(counters));
+  counters.sectors = sectorCount;
+  nextRecord = 1;
+
+  // 1. Sector headers: the newest sequence is the head, the oldest the tail
+  bool found = false;
+  uint32_t tail = 0;
+  for (uint32_t i = 0; i < sectorCount; i++) {
+    SectorHeader h;
+    sectorSequences[i] = 0;
+    if (!sectorHeader(i, h) || h.sequence == 0) continue;
+    sectorSequences[i] = h.sequence;
+    sectorErases[i] = h.erases;
+    if (!found || isNewer(h.sequence, headSequence)) {
+      headSector = i;
+      headSequence = h.sequence;
+    }
+    if (!found || isNewer(sectorSequences[tail], h.sequence)) tail = i;
+    found = true;
+  }
+  if (!found) {
+    if (!format()) return false;
+    tail = headSector;
+  }
+
+  // 2. Records, oldest sector first: counts, last sequence, first unsent. A
+  // torn record stays where it was cut after its sector is sealed, so CRCs are
+  // checked in every sector, not just the head.
+  bool haveUnsent = false;
+  uint32_t index = tail;
+  for (;;) {
+    if (sectorSequences[index] != 0) {
+      uint32_t base = sectorOffset(index);
+      uint32_t offset = base + RECORD_LOG_SECTOR_HEADER;
+      uint32_t end = base + sectorBytes;
+      bool head = index == headSector;
+      RecordHeader h;
+      while (readRecord(offset, end, h, true)) {
+        if ((h.flags & RECORD_FLAG_UNSENT) && !haveUnsent) {
+          unsent.sectorSequence = sectorSequences[index];
+          unsent.offset = offset;
+          haveUnsent = true;
+        }
+        counters.records++;
+        counters.unsent += (h.flags & RECORD_FLAG_UNSENT) ? 1 : 0;
+        counters.usedBytes += align4(RECORD_LOG_RECORD_HEADER + h.length);
+        if (counters.records == 1 || isNewer(h.sequence + 1, nextRecord)) nextRecord = h.sequence + 1;
+        offset += align4(RECORD_LOG_RECORD_HEADER + h.length);
+      }
+      bool torn = offset + RECORD_LOG_RECORD_HEADER <= end && !sectorBlank(flash, offset, RECORD_LOG_RECORD_HEADER);
+      if (torn) counters.recovered++;
+      if (head) {
+        // Torn append: seal the sector, the next append opens a fresh one
+        headOffset = torn ? end : offset;
+      }
+    }
+    if (index == headSector) break;
+    index = nextSector(index);
+  }
+  if (!haveUnsent) {
+    unsent.sectorSequence = headSequence;
+    unsent.offset = headOffset;
+  }
+
+  // 3. Erase-ahead: the sector after the head must be blank before use
+  uint32_t ahead = nextSector(headSector);
+  aheadErase = (sectorSequences[ahead] == 0 && sectorBlank(flash, sectorOffset(ahead), sectorBytes)) ? -1 : (int32_t)ahead;
+
+  ready = true;
+  return true;
+}
+
+// -------- Writing --------
+bool RecordLog::append(const void* data, size_t length, uint8_t type) {
+  if (!ready || length > maxPayload()) return false;
+  uint32_t need = align4(RECORD_LOG_RECORD_HEADER + length);
+
+  if (headOffset + need > sectorOffset(headSector) + sectorBytes) {
+    uint32_t next = nextSector(headSector);
+    if (aheadErase == (int32_t)next) maintain(); // erase-ahead fell behind: pay for it now
+    if (!openSector(next)) {
+      headOffset = sectorOffset(headSector) + sectorBytes;
+      return false;
+    }
+  }
+
+  RecordHeader h;
+  h.length = (uint16_t)length;
+  h.type = type;
+  h.flags = 0xFF;
+  h.sequence = nextRecord;
+  uint8_t head[7];
+  memcpy(head, &h.length, 2);
+  head[2] = h.type;
+  memcpy(head + 3, &h.sequence, 4);
+  h.crc = crc32Update(crc32Update(0, head, sizeof(head)), (const uint8_t*)data, length);
+
+  // Header first: a cut during the payload leaves a CRC mismatch, never a
+  // stretch of programmed bytes that looks free
+  uint32_t offset = headOffset;
+  headOffset += need;
+  if (!flash.write(offset, &h, sizeof(h)) ||
+      (length && !flash.write(offset + RECORD_LOG_RECORD_HEADER, data, length))) {
+    headOffset = sectorOffset(headSector) + sectorBytes;
+    return false;
+  }
+
+  nextRecord++;
+  counters.records++;
+  counters.unsent++;
+  counters.usedBytes += need;
+  return true;
+}
+
+void RecordLog::maintain() {
+  if (!ready || aheadErase < 0) return;
+  uint32_t index = (uint32_t)aheadErase;
+  // A sector that was never used may already be blank; skip the erase then
+  if (sectorSequences[index] != 0 || !sectorBlank(flash, sectorOffset(index), sectorBytes)) {
+    if (!eraseSector(index)) return;
+  }
+  aheadErase = -1;
+}
+
+RecordLogStats RecordLog::stats() const {
+  RecordLogStats s = counters;
+  for (uint32_t i = 0; i < sectorCount; i++) {
+    if (i == 0 || sectorErases[i] < s.minErases) s.minErases = sectorErases[i];
+    if (i == 0 || sectorErases[i] > s.maxErases) s.maxErases = sectorErases[i];
+  }
+  return s;
+}
+
+// -------- Reading --------
+RecordCursor RecordLog::oldest() const {
+  RecordCursor c = { headSequence, sectorOffset(headSector) + RECORD_LOG_SECTOR_HEADER };
+  for (uint32_t i = 0; i < sectorCount; i++) {
+    if (sectorSequences[i] != 0 && isNewer(c.sectorSequence, sectorSequences[i])) {
+      c.sectorSequence = sectorSequences[i];
+      c.offset = sectorOffset(i) + RECORD_LOG_SECTOR_HEADER;
+    }
+  }
+  return c;
+}
+
+bool RecordLog::cursorValid(const RecordCursor& c) {
+  uint32_t index = c.offset / sectorBytes;
+  return index < sectorCount && sectorSequences[index] == c.sectorSequence && c.sectorSequence != 0;
+}
+
+bool RecordLog::next(RecordCursor& cursor, RecordInfo& info, void* buffer, size_t bufferSize) {
+  if (!ready) return false;
+  if (!cursorValid(cursor)) cursor = oldest();
+
+  for (;;) {
+    uint32_t index = cursor.offset / sectorBytes;
+    uint32_t end = index == headSector ? headOffset : sectorOffset(index) + sectorBytes;
+    RecordHeader h;
+    if (!readRecord(cursor.offset, end, h, false)) {
+      if (index == headSector) return false;
+      // Rest of this sector is unused: continue with the next one
+      uint32_t next = nextSector(index);
+      cursor.sectorSequence = sectorSequences[next];
+      cursor.offset = sectorOffset(next) + RECORD_LOG_SECTOR_HEADER;
+      if (cursor.sectorSequence == 0) return false;
+      continue;
+    }
+
+    uint32_t offset = cursor.offset;
+    cursor.offset += align4(RECORD_LOG_RECORD_HEADER + h.length);
+    size_t n = h.length < bufferSize ? h.length : bufferSize;
+    if (n && !flash.read(offset + RECORD_LOG_RECORD_HEADER, buffer, n)) return false;
+    if (n == h.length) {
+      uint8_t head[7];
+      memcpy(head, &h.length, 2);
+      head[2] = h.type;
+      memcpy(head + 3, &h.sequence, 4);
+      if (crc32Update(crc32Update(0, head, sizeof(head)), (const uint8_t*)buffer, n) != h.crc) continue; // damaged
+    }
+
+    info.sequence = h.sequence;
+    info.length = h.length;
+    info.type = h.type;
+    info.sent = !(h.flags & RECORD_FLAG_UNSENT);
+    info.offset = offset;
+    return true;
+  }
+}
+
+// -------- Backfill --------
+bool RecordLog::peekUnsent(RecordInfo& info, void* buffer, size_t bufferSize) {
+  RecordCursor c = unsent;
+  for (;;) {
+    if (!cursorValid(c)) c = oldest();
+    if (!next(c, info, buffer, bufferSize)) {
+      unsent = c;
+      return false;
+    }
+    if (!info.sent) {
+      // next() may have stepped over unused sector tails: point at the record
+      unsent.sectorSequence = sectorSequences[info.offset / sectorBytes];
+      unsent.offset = info.offset;
+      return true;
+    }
+    unsent = c;
+  }
+}
+
+bool RecordLog::markSent(const RecordInfo& info) {
+  if (!ready || info.sent) return false;
+  // The sector may have been recycled since the record was read
+  RecordHeader h;
+  if (!flash.read(info.offset, &h, sizeof(h)) || h.sequence != info.sequence || !(h.flags & RECORD_FLAG_UNSENT)) return false;
+  uint8_t flags = (uint8_t)~RECORD_FLAG_UNSENT;
+  if (!flash.write(info.offset + 3, &flags, 1)) return false;
+  counters.unsent--;
+  if (unsent.offset == info.offset) unsent.offset += align4(RECORD_LOG_RECORD_HEADER + info.length);
+  return true;
+}
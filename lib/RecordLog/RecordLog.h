@@ -0,0 +1,125 @@
+#ifndef RECORD_LOG_H
+#define RECORD_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include "FlashPartition.h"
+
+// Append-only record log over a raw flash partition, used as a ring of sectors.
+//
+// Each sector starts with a header (magic, sector sequence, erase count) and
+// holds whole records: a 12-byte header (length, type, flags, record sequence,
+// CRC-32) plus the payload, padded to 4 bytes. Sectors are filled in order and
+// recycled oldest-first, so erases spread evenly over the partition.
+//
+// - append() is O(1): one header and one payload write. The sector after the
+//   head is kept erased ahead of time (maintain()), so crossing into a new
+//   sector normally costs no erase either.
+// - begin() recovers after a crash from the sector headers plus a walk of
+//   every sector's records; a record torn by a power cut fails its CRC, ends
+//   its sector's records (on every later boot too) and the head moves on to a
+//   fresh sector.
+// - Records carry a "sent" flag that is cleared in place (NOR writes can only
+//   clear bits), which drives the backfill cursor across reboots.
+//
+// Not thread-safe: use from one task.
+
+#define RECORD_LOG_MAGIC 0x31474C52u // "RLG1"
+#define RECORD_LOG_SECTOR_HEADER 12
+#define RECORD_LOG_RECORD_HEADER 12
+#define RECORD_LOG_MAX_SECTORS 64 // 256 KB of 4 KB sectors; space beyond is left unused
+
+struct RecordInfo {
+  uint32_t sequence;
+  uint16_t length;
+  uint8_t type;
+  bool sent;
+  uint32_t offset; // of the record header in the partition
+};
+
+// Position in the log; stays valid across appends, and jumps to the oldest
+// record if the sector it points into is recycled
+struct RecordCursor {
+  uint32_t sectorSequence;
+  uint32_t offset;
+};
+
+struct RecordLogStats {
+  uint32_t sectors;
+  uint32_t records;     // in the log now
+  uint32_t unsent;      // of those, not yet marked sent
+  uint32_t dropped;     // unsent records lost to sector recycling
+  uint32_t recovered;   // torn records skipped by begin(), in any sector
+  uint32_t minErases;   // per sector, as recorded in the sector headers
+  uint32_t maxErases;
+  uint32_t usedBytes;
+};
+
+class RecordLog {
+public:
+  explicit RecordLog(FlashPartition& flash);
+
+  // Scans the partition and finds the head, the oldest sector and the first
+  // unsent record. Formats a partition without a valid log.
+  bool begin();
+
+  // Largest payload append() takes
+  size_t maxPayload() const;
+
+  bool append(const void* data, size_t length, uint8_t type = 0);
+
+  // Erases the sector ahead of the head if that is still pending; call from
+  // an idle moment (takes one sector erase, tens of ms on the ESP32)
+  void maintain();
+
+  // Sequential read: the record at the cursor, then moves past it. buffer
+  // gets up to bufferSize bytes of the payload. False at the end of the log.
+  RecordCursor oldest() const;
+  bool next(RecordCursor& cursor, RecordInfo& info, void* buffer, size_t bufferSize);
+
+  // Backfill: the oldest record not marked sent, and marking it
+  bool peekUnsent(RecordInfo& info, void* buffer, size_t bufferSize);
+  bool markSent(const RecordInfo& info);
+
+  RecordLogStats stats() const;
+
+private:
+  struct SectorHeader {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t erases;
+  };
+  struct RecordHeader {
+    uint16_t length;
+    uint8_t type;
+    uint8_t flags;
+    uint32_t sequence;
+    uint32_t crc;
+  };
+
+  uint32_t sectorOffset(uint32_t index) const { return index * sectorBytes; }
+  uint32_t nextSector(uint32_t index) const { return (index + 1) % sectorCount; }
+  bool sectorHeader(uint32_t index, SectorHeader& h);
+  bool eraseSector(uint32_t index);
+  bool openSector(uint32_t index);
+  bool format();
+  bool readRecord(uint32_t offset, uint32_t end, RecordHeader& h, bool checkCrc);
+  uint32_t recordCrc(const RecordHeader& h, uint32_t payloadOffset);
+  bool cursorValid(const RecordCursor& c);
+
+  FlashPartition& flash;
+  uint32_t sectorBytes;
+  uint32_t sectorCount;
+  uint32_t headSector;    // sector being appended to
+  uint32_t headSequence;  // its sector sequence
+  uint32_t headOffset;    // next free byte in the partition
+  uint32_t nextRecord;    // sequence of the next record
+  int32_t aheadErase;     // sector still to erase before the head may enter it, -1 = none
+  uint32_t sectorSequences[RECORD_LOG_MAX_SECTORS]; // 0 = erased / not in the log
+  uint32_t sectorErases[RECORD_LOG_MAX_SECTORS];
+  RecordCursor unsent;
+  RecordLogStats counters;
+  bool ready;
+};
+
+#endif // RECORD_LOG_H
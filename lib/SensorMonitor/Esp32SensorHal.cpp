@@ -0,0 +1,104 @@
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include "Esp32SensorHal.h"
+
+// -------- MAX6675 --------
+bool Max6675Thermocouple::begin() {
+  if (device) return true;
+
+  spi_device_interface_config_t config;
+  memset(&config, 0, sizeof(config));
+  config.mode = 0;
+  config.clock_speed_hz = MAX6675_SPI_HZ;
+  config.spics_io_num = csPin;
+  config.queue_size = 1;
+  return bus.addDevice(config, device);
+}
+
+ThermocoupleStatus Max6675Thermocouple::read(float& celsius) {
+  if (!device) return THERMO_BUS_ERROR;
+
+  spi_transaction_t* done;
+  if (pending) {
+    // A timed-out transaction still belongs to the driver until collected
+    if (spi_device_get_trans_result(device, &done, 0) != ESP_OK) return THERMO_BUS_ERROR;
+    pending = false;
+  }
+
+  memset(&transaction, 0, sizeof(transaction));
+  transaction.flags = SPI_TRANS_USE_RXDATA;
+  transaction.length = 16;
+  transaction.rxlength = 16;
+  if (spi_device_queue_trans(device, &transaction, 0) != ESP_OK) return THERMO_BUS_ERROR;
+
+  if (spi_device_get_trans_result(device, &done, pdMS_TO_TICKS(MAX6675_TIMEOUT_MS)) != ESP_OK) {
+    pending = true;
+    return THERMO_BUS_ERROR;
+  }
+  uint16_t frame = (uint16_t)((transaction.rx_data[0] << 8) | transaction.rx_data[1]);
+  return decodeMax6675(frame, celsius);
+}
+
+// -------- 74HC595 chain --------
+ShiftRegisterChain::ShiftRegisterChain(SpiBus& bus, int8_t latchPin, uint8_t registers, uint32_t clockHz)
+  : bus(bus), latchPin(latchPin),
+    registers(registers == 0 ? 1 : registers > SHIFT_CHAIN_MAX_REGISTERS ? SHIFT_CHAIN_MAX_REGISTERS : registers),
+    clockHz(clockHz), device(nullptr), lock(nullptr), image(0), nextSlot(0), inFlight(0) {}
+
+bool ShiftRegisterChain::begin() {
+  if (device) return true;
+  if (!lock) lock = xSemaphoreCreateMutex();
+  if (!lock) return false;
+
+  spi_device_interface_config_t config;
+  memset(&config, 0, sizeof(config));
+  config.mode = 0;                   // the 595 shifts on the rising SCK edge
+  config.clock_speed_hz = clockHz;
+  config.spics_io_num = latchPin;    // active low: the rising edge at the end latches
+  config.queue_size = SHIFT_CHAIN_QUEUE;
+  config.flags = SPI_DEVICE_NO_DUMMY;
+  if (!bus.addDevice(config, device)) return false;
+
+  image = 0;
+  return update(0, 0);
+}
+
+// Frees the slots of finished transactions
+void ShiftRegisterChain::reap(TickType_t wait) {
+  spi_transaction_t* done;
+  while (inFlight > 0 && spi_device_get_trans_result(device, &done, wait) == ESP_OK) {
+    inFlight--;
+    wait = 0;
+  }
+}
+
+bool ShiftRegisterChain::queueImage() {
+  reap(0);
+  if (inFlight >= SHIFT_CHAIN_QUEUE) reap(pdMS_TO_TICKS(SHIFT_CHAIN_LOCK_MS)); // transfers take microseconds
+  if (inFlight >= SHIFT_CHAIN_QUEUE) return false;
+
+  // The first byte out ends up in the register furthest from the ESP32
+  uint8_t* buf = buffers[nextSlot];
+  uint32_t bits = image;
+  for (uint8_t i = 0; i < registers; i++) buf[i] = (uint8_t)(bits >> (8 * (registers - 1 - i)));
+
+  spi_transaction_t& t = slots[nextSlot];
+  memset(&t, 0, sizeof(t));
+  t.length = registers * 8;
+  t.tx_buffer = buf;
+  if (spi_device_queue_trans(device, &t, 0) != ESP_OK) return false;
+  inFlight++;
+  nextSlot = (nextSlot + 1) % SHIFT_CHAIN_QUEUE;
+  return true;
+}
+
+bool ShiftRegisterChain::update(uint32_t mask, uint32_t value) {
+  if (!device) return false;
+  if (xSemaphoreTake(lock, pdMS_TO_TICKS(SHIFT_CHAIN_LOCK_MS)) != pdTRUE) return false;
+  image = (image & ~mask) | (value & mask);
+  bool ok = queueImage();
+  xSemaphoreGive(lock);
+  return ok;
+}
+
+#endif // ARDUINO_ARCH_ESP32
@@ -0,0 +1,95 @@
+#ifndef ESP32_SENSOR_HAL_H
+#define ESP32_SENSOR_HAL_H
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <Arduino.h>
+#include <freertos/semphr.h>
+#include "SensorHal.h"
+#include "Max6675.h"
+#include "Esp32SpiBus.h"
+
+#define MAX6675_TIMEOUT_MS 2 // a 16-bit frame takes 4 us at MAX6675_SPI_HZ
+
+#define SHIFT_REGISTER_SPI_HZ 4000000 // 74HC595 at 3.3 V shifts at 20+ MHz; board wiring is the limit
+#define SHIFT_CHAIN_MAX_REGISTERS 4   // outputs are a uint32_t image
+#define SHIFT_CHAIN_QUEUE 4           // transactions in flight per chain
+#define SHIFT_CHAIN_LOCK_MS 2
+
+// MAX6675 as a device on a SpiBus (VSPI on this board: SCK 18, MISO 19, CS 5
+// are its native pins). A read is one queued 16-bit transaction: the SPI
+// driver clocks it out from its interrupt and the calling task sleeps on the
+// result instead of bit-banging.
+class Max6675Thermocouple : public ThermocoupleHal {
+public:
+  Max6675Thermocouple(SpiBus& bus, int8_t csPin) : bus(bus), csPin(csPin), device(nullptr), pending(false) {}
+
+  bool begin() override;
+  ThermocoupleStatus read(float& celsius) override;
+
+private:
+  SpiBus& bus;
+  int8_t csPin;
+  spi_device_handle_t device;
+  spi_transaction_t transaction; // owned by the driver while queued
+  bool pending;                  // queued but not collected (timed out)
+};
+
+// Chain of 74HC595s as a write-only device on a SpiBus, with the latch (RCLK)
+// as its chip select: CS falls while the image shifts in and its rising edge
+// at the end of the transaction moves the image to the outputs in one step.
+//
+// Output n is bit n of the image: Qn of the register nearest the ESP32 for
+// n < 8, of the next register for 8..15, and so on. update() changes some
+// outputs and queues the whole image as one transaction without waiting for
+// it; any task may call it.
+class ShiftRegisterChain {
+public:
+  ShiftRegisterChain(SpiBus& bus, int8_t latchPin, uint8_t registers, uint32_t clockHz = SHIFT_REGISTER_SPI_HZ);
+
+  // All outputs low. Safe to call more than once.
+  bool begin();
+
+  // Sets the outputs in mask to value. False if the transfer could not be
+  // queued; the image keeps the change and goes out with the next update.
+  bool update(uint32_t mask, uint32_t value);
+
+  uint32_t outputs() const { return image; }
+  uint8_t outputCount() const { return registers * 8; }
+
+private:
+  bool queueImage();
+  void reap(TickType_t wait);
+
+  SpiBus& bus;
+  int8_t latchPin;
+  uint8_t registers;
+  uint32_t clockHz;
+  spi_device_handle_t device;
+  SemaphoreHandle_t lock;
+  volatile uint32_t image;
+  uint8_t nextSlot;
+  uint8_t inFlight;
+  spi_transaction_t slots[SHIFT_CHAIN_QUEUE];
+  WORD_ALIGNED_ATTR uint8_t buffers[SHIFT_CHAIN_QUEUE][SHIFT_CHAIN_MAX_REGISTERS]; // DMA-capable: in DRAM
+};
+
+// count fans on outputs firstOutput.. of a chain (fan n on firstOutput + n);
+// the chain's other outputs are left alone
+class ShiftRegisterFans : public FanHal {
+public:
+  ShiftRegisterFans(ShiftRegisterChain& chain, uint8_t firstOutput, uint8_t count)
+    : chain(chain), outputs(((1u << count) - 1) << firstOutput), firstOutput(firstOutput) {}
+
+  bool begin() override { return chain.begin(); }
+  bool write(uint8_t mask) override { return chain.update(outputs, (uint32_t)mask << firstOutput); }
+
+private:
+  ShiftRegisterChain& chain;
+  uint32_t outputs;
+  uint8_t firstOutput;
+};
+
+#endif // ARDUINO_ARCH_ESP32
+
+#endif // ESP32_SENSOR_HAL_H
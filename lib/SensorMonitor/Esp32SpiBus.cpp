@@ -0,0 +1,26 @@
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include "Esp32SpiBus.h"
+
+bool SpiBus::begin() {
+  if (started) return true;
+
+  spi_bus_config_t bus;
+  memset(&bus, 0, sizeof(bus));
+  bus.mosi_io_num = mosiPin;
+  bus.miso_io_num = misoPin;
+  bus.sclk_io_num = sckPin;
+  bus.quadwp_io_num = -1;
+  bus.quadhd_io_num = -1;
+  bus.max_transfer_sz = 0; // driver default: 4092 bytes with DMA, 64 without
+  esp_err_t err = spi_bus_initialize(spiHost, &bus, dma ? SPI_DMA_CH_AUTO : SPI_DMA_DISABLED);
+  started = err == ESP_OK;
+  return started;
+}
+
+bool SpiBus::addDevice(const spi_device_interface_config_t& config, spi_device_handle_t& handle) {
+  if (!begin()) return false;
+  return spi_bus_add_device(spiHost, &config, &handle) == ESP_OK;
+}
+
+#endif // ARDUINO_ARCH_ESP32
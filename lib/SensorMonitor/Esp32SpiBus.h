@@ -0,0 +1,39 @@
+#ifndef ESP32_SPI_BUS_H
+#define ESP32_SPI_BUS_H
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <Arduino.h>
+#include <driver/spi_master.h>
+
+// One SPI host and the devices on it. The bus is initialised once, by the
+// first device that starts; every device then gets its own handle (its own
+// chip select, clock and transaction queue) on the shared SCK/MOSI/MISO, and
+// the IDF driver arbitrates between them per transaction.
+class SpiBus {
+public:
+  // Unused lines are -1. dma: transfers go through the host's DMA channel,
+  // so transaction buffers must be in DMA-capable RAM (not flash or PSRAM).
+  SpiBus(spi_host_device_t host, int8_t sckPin, int8_t mosiPin, int8_t misoPin, bool dma)
+    : spiHost(host), sckPin(sckPin), mosiPin(mosiPin), misoPin(misoPin), dma(dma), started(false) {}
+
+  // Safe to call from every device's begin()
+  bool begin();
+
+  // Registers a device; false if the bus could not start or the driver refused
+  bool addDevice(const spi_device_interface_config_t& config, spi_device_handle_t& handle);
+
+  spi_host_device_t host() const { return spiHost; }
+
+private:
+  spi_host_device_t spiHost;
+  int8_t sckPin;
+  int8_t mosiPin;
+  int8_t misoPin;
+  bool dma;
+  bool started;
+};
+
+#endif // ARDUINO_ARCH_ESP32
+
+#endif // ESP32_SPI_BUS_H
@@ -0,0 +1,116 @@
+#include "FanControl.h"
+#include <cstring>
+
+FanControlConfig defaultFanConfig() {
+  FanControlConfig config;
+  memset(&config, 0, sizeof(config));
+  config.version = FAN_FORMAT_VERSION;
+  config.stageCount = 2;
+  config.stages[0].onC = FAN_STAGE_1_ON;
+  config.stages[0].offC = FAN_STAGE_1_OFF;
+  config.stages[0].mask = STAGE_1_FANS;
+  config.stages[1].onC = FAN_STAGE_2_ON;
+  config.stages[1].offC = FAN_STAGE_2_OFF;
+  config.stages[1].mask = ALL_FANS;
+  config.minHoldMs = FAN_MIN_HOLD_MS;
+  return config;
+}
+
+bool validFanConfig(const FanControlConfig& config) {
+  if (config.version != FAN_FORMAT_VERSION || config.stageCount > FAN_MAX_STAGES) return false;
+  for (uint8_t i = 0; i < config.stageCount; i++) {
+    const FanStage& s = config.stages[i];
+    if (!(s.offC < s.onC) || s.mask != FAN_MASK(s.mask)) return false; // also rejects NaN
+    if (i > 0 && !(config.stages[i - 1].onC < s.onC)) return false;
+  }
+  return true;
+}
+
+FanControl::FanControl(FanHal& hal)
+  : hal(hal), log(nullptr), appliedVersion(0), active(defaultFanConfig()), active_fans(0x00), current_state(0),
+    stage(0), stage_since_ms(0), transition_count(0), override_mask(-1) {
+  pending.write(active);
+  appliedVersion = pending.version();
+}
+
+bool FanControl::begin() {
+  if (!hal.begin() || !hal.write(0x00)) return false;
+  active_fans = 0x00;
+  current_state = 0;
+  stage = 0;
+  return true;
+}
+
+bool FanControl::setConfig(const FanControlConfig& config) {
+  if (!validFanConfig(config)) return false;
+  pending.write(config);
+  return true;
+}
+
+FanControlConfig FanControl::config() const {
+  FanControlConfig config = active;
+  pending.read(config);
+  return config;
+}
+
+void FanControl::refreshConfig() {
+  uint32_t version = pending.version();
+  if (version == appliedVersion) return;
+  FanControlConfig config;
+  if (!pending.read(config)) return; // being written; next update
+  active = config;
+  appliedVersion = version;
+  if (stage > active.stageCount) stage = active.stageCount;
+  current_state = -2; // re-drive the fans for the new masks
+}
+
+void FanControl::apply(int state, uint8_t mask) {
+  if (state == current_state && mask == active_fans) return;
+  if (!hal.write(FAN_MASK(mask))) return; // hardware busy: tried again on the next update
+  active_fans = mask;
+  current_state = state;
+  transition_count = transition_count + 1;
+  if (!log) return;
+  if (state < 0) log->printf("Fan override: 0x%02X\n", mask);
+  else if (state == 0) log->println("All Fans OFF");
+  else log->printf("Fan stage %d ON: 0x%02X\n", state, mask);
+}
+
+void FanControl::update(float temp, uint32_t nowMs) {
+  refreshConfig();
+
+  // === 1. Stage for this temperature, with hysteresis ===
+  int next = stage;
+  while (next < active.stageCount && temp >= active.stages[next].onC) next++;
+  if (next == stage) {
+    while (next > 0 && temp < active.stages[next - 1].offC) next--;
+    // Rate limit: step down only once the stage has run its minimum time
+    if (next < stage && nowMs - stage_since_ms < active.minHoldMs) next = stage;
+  }
+  if (next != stage) {
+    stage = next;
+    stage_since_ms = nowMs;
+  }
+
+  // === 2. Drive the fans ===
+  drive();
+}
+
+void FanControl::failSafe(uint32_t nowMs) {
+  refreshConfig();
+  if (stage != active.stageCount) {
+    stage = active.stageCount;
+    stage_since_ms = nowMs;
+  }
+  drive();
+}
+
+void FanControl::drive() {
+  int mask = override_mask;
+  if (mask >= 0) {
+    // Manual override: hold the requested mask, re-evaluate once released
+    apply(-1, (uint8_t)mask);
+  } else {
+    apply(stage, stage > 0 ? active.stages[stage - 1].mask : 0x00);
+  }
+}
@@ -0,0 +1,99 @@
+#ifndef FAN_CONTROL_H
+#define FAN_CONTROL_H
+
+#include <Arduino.h>
+#include "SensorHal.h"
+#include "Seqlock.h"
+
+#define NUM_FANS 4
+#define FAN_MAX_STAGES 4
+
+#define FAN_MASK(x) ((x) & ((1 << NUM_FANS) - 1))
+
+// Fan bitmasks
+#define STAGE_1_FANS ((1 << 0) | (1 << 2))  // Fans 0,2
+#define STAGE_2_FANS ((1 << 1) | (1 << 3))  // Fans 1,3
+#define ALL_FANS     (STAGE_1_FANS | STAGE_2_FANS)
+
+// Default staging: stage 1 at 80 C (off below 70), all fans at 90 C (back to
+// stage 1 below 85)
+#define FAN_STAGE_1_ON   80.0f
+#define FAN_STAGE_1_OFF  70.0f
+#define FAN_STAGE_2_ON   90.0f
+#define FAN_STAGE_2_OFF  85.0f
+#define FAN_MIN_HOLD_MS  30000 // a stage runs at least this long before stepping down
+#define FAN_FORMAT_VERSION 1   // bump when FanControlConfig changes layout
+
+// Stage n is entered at onC or above and left below offC (< onC); its mask
+// replaces the lower stages' masks
+struct FanStage {
+  float onC;
+  float offC;
+  uint8_t mask;
+};
+
+// Plain data, stored in NVS as-is
+struct FanControlConfig {
+  uint8_t version;
+  uint8_t stageCount;
+  FanStage stages[FAN_MAX_STAGES]; // ascending onC
+  uint32_t minHoldMs;
+};
+
+FanControlConfig defaultFanConfig();
+
+// Stages ascending, each offC below its onC, masks within NUM_FANS
+bool validFanConfig(const FanControlConfig& config);
+
+// Temperature-staged fan state machine over a FanHal. update() runs on the
+// thermal task for every fresh temperature; setConfig() and setOverride() may
+// be called from any task and are picked up by the next update().
+//
+// Stepping up is immediate, stepping down waits until the stage has run for
+// minHoldMs, so a reading hovering around offC cannot cycle the fans.
+class FanControl {
+public:
+  explicit FanControl(FanHal& hal);
+
+  // Fans off
+  bool begin();
+
+  // Picks the stage for this temperature and drives the fans if it changed
+  void update(float temp, uint32_t nowMs);
+
+  // Thermocouple lost: top stage until update() gets a temperature again
+  void failSafe(uint32_t nowMs);
+
+  // False (and nothing changed) if the config is not valid
+  bool setConfig(const FanControlConfig& config);
+  FanControlConfig config() const;
+
+  // Holds a fixed mask (bit per fan) until released with -1
+  void setOverride(int mask) { override_mask = mask < 0 ? -1 : FAN_MASK(mask); }
+
+  uint8_t activeFans() const { return active_fans; }
+  int state() const { return current_state; } // 0=off, n=stage n, -1=override
+  uint32_t transitions() const { return transition_count; }
+
+  // Transitions are reported here when set
+  void setLog(Print* out) { log = out; }
+
+private:
+  void refreshConfig();
+  void drive();
+  void apply(int state, uint8_t mask);
+
+  FanHal& hal;
+  Print* log;
+  Seqlock<FanControlConfig> pending;
+  uint32_t appliedVersion;
+  FanControlConfig active;
+  volatile uint8_t active_fans;
+  volatile int current_state;
+  int stage;               // automatic stage, kept while overridden
+  uint32_t stage_since_ms;
+  volatile uint32_t transition_count;
+  volatile int override_mask;
+};
+
+#endif // FAN_CONTROL_H
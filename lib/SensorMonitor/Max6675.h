@@ -0,0 +1,34 @@
+#ifndef MAX6675_H
+#define MAX6675_H
+
+#include <cstdint>
+#include "SensorHal.h"
+
+// MAX6675 K-type thermocouple converter: one 16-bit frame per read, MSB
+// first. Bit 15 is a dummy 0, bits 14..3 the temperature in 0.25 C steps,
+// bit 2 set when the thermocouple input is open, bit 1 the device ID (0).
+// Pulling CS low aborts a conversion in progress; raising it starts the next.
+
+#define MAX6675_CONVERSION_MS 220 // max, 170 typical
+#define MAX6675_SPI_HZ 4000000    // 4.3 MHz max SCK
+#define MAX6675_OPEN_BIT 0x0004
+#define MAX6675_FIXED_BITS 0x8002 // read 0 from a MAX6675
+
+inline ThermocoupleStatus decodeMax6675(uint16_t frame, float& celsius) {
+  // A floating or shorted MISO reads all ones or breaks the fixed bits
+  if ((frame & MAX6675_FIXED_BITS) != 0) return THERMO_NO_DEVICE;
+  if (frame & MAX6675_OPEN_BIT) return THERMO_OPEN;
+  celsius = (frame >> 3) * 0.25f;
+  return THERMO_OK;
+}
+
+// Inverse, for replays and tests
+inline uint16_t encodeMax6675(float celsius, bool open) {
+  if (open) return MAX6675_OPEN_BIT;
+  int32_t q = (int32_t)(celsius * 4.0f + 0.5f);
+  if (q < 0) q = 0;
+  if (q > 4095) q = 4095;
+  return (uint16_t)(q << 3);
+}
+
+#endif // MAX6675_H
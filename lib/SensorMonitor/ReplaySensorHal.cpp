@@ -0,0 +1,86 @@
+#if !defined(ARDUINO_ARCH_ESP32)
+
+#include "ReplaySensorHal.h"
+
+// -------- Trace --------
+bool SensorTrace::load(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+
+  size_t before = rows.size();
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    const char* p = line;
+    if (strncmp(p, "trace ", 6) == 0) p += 6;
+    if (*p < '0' || *p > '9') continue;
+
+    SensorTraceRow row;
+    memset(&row, 0, sizeof(row));
+    char* end;
+    row.ms = (uint32_t)strtoul(p, &end, 10);
+    p = end;
+    row.celsius = strtof(p, &end);
+    if (end == p) continue;
+    p = end;
+    for (uint8_t ch = 0; ch < REPLAY_MAX_CHANNELS; ch++) {
+      long v = strtol(p, &end, 10);
+      if (end == p) break;
+      row.counts[ch] = (uint16_t)(v < 0 ? 0 : v > 4095 ? 4095 : v);
+      p = end;
+    }
+    add(row);
+  }
+  fclose(f);
+  return rows.size() > before;
+}
+
+void SensorTrace::add(const SensorTraceRow& row) {
+  rows.push_back(row);
+}
+
+// -------- Replay --------
+ReplaySensorHal::ReplaySensorHal(const SensorTrace& trace, uint16_t noise)
+  : trace(trace), startMs(millis()), cursor(0), adc(*this, noise), thermocouple(*this), fans(*this) {
+  memset(&empty, 0, sizeof(empty));
+}
+
+void ReplaySensorHal::restart() {
+  startMs = millis();
+  cursor = 0;
+  fans.changes = 0;
+}
+
+const SensorTraceRow& ReplaySensorHal::current() {
+  if (trace.size() == 0) return empty;
+  // Time only moves forward, so the cursor does too
+  uint32_t t = trace.row(0).ms + elapsedMs();
+  while (cursor + 1 < trace.size() && trace.row(cursor + 1).ms <= t) cursor++;
+  return trace.row(cursor);
+}
+
+size_t ReplaySensorHal::Adc::read(uint16_t* samples, size_t count, uint32_t) {
+  int32_t level = owner.current().counts[selected];
+  for (size_t i = 0; i < count; i++) {
+    int32_t v = level;
+    if (noise) {
+      rng ^= rng << 13;
+      rng ^= rng >> 17;
+      rng ^= rng << 5;
+      v += (int32_t)(rng % (2u * noise + 1)) - (int32_t)noise;
+    }
+    samples[i] = (uint16_t)(v < 0 ? 0 : v > 4095 ? 4095 : v);
+  }
+  return count;
+}
+
+bool ReplaySensorHal::Fans::write(uint8_t value) {
+  if (changes < REPLAY_MAX_FAN_CHANGES && (changes == 0 || history[changes - 1].mask != value)) {
+    history[changes].ms = owner.elapsedMs();
+    history[changes].mask = value;
+    changes++;
+  }
+  mask = value;
+  return true;
+}
+
+#endif // !ARDUINO_ARCH_ESP32
@@ -0,0 +1,134 @@
+#ifndef REPLAY_SENSOR_HAL_H
+#define REPLAY_SENSOR_HAL_H
+
+#if !defined(ARDUINO_ARCH_ESP32)
+
+#include <Arduino.h>
+#include <vector>
+#include "SensorHal.h"
+#include "Max6675.h"
+
+// Host stand-in for the whole sensor board, driven by a trace: one row per
+// point in time with the thermocouple temperature and the ADC counts of each
+// mux channel. The row in effect is picked by millis(), which on the host only
+// moves when the firmware delays (see nativeUseVirtualClock()), so hours of
+// readings replay in milliseconds and every run sees exactly the same input.
+//
+// Trace text, one row per line:
+//   [trace ]<ms> <temp C or nan> <counts ch0> <counts ch1> ... (up to 16)
+// SensorMonitor::setTrace() writes these rows; other lines are skipped, so a
+// serial capture of the board loads as is. Time is relative to the first row.
+
+#define REPLAY_MAX_CHANNELS 16
+#define REPLAY_MAX_FAN_CHANGES 64
+
+struct SensorTraceRow {
+  uint32_t ms;
+  float celsius;
+  uint16_t counts[REPLAY_MAX_CHANNELS];
+};
+
+class SensorTrace {
+public:
+  // Appends the rows in path; false if it could not be read or held none
+  bool load(const char* path);
+
+  // Rows must come in time order
+  void add(const SensorTraceRow& row);
+  void clear() { rows.clear(); }
+
+  size_t size() const { return rows.size(); }
+  const SensorTraceRow& row(size_t i) const { return rows[i]; }
+  uint32_t durationMs() const { return rows.empty() ? 0 : rows.back().ms - rows.front().ms; }
+
+private:
+  std::vector<SensorTraceRow> rows;
+};
+
+class ReplaySensorHal {
+public:
+  // noise: peak counts of uniform noise added to every conversion, so the
+  // filter chains see something like the real input
+  explicit ReplaySensorHal(const SensorTrace& trace, uint16_t noise = 0);
+
+  // Restarts the trace at the current millis() and forgets the fan history
+  void restart();
+
+  uint32_t elapsedMs() const { return (uint32_t)(millis() - startMs); }
+  bool finished() const { return elapsedMs() > trace.durationMs(); }
+
+  // Row in effect now; all zero for an empty trace
+  const SensorTraceRow& current();
+
+  SensorHal hal() {
+    SensorHal h = { adc, thermocouple, fans };
+    return h;
+  }
+
+  // Fan masks the firmware drove, in order, repeats folded (the first
+  // REPLAY_MAX_FAN_CHANGES after restart())
+  struct FanChange {
+    uint32_t ms; // since restart()
+    uint8_t mask;
+  };
+  uint8_t fanMask() const { return fans.mask; }
+  size_t fanChangeCount() const { return fans.changes; }
+  const FanChange& fanChange(size_t i) const { return fans.history[i]; }
+
+private:
+  class Adc : public AdcHal {
+  public:
+    Adc(ReplaySensorHal& owner, uint16_t noise) : owner(owner), noise(noise), selected(0), rng(2463534242u) {}
+    bool begin() override { return true; }
+    void selectChannel(uint8_t channel) override { selected = channel % REPLAY_MAX_CHANNELS; }
+    size_t read(uint16_t* samples, size_t count, uint32_t timeoutMs) override;
+    uint32_t sampleRateHz() const override { return 40000; }
+
+  private:
+    ReplaySensorHal& owner;
+    uint16_t noise;
+    uint8_t selected;
+    uint32_t rng;
+  };
+
+  class Thermocouple : public ThermocoupleHal {
+  public:
+    explicit Thermocouple(ReplaySensorHal& owner) : owner(owner) {}
+    bool begin() override { return true; }
+    // Through a MAX6675 frame, so the replay sees its 0.25 C steps; nan rows
+    // read as an open probe
+    ThermocoupleStatus read(float& celsius) override {
+      float c = owner.current().celsius;
+      return decodeMax6675(encodeMax6675(c, c != c), celsius);
+    }
+
+  private:
+    ReplaySensorHal& owner;
+  };
+
+  class Fans : public FanHal {
+  public:
+    explicit Fans(ReplaySensorHal& owner) : mask(0), changes(0), owner(owner) {}
+    bool begin() override { return true; }
+    bool write(uint8_t value) override;
+
+    uint8_t mask;
+    size_t changes;
+    FanChange history[REPLAY_MAX_FAN_CHANGES];
+
+  private:
+    ReplaySensorHal& owner;
+  };
+
+  const SensorTrace& trace;
+  unsigned long startMs;
+  size_t cursor;
+  SensorTraceRow empty;
+  Adc adc;
+  Thermocouple thermocouple;
+  Fans fans;
+};
+
+#endif // !ARDUINO_ARCH_ESP32
+
+#endif // REPLAY_SENSOR_HAL_H
@@ -0,0 +1,57 @@
+#ifndef SENSOR_HAL_H
+#define SENSOR_HAL_H
+
+#include <cstdint>
+#include "AdcHal.h"
+
+// Hardware seams of the sensor task besides the mux + ADC (AdcHal.h): the
+// thermocouple amplifier and the fan shift register. Esp32SensorHal.h drives
+// the board; ReplaySensorHal.h plays recorded or synthetic traces on the host.
+enum ThermocoupleStatus : uint8_t {
+  THERMO_OK,
+  THERMO_OPEN,      // converter answered: probe open or not connected
+  THERMO_NO_DEVICE, // nothing (or garbage) on the bus
+  THERMO_BUS_ERROR, // the transaction failed or timed out
+  THERMO_NOT_READ   // no read yet
+};
+
+inline const char* thermocoupleStatusName(ThermocoupleStatus status) {
+  switch (status) {
+    case THERMO_OK: return "ok";
+    case THERMO_OPEN: return "open";
+    case THERMO_NO_DEVICE: return "no device";
+    case THERMO_BUS_ERROR: return "bus error";
+    default: return "not read";
+  }
+}
+
+class ThermocoupleHal {
+public:
+  virtual ~ThermocoupleHal() {}
+
+  virtual bool begin() = 0;
+
+  // Latest conversion; celsius is only written on THERMO_OK. Reading starts
+  // the next conversion, so call at most once per conversion time.
+  virtual ThermocoupleStatus read(float& celsius) = 0;
+};
+
+class FanHal {
+public:
+  virtual ~FanHal() {}
+
+  virtual bool begin() = 0;
+
+  // Drives every fan at once, bit n = fan n. False if the new mask could not
+  // be handed to the hardware; the caller retries.
+  virtual bool write(uint8_t mask) = 0;
+};
+
+// Everything SensorMonitor touches
+struct SensorHal {
+  AdcHal& adc;
+  ThermocoupleHal& thermocouple;
+  FanHal& fans;
+};
+
+#endif // SENSOR_HAL_H
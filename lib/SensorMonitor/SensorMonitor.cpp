@@ -0,0 +1,141 @@
+#include "SensorMonitor.h"
+
+SensorMonitor::SensorMonitor(const SensorHal& hal, const SensorRegistry& registry)
+  : hal(hal), appliedVersion(0), count(0), calCount(0), retiredFields(0), adcSampler(hal.adc),
+    thermalLoop(hal.thermocouple, hal.fans), sensorProcessor(thermalLoop), log(nullptr) {
+  memset(&adcFrame, 0, sizeof(adcFrame));
+  memset(&stepSample, 0, sizeof(stepSample));
+  SensorRegistry initial = validSensorRegistry(registry) ? registry : defaultSensorRegistry();
+  pending.write(initial);
+  appliedVersion = pending.version();
+  configure(initial);
+  resetCalibration();
+}
+
+void SensorMonitor::setLog(Print* out) {
+  log = out;
+  thermalLoop.setLog(out);
+  sensorProcessor.setLog(out);
+}
+
+int SensorMonitor::slotOf(uint8_t channel) const {
+  for (uint8_t i = 0; i < count; i++) {
+    if (sweepChannels[i] == channel) return i;
+  }
+  return -1;
+}
+
+// Slots, sweep channels and calibrated channels for a registry
+void SensorMonitor::configure(const SensorRegistry& registry) {
+  uint8_t order[SENSOR_MAX];
+  uint32_t oldFields = 0;
+  for (uint8_t i = 0; i < count; i++) oldFields |= 1u << slots[i].field;
+
+  active = registry;
+  count = sensorSweepOrder(registry, order);
+  calCount = 0;
+  uint32_t fields = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    slots[i] = registry.sensors[order[i]];
+    sweepChannels[i] = slots[i].channel;
+    if (sensorDecoders[slots[i].decoder].calibrated) calChannels[calCount++] = slots[i].channel;
+    fields |= 1u << slots[i].field;
+  }
+  retiredFields = oldFields & ~fields;
+  scheduler.reset(slots, count);
+}
+
+bool SensorMonitor::begin() {
+  bool ok = true;
+
+  // --- Multiplexer + ADC (12-bit, 11dB: full range 0–3.9V) ---
+  if (!adcSampler.begin(sweepChannels, count)) {
+    if (log) log->println("ADC sampler failed to start!");
+    ok = false;
+  }
+  for (uint8_t i = 0; i < count; i++) adcSampler.setFilter(i, sensorFilters[slots[i].filter].config);
+
+  ok &= compileCalibration();
+
+  // --- Thermocouple, fans off ---
+  ok &= thermalLoop.begin();
+  return ok;
+}
+
+bool SensorMonitor::setRegistry(const SensorRegistry& registry) {
+  if (!validSensorRegistry(registry)) return false;
+  pending.write(registry);
+  return true;
+}
+
+SensorRegistry SensorMonitor::registry() const {
+  SensorRegistry registry = active;
+  pending.read(registry);
+  return registry;
+}
+
+bool SensorMonitor::applyRegistry() {
+  uint32_t version = pending.version();
+  if (version == appliedVersion) return false;
+  SensorRegistry registry;
+  if (!pending.read(registry)) return false; // being written; next pass
+  appliedVersion = version;
+
+  configure(registry);
+  if (!adcSampler.begin(sweepChannels, count) && log) log->println("ADC sampler failed to restart!");
+  for (uint8_t i = 0; i < count; i++) adcSampler.setFilter(i, sensorFilters[slots[i].filter].config);
+  resetCalibration();
+  if (log) {
+    log->printf("Sensors: %u channel(s), %u select-line toggles per sweep\n", count,
+                muxSelectToggles(sweepChannels, count));
+  }
+  return true;
+}
+
+void SensorMonitor::resetCalibration() {
+  for (uint8_t i = 0; i < count; i++) {
+    if (!sensorDecoders[slots[i].decoder].calibrated) continue;
+    tables.set(slots[i].channel, sensorDefaultCurve(slots[i].decoder, slots[i].channel));
+  }
+}
+
+bool SensorMonitor::compileCalibration() {
+  if (tables.compile(calChannels, calCount)) return true;
+  if (log) log->println("Calibration tables: out of memory!");
+  return false;
+}
+
+bool SensorMonitor::sample(SensorSample& out) {
+  out.retiredFields = retiredFields;
+  retiredFields = 0;
+  out.count = 0;
+
+  // One DMA sweep: the due channels oversampled back-to-back, in Gray order
+  uint16_t due = scheduler.due(micros());
+  if (!due) return out.retiredFields != 0;
+  if (!adcSampler.sweep(adcFrame, due) && log) {
+    log->printf("ADC sweep incomplete: %u channel(s) missing\n", adcFrame.missing);
+  }
+  scheduler.completed(due, adcFrame.startUs, adcFrame.startUs + adcFrame.durationUs);
+
+  out.sequence = adcFrame.sequence;
+  out.startUs = adcFrame.startUs;
+  out.durationUs = adcFrame.durationUs;
+  out.samples = adcFrame.samples;
+  out.missing = adcFrame.missing;
+  for (uint8_t i = 0; i < count; i++) {
+    if (!((adcFrame.fresh >> i) & 1u)) continue;
+    const SensorConfig& sensor = slots[i];
+    SensorReading& r = out.readings[out.count++];
+    r.channel = sensor.channel;
+    r.field = sensor.field;
+    r.raw = adcFrame.value[i];
+    r.value = sensorDecoders[sensor.decoder].decode(tables, sensor.channel, adcFrame.value[i]);
+  }
+  return true;
+}
+
+bool SensorMonitor::step(TelemetryFrame& readings) {
+  if (sample(stepSample)) sensorProcessor.merge(stepSample, readings);
+  return sensorProcessor.pass(readings);
+}
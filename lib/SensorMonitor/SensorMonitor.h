@@ -0,0 +1,113 @@
+#ifndef SENSOR_MONITOR_H
+#define SENSOR_MONITOR_H
+
+#include <Arduino.h>
+#include <cmath>
+#include "SensorHal.h"
+#include "AdcSampler.h"
+#include "Calibration.h"
+#include "ThermalLoop.h"
+#include "Telemetry.h"
+#include "SensorRegistry.h"
+#include "SensorScheduler.h"
+#include "SensorProcessor.h"
+#include "Seqlock.h"
+
+// The sensor task, free of board specifics: sweep the mux channels whose
+// period is up (SensorScheduler) and decode them into a SensorSample, which
+// the SensorProcessor merges into a TelemetryFrame, adding the thermal loop's
+// latest temperature once per publish pass. On the ESP32 the two halves run
+// on their own tasks with a queue between them; step() does both. Which
+// channels are read, how and how often comes from a SensorRegistry that can
+// be replaced at runtime. The thermal loop (thermocouple + fan staging) is
+// owned here but polled from its own task. The board wiring comes in through
+// SensorHal, so the same code runs on the ESP32 (Sensors.cpp) and against
+// trace replays on the host (native/bench).
+class SensorMonitor {
+public:
+  SensorMonitor(const SensorHal& hal, const SensorRegistry& registry);
+
+  // Sampler, filter chains, calibration tables, thermocouple and fans off
+  bool begin();
+
+  // Acquisition: sweeps and decodes the sensors that are due now, if any.
+  // True if there is something for the processor: readings, or fields of
+  // sensors removed by applyRegistry().
+  bool sample(SensorSample& out);
+
+  // A publish pass in one go: sample(), merged and passed through
+  // processor(). TEL_TEMP is only set (and true returned) when the
+  // thermocouple reads THERMO_OK.
+  bool step(TelemetryFrame& readings);
+
+  // Until the next sensor is due, 0 if one is
+  uint32_t usUntilDue() const { return scheduler.usUntilDue(micros()); }
+
+  // False (and nothing changed) if the registry is not valid. Any task; the
+  // sensor task takes it up with applyRegistry().
+  bool setRegistry(const SensorRegistry& registry);
+  SensorRegistry registry() const;
+
+  // Sensor task, before step(): switches to a registry passed to
+  // setRegistry() since the last call. The sweep restarts with fresh filters
+  // and the built-in curves of the new decoders; true if that happened, so
+  // the caller can load stored curves and compileCalibration().
+  bool applyRegistry();
+
+  // Curves start out as the decoders' built-in ones; resetCalibration()
+  // restores them. Individual curves are replaced through calibration().set()
+  // and take effect when begin() or compileCalibration() builds the tables.
+  // Sensor task only.
+  void resetCalibration();
+  bool compileCalibration();
+  CalibrationTables& calibration() { return tables; }
+
+  AdcSampler& sampler() { return adcSampler; }
+  ThermalLoop& thermal() { return thermalLoop; }
+  FanControl& fans() { return thermalLoop.fans(); }
+  SensorScheduler& schedule() { return scheduler; }
+  SensorProcessor& processor() { return sensorProcessor; }
+  const AdcFrame& frame() const { return adcFrame; }
+
+  // Sweep slot of a mux channel, -1 if it is not swept. Slots are in sweep
+  // order (sensorSweepOrder()), not registry order.
+  int slotOf(uint8_t channel) const;
+  const uint8_t* channels() const { return sweepChannels; }
+  const SensorConfig& sensor(uint8_t slot) const { return slots[slot]; }
+  uint8_t sensorCount() const { return count; }
+
+  // Channels whose decoder converts through a calibration table
+  const uint8_t* calibratedChannels() const { return calChannels; }
+  uint8_t calibratedCount() const { return calCount; }
+
+  // Debug output, nullptr for none
+  void setLog(Print* out);
+
+  // Every pass also prints a trace row (see ReplaySensorHal.h) to out, so a
+  // serial capture of the board replays on the host
+  void setTrace(Print* out) { sensorProcessor.setTrace(out); }
+
+private:
+  void configure(const SensorRegistry& registry);
+
+  SensorHal hal;
+  Seqlock<SensorRegistry> pending;
+  uint32_t appliedVersion;
+  SensorRegistry active;
+  SensorConfig slots[SENSOR_MAX]; // active's sensors in sweep order
+  uint8_t count;
+  uint8_t sweepChannels[ADC_MAX_CHANNELS];
+  uint8_t calChannels[ADC_MAX_CHANNELS];
+  uint8_t calCount;
+  SensorScheduler scheduler;
+  uint32_t retiredFields;   // fields of removed sensors, unset by the next sample()
+  AdcSampler adcSampler;
+  AdcFrame adcFrame;
+  CalibrationTables tables;
+  ThermalLoop thermalLoop;
+  SensorProcessor sensorProcessor;
+  SensorSample stepSample; // step()'s
+  Print* log;
+};
+
+#endif // SENSOR_MONITOR_H
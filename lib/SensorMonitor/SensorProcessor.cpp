@@ -0,0 +1,88 @@
+#include "SensorProcessor.h"
+
+SensorProcessor::SensorProcessor(ThermalLoop& thermal)
+  : thermalLoop(thermal), merged_count(0), last_duration_us(0), last_samples(0), last_count(0), log(nullptr),
+    trace(nullptr) {
+  memset(latest, 0, sizeof(latest));
+}
+
+void SensorProcessor::merge(const SensorSample& sample, TelemetryFrame& readings) {
+  for (uint8_t f = 0; f < TEL_FIELD_COUNT; f++) {
+    if (!((sample.retiredFields >> f) & 1u)) continue;
+    readings.unset((TelemetryField)f);
+    for (uint8_t ch = 0; ch < ADC_MAX_CHANNELS; ch++) {
+      if (latest[ch].field == f) latest[ch].valid = false;
+    }
+  }
+
+  for (uint8_t i = 0; i < sample.count; i++) {
+    const SensorReading& r = sample.readings[i];
+    readings.setFloat((TelemetryField)r.field, r.value);
+    // A field moved to another channel: the old channel no longer feeds it
+    for (uint8_t ch = 0; ch < ADC_MAX_CHANNELS; ch++) {
+      if (ch != r.channel && latest[ch].field == r.field) latest[ch].valid = false;
+    }
+    latest[r.channel].valid = true;
+    latest[r.channel].field = r.field;
+    latest[r.channel].raw = r.raw;
+  }
+
+  merged_count++;
+  if (sample.count) {
+    last_count = sample.count;
+    last_samples = sample.samples;
+    last_duration_us = sample.durationUs;
+  }
+}
+
+bool SensorProcessor::pass(TelemetryFrame& readings) {
+  // --- Temperature (the thermal task's latest conversion) ---
+  ThermocoupleStatus status = thermalLoop.status();
+  float temp = thermalLoop.temperature();
+  bool tempValid = status == THERMO_OK;
+  readings.set<TEL_TC_STATUS>((int32_t)status);
+  if (tempValid) {
+    readings.set<TEL_TEMP>(temp);
+    if (log) log->printf("Temperature: %.2f °C\n", temp);
+  } else {
+    readings.unset(TEL_TEMP);
+    if (log) log->printf("Thermocouple: %s\n", thermocoupleStatusName(status));
+  }
+
+  // --- Update telemetry ---
+  readings.set<TEL_FAN_STATE>(thermalLoop.fans().activeFans() != 0x00);
+
+  // --- Multiplexer Readings ---
+  if (log && merged_count) {
+    log->printf("ADC: %lu sweep(s) since the last pass, the last %u channels x %u samples in %lu us\n",
+                (unsigned long)merged_count, last_count, last_samples, (unsigned long)last_duration_us);
+  }
+  if (log) {
+    for (uint8_t ch = 0; ch < ADC_MAX_CHANNELS; ch++) {
+      if (!latest[ch].valid) continue;
+      log->printf("%s (Ch%u): %.2f (raw %.1f)\n", telemetryFields[latest[ch].field].key, ch,
+                  readings.getFloat((TelemetryField)latest[ch].field), adcCounts(latest[ch].raw));
+    }
+  }
+  merged_count = 0;
+
+  if (trace) writeTraceRow(temp);
+  return tempValid;
+}
+
+// "trace <ms> <temp> <counts of mux channel 0> <channel 1> ...", up to the
+// highest channel read; channels not read read 0
+void SensorProcessor::writeTraceRow(float temp) {
+  uint16_t counts[ADC_MAX_CHANNELS] = {};
+  uint8_t columns = 0;
+  for (uint8_t ch = 0; ch < ADC_MAX_CHANNELS; ch++) {
+    if (!latest[ch].valid) continue;
+    counts[ch] = (uint16_t)((latest[ch].raw + (1 << (ADC_VALUE_FRAC_BITS - 1))) >> ADC_VALUE_FRAC_BITS);
+    columns = ch + 1;
+  }
+
+  char line[128];
+  int n = snprintf(line, sizeof(line), "trace %lu %.2f", (unsigned long)millis(), temp);
+  for (uint8_t ch = 0; ch < columns; ch++) n += snprintf(line + n, sizeof(line) - n, " %u", counts[ch]);
+  trace->println(line);
+}
@@ -0,0 +1,72 @@
+#ifndef SENSOR_PROCESSOR_H
+#define SENSOR_PROCESSOR_H
+
+#include <Arduino.h>
+#include "AdcSampler.h"
+#include "ThermalLoop.h"
+#include "Telemetry.h"
+#include "SensorRegistry.h"
+
+// One sensor read by a sweep: its filtered counts and the decoded value
+struct SensorReading {
+  uint8_t channel;
+  uint8_t field;  // TelemetryField
+  uint16_t raw;   // filtered ADC counts in Q4 (see adcCounts())
+  float value;
+};
+
+// What one SensorMonitor::sample() swept. Plain data, so the acquisition
+// task can queue it for the processing task.
+struct SensorSample {
+  uint32_t sequence;
+  uint32_t startUs;
+  uint32_t durationUs;
+  uint32_t retiredFields; // fields of sensors removed since the last sample
+  uint16_t samples;       // conversions averaged per channel
+  uint8_t count;          // readings
+  uint8_t missing;        // channels the HAL failed to deliver for
+  SensorReading readings[SENSOR_MAX];
+};
+
+// The processing half of the sensor task: merges samples into a
+// TelemetryFrame as they arrive and, once per publish pass, adds the thermal
+// loop's latest temperature and fan state and prints the debug log and trace
+// rows. Keeps the latest raw reading per mux channel for those. Runs on any
+// task (only one), apart from the sampling.
+class SensorProcessor {
+public:
+  explicit SensorProcessor(ThermalLoop& thermal);
+
+  // Unsets the fields of retired sensors, then sets the sample's readings
+  void merge(const SensorSample& sample, TelemetryFrame& readings);
+
+  // A publish pass. TEL_TC_STATUS carries the thermocouple's status; TEL_TEMP
+  // is only set (and true returned) when that is THERMO_OK.
+  bool pass(TelemetryFrame& readings);
+
+  // Samples merged since the last pass
+  uint32_t merged() const { return merged_count; }
+
+  void setLog(Print* out) { log = out; }
+  void setTrace(Print* out) { trace = out; }
+
+private:
+  struct Latest {
+    bool valid;
+    uint8_t field;
+    uint16_t raw;
+  };
+
+  void writeTraceRow(float temp);
+
+  ThermalLoop& thermalLoop;
+  Latest latest[ADC_MAX_CHANNELS]; // by mux channel
+  uint32_t merged_count;
+  uint32_t last_duration_us;
+  uint16_t last_samples;
+  uint8_t last_count;
+  Print* log;
+  Print* trace;
+};
+
+#endif // SENSOR_PROCESSOR_H
@@ -0,0 +1,142 @@
+#include "SensorRegistry.h"
+#include <cstring>
+
+// -------- Decoders --------
+static float decodeCalibrated(const CalibrationTables& tables, uint8_t channel, uint16_t q4) {
+  return tables.convert(channel, q4) / (float)CAL_SCALE;
+}
+
+static float decodeRaw(const CalibrationTables&, uint8_t, uint16_t q4) {
+  return adcCounts(q4);
+}
+
+const SensorDecoder sensorDecoders[SENSOR_DECODER_COUNT] = {
+  {"voltage", decodeCalibrated, true, CAL_DEFAULT_VOLTAGE, SENSOR_FILTER_VOLTAGE},
+  {"current", decodeCalibrated, true, CAL_DEFAULT_CURRENT, SENSOR_FILTER_CURRENT},
+  {"pin_v", decodeCalibrated, true, CAL_LINEAR, SENSOR_FILTER_MEAN},
+  {"raw", decodeRaw, false, CAL_LINEAR, SENSOR_FILTER_MEAN},
+};
+
+// Over the ADC_DEFAULT_OVERSAMPLE (32) conversions each sweep takes per channel
+const SensorFilterPreset sensorFilters[SENSOR_FILTER_COUNT] = {
+  {"mean", {5, 1, FILTER_IIR_ONE}},
+  {"voltage", {5, 3, FILTER_ALPHA(0.5)}},
+  {"current", {3, 5, FILTER_ALPHA(0.25)}}, // ACS712s are noisy
+};
+
+ChannelCalibration sensorDefaultCurve(uint8_t decoder, uint8_t channel) {
+  CalibrationKind kind = decoder < SENSOR_DECODER_COUNT ? sensorDecoders[decoder].curve : CAL_LINEAR;
+  ChannelCalibration cal = makeCalibration(kind, channel);
+  if (decoder == SENSOR_DECODE_PIN_V) {
+    cal.useEfuse = 1;
+    cal.gain = 0.001f; // mV -> V
+  }
+  return cal;
+}
+
+static bool nameIs(const char* candidate, const char* name, size_t length) {
+  return strlen(candidate) == length && strncmp(candidate, name, length) == 0;
+}
+
+int sensorDecoderByName(const char* name, size_t length) {
+  for (int i = 0; i < SENSOR_DECODER_COUNT; i++) {
+    if (nameIs(sensorDecoders[i].name, name, length)) return i;
+  }
+  return -1;
+}
+
+int sensorFilterByName(const char* name, size_t length) {
+  for (int i = 0; i < SENSOR_FILTER_COUNT; i++) {
+    if (nameIs(sensorFilters[i].name, name, length)) return i;
+  }
+  return -1;
+}
+
+// -------- Registry --------
+SensorRegistry defaultSensorRegistry() {
+  static const SensorConfig board[] = {
+    {0, SENSOR_DECODE_VOLTAGE, TEL_B_V, SENSOR_FILTER_VOLTAGE, 1000, 0}, // battery voltage
+    {1, SENSOR_DECODE_CURRENT, TEL_B_C, SENSOR_FILTER_CURRENT, 1000, 0}, // battery current
+    {2, SENSOR_DECODE_VOLTAGE, TEL_T_V, SENSOR_FILTER_VOLTAGE, 1000, 0}, // teg voltage
+    {3, SENSOR_DECODE_CURRENT, TEL_T_C, SENSOR_FILTER_CURRENT, 1000, 0}, // teg current
+    {4, SENSOR_DECODE_VOLTAGE, TEL_C_V, SENSOR_FILTER_VOLTAGE, 1000, 0}, // charg voltage
+    {5, SENSOR_DECODE_CURRENT, TEL_C_C, SENSOR_FILTER_CURRENT, 1000, 0}, // charg current
+  };
+  SensorRegistry registry;
+  memset(&registry, 0, sizeof(registry));
+  registry.version = SENSOR_FORMAT_VERSION;
+  registry.count = sizeof(board) / sizeof(board[0]);
+  memcpy(registry.sensors, board, sizeof(board));
+  return registry;
+}
+
+bool validSensorRegistry(const SensorRegistry& registry) {
+  if (registry.version != SENSOR_FORMAT_VERSION || registry.count == 0 || registry.count > SENSOR_MAX) return false;
+  uint32_t channels = 0, fields = 0;
+  for (uint8_t i = 0; i < registry.count; i++) {
+    const SensorConfig& s = registry.sensors[i];
+    if (s.channel >= ADC_MAX_CHANNELS || s.decoder >= SENSOR_DECODER_COUNT || s.filter >= SENSOR_FILTER_COUNT) return false;
+    if (s.periodMs < SENSOR_MIN_PERIOD_MS || s.periodMs > SENSOR_MAX_PERIOD_MS || s.deadlineMs > s.periodMs) return false;
+    if (s.field >= TEL_FIELD_COUNT || telemetryFields[s.field].kind != TEL_KIND_FLOAT || s.field == TEL_TEMP) return false;
+    if ((channels >> s.channel) & 1u || (fields >> s.field) & 1u) return false;
+    channels |= 1u << s.channel;
+    fields |= 1u << s.field;
+  }
+  return true;
+}
+
+int findSensor(const SensorRegistry& registry, uint8_t channel) {
+  for (uint8_t i = 0; i < registry.count && i < SENSOR_MAX; i++) {
+    if (registry.sensors[i].channel == channel) return i;
+  }
+  return -1;
+}
+
+bool setSensor(SensorRegistry& registry, const SensorConfig& sensor) {
+  int i = findSensor(registry, sensor.channel);
+  if (i < 0) {
+    if (registry.count >= SENSOR_MAX) return false;
+    i = registry.count++;
+  }
+  registry.sensors[i] = sensor;
+  return true;
+}
+
+bool removeSensor(SensorRegistry& registry, uint8_t channel) {
+  int i = findSensor(registry, channel);
+  if (i < 0) return false;
+  registry.count--;
+  memmove(&registry.sensors[i], &registry.sensors[i + 1], (registry.count - i) * sizeof(SensorConfig));
+  memset(&registry.sensors[registry.count], 0, sizeof(SensorConfig));
+  return true;
+}
+
+// -------- Sweep order --------
+// Position of a channel in the Gray sequence 0, 1, 3, 2, 6, 7, 5, 4, 12, ...
+static uint8_t grayRank(uint8_t channel) {
+  uint8_t rank = channel;
+  for (uint8_t shift = 1; shift < 4; shift <<= 1) rank ^= rank >> shift;
+  return rank & 0x0F;
+}
+
+uint8_t sensorSweepOrder(const SensorRegistry& registry, uint8_t* order) {
+  uint8_t count = registry.count > SENSOR_MAX ? SENSOR_MAX : registry.count;
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t rank = grayRank(registry.sensors[i].channel);
+    uint8_t j = i;
+    while (j > 0 && grayRank(registry.sensors[order[j - 1]].channel) > rank) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = i;
+  }
+  return count;
+}
+
+uint8_t muxSelectToggles(const uint8_t* channels, uint8_t count) {
+  uint8_t toggles = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    toggles += __builtin_popcount((channels[i] ^ channels[(i + 1) % count]) & 0x0F);
+  }
+  return toggles;
+}
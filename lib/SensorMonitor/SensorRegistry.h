@@ -0,0 +1,102 @@
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include "AdcSampler.h"
+#include "Calibration.h"
+#include "Telemetry.h"
+
+#define SENSOR_MAX ADC_MAX_CHANNELS // one sensor per mux channel
+#define SENSOR_MIN_PERIOD_MS 10     // fastest: 100 Hz
+#define SENSOR_MAX_PERIOD_MS 60000  // slowest: once a minute
+#define SENSOR_FORMAT_VERSION 2     // bump when SensorRegistry changes layout
+
+// How a channel's filtered counts become a value (index into sensorDecoders)
+enum SensorDecoderId : uint8_t {
+  SENSOR_DECODE_VOLTAGE, // divider in front of the mux, V (sensorVoltage())
+  SENSOR_DECODE_CURRENT, // ACS712, A (sensorCurrent() with the channel's offset)
+  SENSOR_DECODE_PIN_V,   // volts at the mux input, eFuse-characterised
+  SENSOR_DECODE_RAW,     // filtered ADC counts
+  SENSOR_DECODER_COUNT
+};
+
+// Filter chain presets (index into sensorFilters)
+enum SensorFilterId : uint8_t {
+  SENSOR_FILTER_MEAN,    // mean of each sweep
+  SENSOR_FILTER_VOLTAGE, // mean, median of 3 sweeps
+  SENSOR_FILTER_CURRENT, // 4 means per sweep, median of 5, IIR
+  SENSOR_FILTER_COUNT
+};
+
+// Filtered ADC counts (Q4) -> engineering units
+typedef float (*SensorDecodeFn)(const CalibrationTables& tables, uint8_t channel, uint16_t q4);
+
+struct SensorDecoder {
+  const char* name;
+  SensorDecodeFn decode;
+  bool calibrated;       // converts through the channel's calibration table
+  CalibrationKind curve; // built-in curve of that table (see sensorDefaultCurve())
+  uint8_t filter;        // SensorFilterId a new sensor starts with
+};
+
+struct SensorFilterPreset {
+  const char* name;
+  ChannelFilterConfig config;
+};
+
+extern const SensorDecoder sensorDecoders[SENSOR_DECODER_COUNT];
+extern const SensorFilterPreset sensorFilters[SENSOR_FILTER_COUNT];
+
+// One mux channel and what becomes of it
+struct SensorConfig {
+  uint8_t channel; // mux channel, 0-15
+  uint8_t decoder; // SensorDecoderId
+  uint8_t field;   // TelemetryField it publishes (a float field)
+  uint8_t filter;  // SensorFilterId
+  uint16_t periodMs;   // read this often, SENSOR_MIN_PERIOD_MS..SENSOR_MAX_PERIOD_MS
+  uint16_t deadlineMs; // ...each read finished this long after its release; 0 = the period
+};
+
+// Plain data, stored in NVS as-is. Sensors are in the order they were added;
+// SensorMonitor sweeps the ones that are due in sensorSweepOrder().
+struct SensorRegistry {
+  uint8_t version;
+  uint8_t count;
+  SensorConfig sensors[SENSOR_MAX];
+};
+
+// The board's six sensors: battery, TEG and charger voltage/current on mux
+// channels 0-5, read once a second
+SensorRegistry defaultSensorRegistry();
+
+// At least one sensor; channels and fields unique, fields float, decoders,
+// filters, periods and deadlines (at most the period) in range
+bool validSensorRegistry(const SensorRegistry& registry);
+
+// Replaces the sensor on the same channel or appends it; false if full
+bool setSensor(SensorRegistry& registry, const SensorConfig& sensor);
+// False if nothing is on that channel
+bool removeSensor(SensorRegistry& registry, uint8_t channel);
+// Index of the sensor on a channel, -1 if none
+int findSensor(const SensorRegistry& registry, uint8_t channel);
+
+// Built-in calibration curve of a decoder on a channel
+ChannelCalibration sensorDefaultCurve(uint8_t decoder, uint8_t channel);
+
+// Decoder / filter preset by name, -1 if unknown
+int sensorDecoderByName(const char* name, size_t length);
+int sensorFilterByName(const char* name, size_t length);
+
+// Sweep order: registry indexes by the channels' position in the 4-bit Gray
+// sequence, so consecutive channels differ in as few select lines as the set
+// allows (one, when all 16 are in use). A multi-line switch makes the mux
+// pass through other channels on the way, and their charge is what the settle
+// conversions after each switch have to wash out. Returns the count.
+uint8_t sensorSweepOrder(const SensorRegistry& registry, uint8_t* order);
+
+// Select-line transitions over one sweep of channels in this order, including
+// the wrap back to the first
+uint8_t muxSelectToggles(const uint8_t* channels, uint8_t count);
+
+#endif // SENSOR_REGISTRY_H
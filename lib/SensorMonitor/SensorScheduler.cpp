@@ -0,0 +1,111 @@
+#include "SensorScheduler.h"
+#include <cstring>
+
+SensorScheduler::SensorScheduler() : count(0), started(false), cost_us(SCHEDULER_DEFAULT_COST_US) {
+  memset(release, 0, sizeof(release));
+  memset(period_us, 0, sizeof(period_us));
+  memset(deadline_us, 0, sizeof(deadline_us));
+  clearTimings();
+}
+
+void SensorScheduler::reset(const SensorConfig* slots, uint8_t n) {
+  count = n > SENSOR_MAX ? SENSOR_MAX : n;
+  for (uint8_t i = 0; i < count; i++) {
+    period_us[i] = slots[i].periodMs * 1000u;
+    deadline_us[i] = (slots[i].deadlineMs ? slots[i].deadlineMs : slots[i].periodMs) * 1000u;
+  }
+  started = false;
+  clearTimings();
+}
+
+void SensorScheduler::clearTimings() {
+  memset(timings, 0, sizeof(timings));
+}
+
+// Would sweeping the batch until endUs still let every other sensor make its
+// next deadline, run one by one in deadline order after it (or after its
+// release, if later)?
+bool SensorScheduler::othersMeetDeadlines(const uint8_t* order, uint16_t batch, uint32_t endUs) const {
+  uint32_t t = endUs;
+  for (uint8_t k = 0; k < count; k++) {
+    uint8_t i = order[k];
+    if ((batch >> i) & 1u) continue;
+    if ((int32_t)(release[i] - t) > 0) t = release[i];
+    t += cost_us;
+    if ((int32_t)(t - (release[i] + deadline_us[i])) > 0) return false;
+  }
+  return true;
+}
+
+uint16_t SensorScheduler::due(uint32_t nowUs) {
+  if (!started) {
+    for (uint8_t i = 0; i < count; i++) release[i] = nowUs;
+    started = true;
+  }
+
+  // Every sensor by its next absolute deadline
+  uint8_t order[SENSOR_MAX];
+  for (uint8_t i = 0; i < count; i++) {
+    uint32_t deadline = release[i] + deadline_us[i];
+    uint8_t j = i;
+    while (j > 0 && (int32_t)(release[order[j - 1]] + deadline_us[order[j - 1]] - deadline) > 0) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = i;
+  }
+
+  // The earliest released one always goes; the next ones while the batch
+  // ends before any deadline in it and leaves the others theirs
+  uint16_t batch = 0;
+  uint8_t size = 0;
+  uint32_t earliest = 0;
+  for (uint8_t k = 0; k < count; k++) {
+    uint8_t i = order[k];
+    if ((int32_t)(nowUs - release[i]) < 0) continue;
+    if (size == 0) {
+      earliest = release[i] + deadline_us[i];
+    } else {
+      uint32_t end = nowUs + (size + 1) * cost_us;
+      if ((int32_t)(end - earliest) > 0 || !othersMeetDeadlines(order, batch | (1u << i), end)) break;
+    }
+    batch |= 1u << i;
+    size++;
+  }
+  return batch;
+}
+
+void SensorScheduler::completed(uint16_t slots, uint32_t startUs, uint32_t endUs) {
+  uint8_t swept = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (!((slots >> i) & 1u)) continue;
+    swept++;
+    SensorTiming& t = timings[i];
+    uint32_t jitter = (int32_t)(startUs - release[i]) > 0 ? startUs - release[i] : 0;
+    t.runs++;
+    t.jitterSumUs += jitter;
+    if (jitter > t.jitterMaxUs) t.jitterMaxUs = jitter;
+    if ((int32_t)(endUs - (release[i] + deadline_us[i])) > 0) t.missed++;
+
+    // Releases that passed entirely while this one waited are missed, not queued
+    release[i] += period_us[i];
+    while ((int32_t)(endUs - release[i]) >= (int32_t)period_us[i]) {
+      release[i] += period_us[i];
+      t.missed++;
+    }
+  }
+  if (!swept) return;
+  int32_t measured = (int32_t)((endUs - startUs) / swept);
+  cost_us = (uint32_t)((int32_t)cost_us + (measured - (int32_t)cost_us) / 4);
+}
+
+uint32_t SensorScheduler::usUntilDue(uint32_t nowUs) const {
+  if (!started) return 0;
+  uint32_t wait = UINT32_MAX;
+  for (uint8_t i = 0; i < count; i++) {
+    int32_t until = (int32_t)(release[i] - nowUs);
+    if (until <= 0) return 0;
+    if ((uint32_t)until < wait) wait = until;
+  }
+  return wait;
+}
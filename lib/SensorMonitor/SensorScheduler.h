@@ -0,0 +1,58 @@
+#ifndef SENSOR_SCHEDULER_H
+#define SENSOR_SCHEDULER_H
+
+#include <cstdint>
+#include "SensorRegistry.h"
+
+#define SCHEDULER_DEFAULT_COST_US 1700 // one channel: settle, dropped DMA chunk, 32 conversions at 40 kHz
+
+// Timing of one sensor since the scheduler was reset
+struct SensorTiming {
+  uint32_t runs;
+  uint32_t missed;      // finished after the deadline, or not run at all before the next release
+  uint32_t jitterMaxUs; // sweep start - release
+  uint64_t jitterSumUs;
+};
+
+// Earliest-deadline-first release of sweep slots (SensorMonitor's, in sweep
+// order). Each sensor is released every periodMs and should be read within
+// deadlineMs of that. The ADC is one resource and a sweep is not preempted, so
+// what is due goes out as one batch, swept in Gray order (mux switches
+// packed). The batch is cut, in deadline order, where one more channel would
+// make a sensor in it late, or hold up a faster one released meanwhile past
+// its deadline; whatever is cut stays released for the next call. Times are
+// micros(), compared wrap-safe.
+class SensorScheduler {
+public:
+  SensorScheduler();
+
+  // New sensors: all released on the next due()
+  void reset(const SensorConfig* slots, uint8_t count);
+
+  // Slots to sweep now (bit per slot), 0 if none is released
+  uint16_t due(uint32_t nowUs);
+
+  // Those slots were swept from startUs to endUs: timings, next releases and
+  // the cost per channel the batches are sized with
+  void completed(uint16_t slots, uint32_t startUs, uint32_t endUs);
+
+  // Until the next release, 0 if one is pending
+  uint32_t usUntilDue(uint32_t nowUs) const;
+
+  const SensorTiming& timing(uint8_t slot) const { return timings[slot]; }
+  void clearTimings();
+  uint32_t channelCostUs() const { return cost_us; }
+
+private:
+  bool othersMeetDeadlines(const uint8_t* order, uint16_t batch, uint32_t endUs) const;
+
+  uint8_t count;
+  bool started;
+  uint32_t release[SENSOR_MAX];
+  uint32_t period_us[SENSOR_MAX];
+  uint32_t deadline_us[SENSOR_MAX]; // after the release
+  uint32_t cost_us;
+  SensorTiming timings[SENSOR_MAX];
+};
+
+#endif // SENSOR_SCHEDULER_H
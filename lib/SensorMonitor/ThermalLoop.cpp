@@ -0,0 +1,71 @@
+#include "ThermalLoop.h"
+#include <cmath>
+#include <cstring>
+
+static uint32_t floatBits(float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+
+ThermalLoop::ThermalLoop(ThermocoupleHal& thermocouple, FanHal& fans)
+  : thermocouple(thermocouple), fanControl(fans), log(nullptr), last_read_ms(0), started(false),
+    consecutive_faults(0), temp_bits(floatBits(NAN)), last_status(THERMO_NOT_READ), sample_ms(0), sample_count(0),
+    fault_count(0) {}
+
+void ThermalLoop::setLog(Print* out) {
+  log = out;
+  fanControl.setLog(out);
+}
+
+bool ThermalLoop::begin() {
+  bool ok = true;
+  if (!thermocouple.begin()) {
+    if (log) log->println("Thermocouple failed to start!");
+    ok = false;
+  }
+  // --- Initialize Fans Off ---
+  ok &= fanControl.begin();
+  started = false;
+  consecutive_faults = 0;
+  return ok;
+}
+
+uint32_t ThermalLoop::msUntilSample(uint32_t nowMs) const {
+  if (!started) return 0;
+  uint32_t elapsed = nowMs - last_read_ms;
+  return elapsed >= THERMO_CONVERSION_MS ? 0 : THERMO_CONVERSION_MS - elapsed;
+}
+
+float ThermalLoop::temperature() const {
+  uint32_t bits = temp_bits.load(std::memory_order_relaxed);
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+bool ThermalLoop::poll(uint32_t nowMs) {
+  if (msUntilSample(nowMs) > 0) return false;
+  started = true;
+  last_read_ms = nowMs; // the read starts the next conversion
+
+  float temp = NAN;
+  ThermocoupleStatus status = thermocouple.read(temp);
+  if (status != THERMO_OK) temp = NAN;
+  temp_bits.store(floatBits(temp), std::memory_order_relaxed);
+  last_status.store(status, std::memory_order_relaxed);
+  sample_ms.store(nowMs, std::memory_order_relaxed);
+  sample_count.store(sample_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+  if (status != THERMO_OK) {
+    fault_count.store(fault_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (consecutive_faults < THERMAL_FAULT_LIMIT && ++consecutive_faults == THERMAL_FAULT_LIMIT) {
+      if (log) log->printf("Thermocouple %s: fans to the top stage\n", thermocoupleStatusName(status));
+    }
+    if (consecutive_faults >= THERMAL_FAULT_LIMIT) fanControl.failSafe(nowMs);
+    return true;
+  }
+  consecutive_faults = 0;
+  fanControl.update(temp, nowMs);
+  return true;
+}
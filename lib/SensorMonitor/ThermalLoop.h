@@ -0,0 +1,62 @@
+#ifndef THERMAL_LOOP_H
+#define THERMAL_LOOP_H
+
+#include <atomic>
+#include <cstdint>
+#include "SensorHal.h"
+#include "FanControl.h"
+#include "Max6675.h"
+
+// Reading sooner than this after the previous read aborts the conversion in
+// progress and returns the previous result
+#define THERMO_CONVERSION_MS MAX6675_CONVERSION_MS
+// Consecutive failed reads before the fans go to the top stage
+#define THERMAL_FAULT_LIMIT 3
+
+// The thermal control loop: one thermocouple read per completed conversion,
+// straight into the fan stages. Runs on its own task (Sensors.cpp) so an
+// over-temperature is acted on within one conversion, independently of the
+// sensor task's sweep and publish cadence. The latest temperature is shared
+// with other tasks through temperature().
+class ThermalLoop {
+public:
+  ThermalLoop(ThermocoupleHal& thermocouple, FanHal& fans);
+
+  // Thermocouple and fans (off)
+  bool begin();
+
+  // Reads the thermocouple if a conversion has completed since the last read
+  // and stages the fans on it. True if a new sample was taken.
+  bool poll(uint32_t nowMs);
+
+  // Until the next conversion completes (0 = poll now)
+  uint32_t msUntilSample(uint32_t nowMs) const;
+
+  // Latest reading and its status; the temperature is NAN unless the status
+  // is THERMO_OK. Any task.
+  float temperature() const;
+  ThermocoupleStatus status() const { return (ThermocoupleStatus)last_status.load(std::memory_order_relaxed); }
+  uint32_t sampleMs() const { return sample_ms.load(std::memory_order_relaxed); }
+  uint32_t samples() const { return sample_count.load(std::memory_order_relaxed); }
+  uint32_t faults() const { return fault_count.load(std::memory_order_relaxed); }
+
+  FanControl& fans() { return fanControl; }
+
+  // Faults and fan transitions are reported here when set
+  void setLog(Print* out);
+
+private:
+  ThermocoupleHal& thermocouple;
+  FanControl fanControl;
+  Print* log;
+  uint32_t last_read_ms;
+  bool started;
+  uint8_t consecutive_faults;
+  std::atomic<uint32_t> temp_bits;
+  std::atomic<uint8_t> last_status;
+  std::atomic<uint32_t> sample_ms;
+  std::atomic<uint32_t> sample_count;
+  std::atomic<uint32_t> fault_count;
+};
+
+#endif // THERMAL_LOOP_H
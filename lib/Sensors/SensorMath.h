@@ -0,0 +1,53 @@
+#ifndef SENSOR_MATH_H
+#define SENSOR_MATH_H
+
+#include <cmath>
+
+// Raw ADC -> engineering units. Kept free of Arduino/ESP-IDF so the native
+// environment can build and benchmark it.
+
+#define ADC_RESOLUTION 4095.0
+
+#define CURRENT_SENSOR_SENSITIVITY 0.066 // For ACS712 30A version (66mV/A)
+
+#define R1 52000.0 // 52k ohm, added 22k to 30k on volatage sensor 25v > 3.15v
+#define R2 7500.0  // 7.5k ohm
+
+// round floaat to 2 decimal places
+inline float roundFloat(float value, int places) {
+  float factor = powf(10.0f, places);
+  value = roundf(value * factor) / factor;
+  return value;
+}
+
+// Voltage at the divider output (the ADC pin)
+inline float dividerVout(float adcValue) {
+  return (adcValue * 3.15) / 3909;
+}
+
+// System voltage on the divider input; readings under 5 V are treated as 0
+inline float sensorVoltage(float adcValue) {
+  float vin = (dividerVout(adcValue) + 0.18) / (R2 / (R1 + R2));
+  // float vin = vout * (25.0 / 3.15);
+  // vin = (vin / 4.95) * 24.75;
+  return vin >= 5 ? roundFloat(vin, 2) : 0;
+}
+
+// ACS712 zero-current output per mux channel (measured)
+inline float currentSensorOffset(int channel) {
+  return channel == 1 ? 0.39 : channel == 3 ? 0.14 : 0.24; // Different sensors can have different offsets
+}
+
+inline float currentSensorVoltage(float adcValue) {
+  return (adcValue / ADC_RESOLUTION) * 3.3;
+}
+
+// Current in A, clamped at 0 for readings at or below the sensor offset
+inline float sensorCurrent(float adcValue, int channel) {
+  float voltage = currentSensorVoltage(adcValue);
+  float offset_voltage = currentSensorOffset(channel);
+  float current = ((voltage < offset_voltage ? offset_voltage : voltage) - offset_voltage) / (CURRENT_SENSOR_SENSITIVITY);
+  return current < 0.001 ? 0 : (roundFloat(current, 2)); // Clamp negative currents to 0
+}
+
+#endif // SENSOR_MATH_H
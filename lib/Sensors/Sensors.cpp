@@ -1,15 +1,24 @@
 #include "Sensors.h"
+#include "Esp32AdcHal.h"
+#include "Esp32SensorHal.h"
+#include "CalibrationStore.h"
+#include "EnergyStore.h"
+#include "BurstWatcher.h"
+#include "SpscQueue.h"
+#include "Profiler.h"
+#include <Preferences.h>
 
 // -------- Pin definitions --------
 #define MAX_CS_PIN 5
 #define MAX_SCK_PIN 18
 #define MAX_MISO_PIN 19
 
-#define DEBUG 1
+#define DEBUG 0
 
 #define SHIFT_DATA_PIN 23
 #define SHIFT_CLOCK_PIN 22
 #define SHIFT_LATCH_PIN 21
+#define SHIFT_REGISTERS 1
 
 #define MUX_S0 4
 #define MUX_S1 0
@@ -17,256 +26,518 @@
 #define MUX_S3 15
 #define MUX_SIG 35
 
-// ADC and Voltage/Current Sensor Constants
-#define ADC_RESOLUTION 4095.0
+// ADC and Voltage/Current Sensor Constants (conversion constants are in SensorMath.h)
 #define ADC_REF_VOLTAGE 3.9 // Full-scale voltage for ADC with 11dB attenuation
 
 // This is the system voltage that corresponds to the ADC's max input voltage (ADC_REF_VOLTAGE)
 // after passing through a voltage divider. (e.g. 16.8V -> 3.9V)
 #define VOLTAGE_DIVIDER_MAX_IN 16.8 
 #define VOLTAGE_SCALING_FACTOR (VOLTAGE_DIVIDER_MAX_IN / ADC_REF_VOLTAGE)
-#define CURRENT_SENSOR_SENSITIVITY 0.066 // For ACS712 30A version (66mV/A)
 // #define CURRENT_SENSOR_OFFSET (ADC_REF_VOLTAGE / 2) // ACS712 is a 5V sensor, so its 0A offset is 2.5V
 #define CURRENT_SENSOR_OFFSET 2.5  // ACS712 outputs 2.5V at 0A when powered by 5V
 #define VOLTAGE_MAP (v) ((v / ADC_REF_VOLTAGE) * 25)
 
-#define R1 52000.0 // 52k ohm, added 22k to 30k on volatage sensor 25v > 3.15v
-#define R2 7500.0  // 7.5k ohm
+// The thermal loop preempts acquisition (monitorSensorsTask, 2), which
+// preempts processing (1) on core 1; aggregation has core 0 with connectivity
+#define THERMAL_TASK_PRIORITY 3
+#define THERMAL_TASK_STACK 2048
+#define PROCESS_TASK_PRIORITY 1
+#define PROCESS_TASK_STACK 3072
+#define AGGREGATE_TASK_PRIORITY 1
+#define AGGREGATE_TASK_STACK 2560
+#define SAMPLE_QUEUE_DEPTH 16 // acquisition -> processing: 160 ms of 100 Hz sweeps
+#define PASS_QUEUE_DEPTH 4    // processing -> aggregation: publish passes
+#define FAN_NAMESPACE "fans"
+#define SENSOR_NAMESPACE "sensors"
+#define BURST_NAMESPACE "burst"
+
+// Each sensor is read at its own period (SensorRegistry); temperature, energy,
+// history and the debug log go out on this one
+#define SENSOR_PUBLISH_MS 1000
+#define SENSOR_TIMING_REPORT_MS 60000 // DEBUG: per-sensor jitter, missed deadlines, queue counters
+
+// Set to 1 to log a replayable "trace ..." line per reading (see ReplaySensorHal.h)
+#define SENSOR_TRACE 0
 
-// #define NUM_SENSORS
-#define NUM_FANS 4
-
-#define HIGH_TEMP_1     90.0   // Stage 1: Fans 0 & 1
-#define HIGH_TEMP_2     90.0   // Stage 2: All fans
-#define FAN1_OFF_TEMP    70.0   // Fans 0 & 1 turn OFF below this
-#define HYSTERESIS        5   // Hysteresis for downward transitions
-
-#define FAN_MASK(x) (x & ((1 << NUM_FANS) - 1))
+// -------- Global Objects --------
+// SPI buses. The 595's clock is wired to GPIO 22, not the MAX6675's SCK (18),
+// so it sits on HSPI; with the clock moved to 18 both devices can share vspi
+// (the MAX6675 ignores MOSI) by handing it to the chain below.
+static SpiBus vspi(VSPI_HOST, MAX_SCK_PIN, -1, MAX_MISO_PIN, false);
+static SpiBus hspi(HSPI_HOST, SHIFT_CLOCK_PIN, SHIFT_DATA_PIN, -1, true);
+
+static Max6675Thermocouple thermocouple(vspi, MAX_CS_PIN);
+// Latch on the chain's chip select; more registers daisy-chained on Q7' add
+// outputs above the fans (raise SHIFT_REGISTERS)
+static ShiftRegisterChain shiftRegisters(hspi, SHIFT_LATCH_PIN, SHIFT_REGISTERS);
+static ShiftRegisterFans fanRegister(shiftRegisters, 0, NUM_FANS);
+
+// Mux channels are swept back-to-back over ADC DMA, in the registry's sweep order
+static Esp32AdcHal adcHal(MUX_SIG, MUX_S0, MUX_S1, MUX_S2, MUX_S3);
+
+// Built-in sensors (SensorRegistry.cpp) until setupSensors() loads the NVS copy
+static const SensorHal boardHal = { adcHal, thermocouple, fanRegister };
+SensorMonitor sensorMonitor(boardHal, defaultSensorRegistry());
+static TaskHandle_t thermalHandle = NULL;
+static TaskHandle_t processHandle = NULL;
+static TaskHandle_t aggregateHandle = NULL;
+
+// One publish pass on its way to aggregation
+struct SensorPass {
+  uint32_t ms;
+  TelemetryFrame readings;
+};
 
-SensorConfig sensorMap[] = {
-  {0, SENSOR_VOLTAGE, "b_v"}, // battery voltage
-  {1, SENSOR_CURRENT, "b_c"}, // battery current
-  {2, SENSOR_VOLTAGE, "t_v"}, // teg voltage
-  {3, SENSOR_CURRENT, "t_c"}, // teg current
-  {4, SENSOR_VOLTAGE, "c_v"}, // charg voltage
-  {5, SENSOR_CURRENT, "c_c"}, // charg current
-  // Add more sensors here
+// The pipeline: acquisition sweeps and decodes, processing merges and
+// publishes, aggregation keeps the history. Each queue has one producer and
+// one consumer; a full one drops (and counts) rather than stall the stage
+// before it.
+static SpscQueue<SensorSample, SAMPLE_QUEUE_DEPTH> sampleQueue;
+static SpscQueue<SensorPass, PASS_QUEUE_DEPTH> passQueue;
+
+// Each stage's work between waits (its busy time, see Profiler.h) and the
+// publish pass within processing
+PROFILE_SPAN(thermalSpan, "sensors.thermal");
+PROFILE_SPAN(acquireSpan, "sensors.acquire");
+PROFILE_SPAN(processSpan, "sensors.process");
+PROFILE_SPAN(passSpan, "sensors.pass");
+PROFILE_SPAN(aggregateSpan, "sensors.aggregate");
+
+// Between sweeps the sensor task watches the armed channels at the full ADC
+// rate instead of sleeping (BurstWatcher.h)
+BurstCapture burstCapture;
+static BurstWatcher burstWatcher(adcHal, burstCapture);
+
+// Set by the calibration commands; acquisition rebuilds its tables
+static volatile bool calibration_reload = false;
+
+// Points captured by the "cal" command, per mux channel (command task only)
+static CalibrationPoint calibration_points[CAL_MAX_CHANNELS][CAL_MAX_POINTS];
+static uint8_t calibration_point_count[CAL_MAX_CHANNELS];
+
+// Wh / coulomb counters over every reading, saved to NVS on their own schedule
+static EnergyMeter energyMeter;
+static uint32_t energy_save_attempt_ms;
+
+// "energy" command -> processing task; NAN leaves a setting alone
+struct EnergyRequest {
+  bool reset;
+  float soc;
+  float capacityAh;
 };
+static Seqlock<EnergyRequest> energyRequests;
+static uint32_t energy_requests_applied;
+
+// Written only by the processing task; published whole through sensorSnapshot
+static TelemetryFrame readings;
+Seqlock<TelemetryFrame> sensorSnapshot;
+
+// Temperature and the built-in sensors, fed once per reading. The fields are
+// fixed when the rollups are allocated; sensors added at runtime publish but
+// are not kept here.
+static uint32_t historyFields() {
+  SensorRegistry registry = defaultSensorRegistry();
+  uint32_t fields = 1u << TEL_TEMP;
+  for (uint8_t i = 0; i < registry.count; i++) fields |= 1u << registry.sensors[i].field;
+  return fields;
+}
+TelemetryHistory sensorHistory(historyFields());
 
-const int NUM_SENSORS = sizeof(sensorMap) / sizeof(sensorMap[0]);
+// -------- Helper Functions --------
+// Built-in curves, overridden by whatever is stored in NVS
+static uint8_t loadStoredCalibration() {
+  sensorMonitor.resetCalibration();
+  return loadCalibration(sensorMonitor.calibration(), sensorMonitor.calibratedChannels(),
+                         sensorMonitor.calibratedCount());
+}
 
+static void reportCalibration(uint8_t stored) {
+  CalibrationTables& tables = sensorMonitor.calibration();
+  if (DEBUG) {
+    Serial.printf("Calibration: %u stored curve(s), %u table(s), %u bytes\n",
+                  stored, (unsigned)tables.tableCount(), (unsigned)tables.tableBytes());
+  }
+}
 
-// -------- Global Objects --------
-MAX6675 thermocouple(MAX_SCK_PIN, MAX_CS_PIN, MAX_MISO_PIN);
+void setFanOverride(int mask) {
+  sensorMonitor.fans().setOverride(mask);
+}
 
-SimpleJson data;
+// -------- Fan staging --------
+// Built-in stages (FanControl.h), overridden by the NVS copy if there is one
+static void loadFanConfig() {
+  Preferences prefs;
+  if (!prefs.begin(FAN_NAMESPACE, true)) return; // nothing stored yet
+  FanControlConfig config;
+  if (prefs.getBytesLength("config") == sizeof(config)) {
+    prefs.getBytes("config", &config, sizeof(config));
+    if (!sensorMonitor.fans().setConfig(config) && DEBUG) Serial.println("Stored fan config ignored");
+  }
+  prefs.end();
+}
 
-byte active_fans = 0x00;
+bool configureFans(const FanControlConfig& config) {
+  if (!sensorMonitor.fans().setConfig(config)) return false;
+  Preferences prefs;
+  if (!prefs.begin(FAN_NAMESPACE, false)) return false;
+  bool ok = prefs.putBytes("config", &config, sizeof(config)) == sizeof(config);
+  prefs.end();
+  return ok;
+}
 
-// Fan bitmasks
-const byte STAGE_1_FANS = (1 << 0) | (1 << 2);  // Fans 0,1
-const byte STAGE_2_FANS = (1 << 1) | (1 << 3);  // Fans 2,3
-const byte ALL_FANS     = STAGE_1_FANS | STAGE_2_FANS;
+FanControlConfig fanConfig() {
+  return sensorMonitor.fans().config();
+}
 
-// === Persistent state for hysteresis ===
-static int   current_state = 0;  // 0=off, 1=stage1, 2=stage2
-static float state_entry_temp = 0.0;  // temp when we entered this state
+// -------- Sensor registry --------
+// Built-in sensors, replaced by the NVS copy if there is one
+static void loadSensorRegistry() {
+  Preferences prefs;
+  if (!prefs.begin(SENSOR_NAMESPACE, true)) return; // nothing stored yet
+  SensorRegistry registry;
+  if (prefs.getBytesLength("registry") == sizeof(registry)) {
+    prefs.getBytes("registry", &registry, sizeof(registry));
+    if (!sensorMonitor.setRegistry(registry) && DEBUG) Serial.println("Stored sensor registry ignored");
+  }
+  prefs.end();
+}
 
-byte desired_fans = active_fans;
-int  desired_state = current_state;
-bool should_update = false;
+bool configureSensors(const SensorRegistry& registry) {
+  if (!sensorMonitor.setRegistry(registry)) return false;
+  Preferences prefs;
+  if (!prefs.begin(SENSOR_NAMESPACE, false)) return false;
+  bool ok = prefs.putBytes("registry", &registry, sizeof(registry)) == sizeof(registry);
+  prefs.end();
+  return ok;
+}
 
-// -------- Helper Functions --------
-static void selectMuxChannel(int channel) {
-  digitalWrite(MUX_S0, (channel & 0x01));
-  digitalWrite(MUX_S1, (channel & 0x02));
-  digitalWrite(MUX_S2, (channel & 0x04));
-  digitalWrite(MUX_S3, (channel & 0x08));
+SensorRegistry sensorRegistry() {
+  return sensorMonitor.registry();
 }
 
-inline void customShiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t value){
-  for(int8_t i = 7; i >= 0; --i){
-    digitalWrite(dataPin, (value >> 1) & 1);
-    digitalWrite(clockPin, HIGH);
-    digitalWrite(clockPin, LOW);
+// -------- Burst capture --------
+// Built-in rules, replaced by the NVS copy if there is one
+static void loadBurstConfig() {
+  Preferences prefs;
+  if (!prefs.begin(BURST_NAMESPACE, true)) return; // nothing stored yet
+  BurstConfig config;
+  if (prefs.getBytesLength("config") == sizeof(config)) {
+    prefs.getBytes("config", &config, sizeof(config));
+    if (!burstCapture.setConfig(config) && DEBUG) Serial.println("Stored burst rules ignored");
   }
+  prefs.end();
 }
 
-static void setFanState(uint8_t mask) {
-  shiftOut(SHIFT_DATA_PIN, SHIFT_CLOCK_PIN, MSBFIRST, mask);
-  // customShiftOut(SHIFT_DATA_PIN, SHIFT_CLOCK_PIN, mask);
-  digitalWrite(SHIFT_LATCH_PIN, LOW);
-  digitalWrite(SHIFT_LATCH_PIN, HIGH);
+bool configureBurst(const BurstConfig& config) {
+  if (!burstCapture.setConfig(config)) return false;
+  Preferences prefs;
+  if (!prefs.begin(BURST_NAMESPACE, false)) return false;
+  bool ok = prefs.putBytes("config", &config, sizeof(config)) == sizeof(config);
+  prefs.end();
+  return ok;
 }
 
-// round floaat to 2 decimal places
-static float round_float(float value, int places) {
-  float factor = powf(10.0f, places);
-  value = roundf(value * factor) / factor;
-  return value;
+BurstConfig burstConfig() {
+  return burstCapture.config();
 }
 
-static float getVoltage(float adcValue) {
-  float vout = (adcValue * 3.15) / 3909;
-  float vin = (vout + 0.18) / (R2 / (R1 + R2));
-  // float vin = vout * (25.0 / 3.15);
-  // vin = (vin / 4.95) * 24.75;
-  if (DEBUG) Serial.printf("Raw ADC: %.0f, Vout: %.2f V, Vin: %.2f V\n", adcValue, vout, vin);
-  return vin >= 5 ? round_float(vin, 2) : 0;
+// -------- Energy --------
+bool configureEnergy(bool reset, float socPercent, float capacityAh) {
+  if (!std::isnan(socPercent) && !(socPercent >= 0 && socPercent <= 100)) return false;
+  if (!std::isnan(capacityAh) && !(capacityAh > 0 && capacityAh <= 1000)) return false;
+  EnergyRequest request = { reset, socPercent, capacityAh };
+  energyRequests.write(request);
+  return true;
 }
 
-static float getCurrent(float adcValue, int channel) {
-  float voltage = (adcValue / ADC_RESOLUTION) * 3.3;
-  // voltage = (voltage / 5.0) * 3.3;
-  float offset_voltage = (3.3 / 2); // ACS712 outputs 2.5V at 0A when powered by 5V
-  offset_voltage = channel == 1 ? 0.39 : channel == 3 ? 0.14 : 0.24; // Different sensors can have different offsets
-  float current = ((voltage < offset_voltage ? offset_voltage : voltage) - offset_voltage) / (CURRENT_SENSOR_SENSITIVITY);
-  if (DEBUG) Serial.printf("Raw ADC: %.0f, Voltage: %.2f V, Current: %.2f A\n", adcValue, voltage, current);
-  return current < 0.001 ? 0 : (round_float(current, 2)); // Clamp negative currents to 0
+static void applyEnergyRequest() {
+  uint32_t version = energyRequests.version();
+  EnergyRequest request;
+  if (version == energy_requests_applied || !energyRequests.read(request)) return;
+  energy_requests_applied = version;
+  if (request.reset) energyMeter.reset();
+  if (!std::isnan(request.capacityAh)) energyMeter.setCapacity(request.capacityAh);
+  if (!std::isnan(request.soc)) energyMeter.setSoc(request.soc);
 }
 
-// -------- Setup --------
-void setupSensors() {
-  if (DEBUG) {
-    // Serial.println();
-    Serial.println("ESP32 Temperature Control and Sensor Reading Started");
+// Integrates the readings as of a merged sample, at the middle of its sweep:
+// the currents are read at up to 100 Hz, and sampling them once per pass
+// would alias. The sample's age moves its micros() onto the millis() clock.
+static void integrateEnergy(const SensorSample& sample) {
+  uint32_t age_ms = (micros() - (sample.startUs + sample.durationUs / 2)) / 1000;
+  energyMeter.update(readings, millis() - age_ms);
+}
+
+// Adds the counters to this pass's readings. A failed NVS write is retried no
+// sooner than the save schedule's minimum interval.
+static void accountEnergy(TelemetryFrame& frame) {
+  uint32_t now = millis();
+  applyEnergyRequest();
+  energyMeter.publish(frame);
+
+  if (!energyMeter.saveDue(now) || (energy_save_attempt_ms && now - energy_save_attempt_ms < ENERGY_SAVE_MIN_MS)) return;
+  EnergyCounters counters = energyMeter.checkpoint();
+  if (saveEnergy(counters)) {
+    energyMeter.markSaved(counters, now);
+    energy_save_attempt_ms = 0;
+  } else {
+    energy_save_attempt_ms = now | 1;
+    if (DEBUG) Serial.println("Energy counters: NVS write failed");
   }
+}
 
-  // --- Shift Register Pins ---
-  pinMode(SHIFT_DATA_PIN, OUTPUT);
-  pinMode(SHIFT_CLOCK_PIN, OUTPUT);
-  pinMode(SHIFT_LATCH_PIN, OUTPUT);
+// -------- Calibration commands --------
+int captureCalibrationPoint(uint8_t channel, float value) {
+  // The slot is looked up in the frame itself: the registry may change under us
+  AdcFrame frame;
+  if (channel >= CAL_MAX_CHANNELS || !sensorMonitor.sampler().latest(frame)) return -1;
+  int slot = -1;
+  for (uint8_t i = 0; i < frame.count && slot < 0; i++) {
+    if (frame.channels[i] == channel) slot = i;
+  }
+  if (slot < 0) return -1;
+
+  uint8_t& count = calibration_point_count[channel];
+  if (count >= CAL_MAX_POINTS) return -1;
+  CalibrationPoint& p = calibration_points[channel][count++];
+  p.x = adcCounts(frame.value[slot]);
+  p.value = value;
+  if (DEBUG) Serial.printf("Calibration ch%u: point %u = %.1f counts -> %.3f\n", channel, count, p.x, value);
+  return count;
+}
 
-  // --- Multiplexer Pins ---
-  pinMode(MUX_S0, OUTPUT);
-  pinMode(MUX_S1, OUTPUT);
-  pinMode(MUX_S2, OUTPUT);
-  pinMode(MUX_S3, OUTPUT);
-  pinMode(MUX_SIG, INPUT);
+bool fitChannelCalibration(uint8_t channel, bool piecewise, bool useEfuse, float zeroBelow) {
+  if (channel >= CAL_MAX_CHANNELS) return false;
 
-  // --- ADC Configuration ---
-  analogReadResolution(12);          // 12-bit ADC (0–4095)
-  analogSetAttenuation(ADC_11db);    // Full range (0–3.9V)
+  ChannelCalibration cal = makeCalibration(CAL_LINEAR, channel);
+  cal.zeroBelow = zeroBelow;
+  if (!fitCalibration(calibration_points[channel], calibration_point_count[channel], piecewise, useEfuse,
+                      useEfuse ? efuseMillivolts : nullptr, cal)) {
+    return false;
+  }
+  if (!saveCalibration(channel, cal)) return false;
+  if (DEBUG && !piecewise) Serial.printf("Calibration ch%u: gain %.6f offset %.4f\n", channel, cal.gain, cal.offset);
 
-  // --- Initialize Fans Off ---
-  setFanState(0x00);
+  calibration_point_count[channel] = 0;
+  calibration_reload = true;
+  return true;
 }
 
-// -------- Sensor Reading --------
-void monitorSensors() {
-  // doc.clear();
-  // --- Temperature ---
-  float temp = thermocouple.readCelsius();
-  vTaskDelay(10 / portTICK_PERIOD_MS);
-  if (isnan(temp)) {
-    if (DEBUG) Serial.println("Error reading temperature!");
-    return;
+bool resetChannelCalibration(uint8_t channel) {
+  if (channel >= CAL_MAX_CHANNELS || !eraseCalibration(channel)) return false;
+  calibration_point_count[channel] = 0;
+  calibration_reload = true;
+  return true;
+}
+
+// -------- Setup --------
+void setupSensors() {
+  if (DEBUG) {
+    // Serial.println();
+    Serial.println("ESP32 Temperature Control and Sensor Reading Started");
   }
 
-  data.set("temp", temp);
-  if (DEBUG) Serial.printf("Temperature: %.2f °C\n", temp);
+  sensorMonitor.setLog(DEBUG ? &Serial : nullptr);
+  sensorMonitor.setTrace(SENSOR_TRACE ? &Serial : nullptr);
+
+  // Sensors from NVS, then raw ADC -> V/A tables with their stored curves
+  // (built by begin())
+  loadSensorRegistry();
+  sensorMonitor.applyRegistry();
+  sensorMonitor.calibration().setMillivoltsConverter(efuseMillivolts);
+  uint8_t stored = loadStoredCalibration();
+
+  // Counters carry on from the newest stored slot
+  EnergyCounters stored_energy;
+  if (loadEnergy(stored_energy)) {
+    energyMeter.restore(stored_energy, millis());
+    if (DEBUG) Serial.printf("Energy counters restored (save #%lu)\n", (unsigned long)stored_energy.sequence);
+  }
 
-  // === 1. Determine desired state based on temperature ===
-  if (temp >= HIGH_TEMP_1) {
-      desired_state = 2;
-      desired_fans = ALL_FANS;
-      should_update = true;
+  // Multiplexer + ADC, thermocouple, fans off
+  loadFanConfig();
+  loadBurstConfig();
+  if (!sensorMonitor.begin()) {
+    Serial.println("Sensor setup incomplete!");
   }
-  else if (temp >= HIGH_TEMP_1 || (temp >= FAN1_OFF_TEMP && desired_state != 0)) {
-      desired_state = 1;
-      desired_fans = ALL_FANS;
-      should_update = true;
+  reportCalibration(stored);
+
+  // Fans follow the thermocouple from here on, at its conversion rate
+  if (thermalHandle == NULL) {
+    xTaskCreatePinnedToCore(monitorThermalTask, "MonitorThermal", THERMAL_TASK_STACK, NULL,
+                            THERMAL_TASK_PRIORITY, &thermalHandle, 1);
   }
-  else {
-      desired_state = 0;
-      desired_fans = 0x00;
-      should_update = true;
+  // The stages after acquisition (this task)
+  if (processHandle == NULL) {
+    xTaskCreatePinnedToCore(monitorProcessTask, "MonitorProcess", PROCESS_TASK_STACK, NULL,
+                            PROCESS_TASK_PRIORITY, &processHandle, 1);
   }
-
-  if (desired_state != current_state) {
-    // --- Apply to physical fans ---
-      setFanState(FAN_MASK(desired_fans));
-      // setFanState(desired_fans);
-      active_fans = desired_fans;
-      // --- Debug ---
-      if (DEBUG) {
-          if (active_fans == ALL_FANS)
-              Serial.println("All Fans ON - Critical Temp");
-          else if (active_fans == STAGE_1_FANS)
-              Serial.println("Stage 1 Fans ON (0,1)");
-          else
-              Serial.println("All Fans OFF");
-      }
-      current_state = desired_state;
+  if (aggregateHandle == NULL) {
+    xTaskCreatePinnedToCore(monitorAggregateTask, "MonitorAggregate", AGGREGATE_TASK_STACK, NULL,
+                            AGGREGATE_TASK_PRIORITY, &aggregateHandle, 0);
   }
+  if (DEBUG) sensorHistory.printBudget(Serial);
+}
 
-  // --- Update telemetry ---
-  data.set("fan_state", (active_fans != 0x00));
-
-  // --- Multiplexer Readings ---
- 
- for (int i = 0; i < NUM_SENSORS; i++) {
-  int channel = sensorMap[i].channel;
-  selectMuxChannel(channel);
-  vTaskDelay(10 / portTICK_PERIOD_MS);
-
-  int adcValue = analogRead(MUX_SIG);
-  vTaskDelay(10 / portTICK_PERIOD_MS);
-  // Serial.println(adcValue); 
-  // This is the actual voltage at the MUX_SIG pin
-  // float muxVoltage = (adcValue / ADC_RESOLUTION) * ADC_REF_VOLTAGE;
-  // if (DEBUG) Serial.printf("Channel %d: %.2f V\n", channel, muxVoltage);
-
-  float reading = 0.0;
-
-  switch (sensorMap[i].type) {
-    case SENSOR_VOLTAGE: {
-      // Scale the mux voltage back up to the original system voltage
-      // This assumes a voltage divider that maps 0-16.8V to 0-3.9V
-      reading = getVoltage(adcValue);
-      break;
-    }
+// -------- Sensor Reading --------
+// Runs, missed deadlines and release-to-sweep jitter per sensor over the last
+// report period
+static void reportSensorTiming() {
+  static uint32_t reported_ms;
+  uint32_t now = millis();
+  if (now - reported_ms < SENSOR_TIMING_REPORT_MS) return;
+  reported_ms = now;
+  SensorScheduler& schedule = sensorMonitor.schedule();
+  for (uint8_t i = 0; i < sensorMonitor.sensorCount(); i++) {
+    const SensorConfig& sensor = sensorMonitor.sensor(i);
+    const SensorTiming& t = schedule.timing(i);
+    Serial.printf("Schedule %s (Ch%u) every %u ms: %lu runs, %lu missed, jitter mean %lu us max %lu us\n",
+                  telemetryFields[sensor.field].key, sensor.channel, sensor.periodMs, (unsigned long)t.runs,
+                  (unsigned long)t.missed, (unsigned long)(t.runs ? t.jitterSumUs / t.runs : 0),
+                  (unsigned long)t.jitterMaxUs);
+  }
+  schedule.clearTimings();
+}
 
-    case SENSOR_CURRENT: {
-      // The ACS712 output is directly read by the ADC, so use muxVoltage
-      reading = getCurrent(adcValue, channel);
-      break;
-    }
+// Items through each queue, dropped because it was full and the deepest it
+// has been, over the last report period
+static void reportPipeline() {
+  static uint32_t reported_ms;
+  static uint32_t samples_pushed, samples_dropped, passes_pushed, passes_dropped;
+  uint32_t now = millis();
+  if (now - reported_ms < SENSOR_TIMING_REPORT_MS) return;
+  reported_ms = now;
+  Serial.printf("Pipeline: samples %lu queued, %lu dropped, peak %lu/%u; passes %lu queued, %lu dropped, peak %lu/%u\n",
+                (unsigned long)(sampleQueue.pushed() - samples_pushed),
+                (unsigned long)(sampleQueue.dropped() - samples_dropped), (unsigned long)sampleQueue.highWater(),
+                SAMPLE_QUEUE_DEPTH, (unsigned long)(passQueue.pushed() - passes_pushed),
+                (unsigned long)(passQueue.dropped() - passes_dropped), (unsigned long)passQueue.highWater(),
+                PASS_QUEUE_DEPTH);
+  samples_pushed = sampleQueue.pushed();
+  samples_dropped = sampleQueue.dropped();
+  passes_pushed = passQueue.pushed();
+  passes_dropped = passQueue.dropped();
+}
 
-    case SENSOR_TEMPERATURE:
-      // Temperature is already read outside the loop.
-      // If this case is for a different temp sensor, its logic should be here.
-      reading = temp;
-      break;
+// Acquisition: a new registry restarts the sweep on the built-in curves; put
+// the stored ones back
+static void applySensorChanges() {
+  if (sensorMonitor.applyRegistry()) calibration_reload = true;
 
-    case SENSOR_GENERIC:
-    default:
-      // reading = muxVoltage;
-      break;
+  if (calibration_reload) {
+    calibration_reload = false;
+    uint8_t stored = loadStoredCalibration();
+    sensorMonitor.compileCalibration();
+    reportCalibration(stored);
   }
+}
 
-  // Store in JSON for unified output
-  // doc[sensorMap[i].name] = reading;
-  data.set(sensorMap[i].name, reading);
-  if (DEBUG) {
-    Serial.printf("%s (Ch%d): %.2f\n", sensorMap[i].name, channel, reading);
-  }
+// Processing: one publish pass over the samples merged so far
+void monitorSensors() {
+  static SensorPass pass;
+  PROFILE_SCOPE(passSpan);
+
+  // Thermocouple faults show in tc_status; the sweep is published regardless
+  sensorMonitor.processor().pass(readings);
+  accountEnergy(readings);
+
+  // --- Publish the complete sweep ---
+  sensorSnapshot.write(readings);
+  pass.ms = millis();
+  pass.readings = readings;
+  if (passQueue.push(pass)) xTaskNotifyGive(aggregateHandle);
 }
-  // vTaskDelay(100 / portTICK_PERIOD_MS);
+
+// -------- FreeRTOS Tasks --------
+// Wakes when the MAX6675 has a fresh conversion, so an over-temperature
+// reaches the fans within THERMO_CONVERSION_MS instead of a sensor pass. The
+// wake-ups are on a fixed grid one tick past each conversion boundary, so
+// reads neither drift late nor land early and abort a conversion.
+void monitorThermalTask(void *pvParameters) {
+  ThermalLoop& thermal = sensorMonitor.thermal();
+  TickType_t wake = xTaskGetTickCount();
+  PROFILE_TASK(thermalSpan);
+  while (1) {
+    PROFILE_SCOPE(thermalSpan);
+    bool sampled = thermal.poll(millis());
+    PROFILE_SCOPE_END(thermalSpan);
+    if (!sampled) {
+      vTaskDelay(thermal.msUntilSample(millis()) / portTICK_PERIOD_MS + 1); // off the grid: realign
+      wake = xTaskGetTickCount();
+      continue;
+    }
+    vTaskDelayUntil(&wake, THERMO_CONVERSION_MS / portTICK_PERIOD_MS + 1);
+  }
 }
 
-// -------- FreeRTOS Task --------
+// Acquisition: sweeps whatever the scheduler has due and hands it on, then
+// watches for transients until the next sensor is due (blocked on the ADC,
+// so not counted as busy). Registry and calibration changes are picked up at
+// least once per publish period.
 void monitorSensorsTask(void *pvParameters) {
+  static SensorSample sample;
   setupSensors();
+  PROFILE_TASK(acquireSpan);
 
   while (1) {
-    // stack watermark
-    // UBaseType_t stackHighWaterMark = uxTaskGetStackHighWaterMark(NULL);
-    // Serial.printf("MonitorSensors stack remaining: %d bytes\n", stackHighWaterMark * sizeof(StackType_t));
     // esp_task_wdt_reset();
-    if(DEBUG) Serial.println("Reading sensors...");
-    monitorSensors();
-    if(DEBUG) Serial.println();
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    PROFILE_SCOPE(acquireSpan);
+    applySensorChanges();
+    if (sensorMonitor.sample(sample) && sampleQueue.push(sample)) xTaskNotifyGive(processHandle);
+    if (DEBUG) reportSensorTiming();
+
+    uint32_t wait = (sensorMonitor.usUntilDue() + 999) / 1000;
+    if (wait > SENSOR_PUBLISH_MS) wait = SENSOR_PUBLISH_MS;
+    PROFILE_SCOPE_END(acquireSpan);
+    if (wait) burstWatcher.watch(wait);
+  }
+}
+
+// Processing: merges samples as acquisition queues them, the faster sensors
+// going out between passes, and runs a publish pass every SENSOR_PUBLISH_MS
+void monitorProcessTask(void *pvParameters) {
+  static SensorSample sample;
+  uint32_t publish_at = millis();
+  PROFILE_TASK(processSpan);
+
+  while (1) {
+    PROFILE_SCOPE(processSpan);
+    bool merged = false;
+    while (sampleQueue.pop(sample)) {
+      sensorMonitor.processor().merge(sample, readings);
+      if (sample.count) integrateEnergy(sample);
+      merged = true;
+    }
+
+    if ((int32_t)(millis() - publish_at) >= 0) {
+      if(DEBUG) Serial.println("Reading sensors...");
+      monitorSensors();
+      if(DEBUG) Serial.println();
+      publish_at += SENSOR_PUBLISH_MS;
+      if ((int32_t)(millis() - publish_at) >= 0) publish_at = millis() + SENSOR_PUBLISH_MS; // a pass behind: realign
+    } else if (merged) {
+      sensorSnapshot.write(readings);
+    }
+
+    // Until the next sample or pass
+    PROFILE_SCOPE_END(processSpan);
+    int32_t until_publish = (int32_t)(publish_at - millis());
+    if (until_publish > 0) ulTaskNotifyTake(pdTRUE, until_publish / portTICK_PERIOD_MS + 1);
+  }
+}
+
+// Aggregation: history rollups of each pass, off the sampling core. Also
+// samples the profiled tasks once per window (Profiler.h).
+void monitorAggregateTask(void *pvParameters) {
+  static SensorPass pass;
+  PROFILE_TASK(aggregateSpan);
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, SENSOR_TIMING_REPORT_MS / portTICK_PERIOD_MS);
+    PROFILE_SCOPE(aggregateSpan);
+    while (passQueue.pop(pass)) sensorHistory.record(pass.ms, pass.readings);
+    if (DEBUG) reportPipeline();
+#if PROFILER
+    if (profileTick(millis()) && DEBUG) printProfile(Serial);
+#endif
   }
 }
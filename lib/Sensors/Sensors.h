@@ -3,24 +3,15 @@
 
 #include <Arduino.h>
 // #include <ArduinoJson.h>
-#include "SimpleJson.h"
-#include <max6675.h>
+#include "Telemetry.h"
+#include "Seqlock.h"
+#include "SensorMonitor.h"
+#include "TimeSeries.h"
+#include "EnergyMeter.h"
+#include "BurstCapture.h"
 #include <esp_task_wdt.h>
 #include <vector>
 
-enum SensorType {
-  SENSOR_VOLTAGE,
-  SENSOR_CURRENT,
-  SENSOR_TEMPERATURE,
-  SENSOR_GENERIC
-};
-
-struct SensorConfig {
-  int channel;
-  SensorType type;
-  const char* name;
-};
-
 // struct SensorReadingsConfig {
 //   const char* name;
 //   char* variable;
@@ -36,11 +27,64 @@ struct SensorConfig {
 // Global object (shared across files)
 // extern SensorData sensorData;
 // extern JsonDocument doc;
-extern SimpleJson data;
+// Latest complete set of readings, published by the processing task after
+// each merged sweep and each pass.
+// Readers copy it with sensorSnapshot.read(); they never block the sampler.
+extern Seqlock<TelemetryFrame> sensorSnapshot;
+
+// Rollups (raw, 1 s, 1 min, 1 h) of every reading above; any task may read
+extern TelemetryHistory sensorHistory;
 
-// Setup and control functions
+// Sampling and conversion behind the readings above, on the board HAL, plus
+// the thermal loop (sensorMonitor.thermal()) that stages the fans;
+// sensorMonitor.sampler().latest() returns the most recent raw mux sweep
+extern SensorMonitor sensorMonitor;
+
+// Transients caught between sweeps on the armed channels; whoever publishes
+// them takes burstCapture.ready() and release()s it once sent
+extern BurstCapture burstCapture;
+
+// Setup and control functions. monitorSensorsTask is the acquisition stage
+// and runs setupSensors(), which starts the thermal loop and the processing
+// (core 1) and aggregation (core 0) stages; monitorSensors() is one
+// processing pass.
 void setupSensors();
 void monitorSensors();
 void monitorSensorsTask(void *pvParameters);
+void monitorThermalTask(void *pvParameters);
+void monitorProcessTask(void *pvParameters);
+void monitorAggregateTask(void *pvParameters);
+
+// Force the fans to a fixed mask (bit per fan); -1 returns to temperature control
+void setFanOverride(int mask);
+
+// Fan stage thresholds and hold time: validated, stored in NVS and picked up
+// by the thermal loop on its next sample
+bool configureFans(const FanControlConfig& config);
+FanControlConfig fanConfig();
+
+// Which mux channels are read, through which decoder and filter, into which
+// field and how often: validated, stored in NVS and picked up by the sensor
+// task on its next pass
+bool configureSensors(const SensorRegistry& registry);
+SensorRegistry sensorRegistry();
+
+// Burst trigger rules: validated, stored in NVS and picked up by the watcher
+// on its next block
+bool configureBurst(const BurstConfig& config);
+BurstConfig burstConfig();
+
+// Energy counters: zero them, set the battery's SOC (%) or capacity (Ah);
+// NAN leaves that setting alone. Applied and saved by the processing task on
+// its next pass.
+bool configureEnergy(bool reset, float socPercent, float capacityAh);
+
+// Calibration, by mux channel. Capture pairs the channel's latest filtered
+// reading with a reference value (returns the number of points so far, or -1);
+// fit turns the points into a curve, stores it in NVS and has the sensor task
+// rebuild its tables; reset returns the channel to the built-in curve.
+int captureCalibrationPoint(uint8_t channel, float value);
+bool fitChannelCalibration(uint8_t channel, bool piecewise, bool useEfuse, float zeroBelow);
+bool resetChannelCalibration(uint8_t channel);
 
 #endif
@@ -0,0 +1,91 @@
+#ifndef FIXED_FORMAT_H
+#define FIXED_FORMAT_H
+
+#include <stdlib_noniso.h>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+// Fixed-precision float formatting without the generic float printer.
+// formatFixed(out, v, d) writes exactly what dtostrf(v, d + 2, d, out) (and so
+// String(v, d)) writes: "nan"/"inf", "-0.00" for small negatives, "0.00" for
+// -0.0, and a leading space for one-digit values when d == 0.
+//
+// The float is split into its integer mantissa and binary exponent and scaled
+// by 10^d in 64-bit integer arithmetic, so rounding is exact. Two cases are
+// handed to dtostrf itself so the output stays byte-identical: exact ties
+// (e.g. 0.25 at one decimal), where dtostrf's double arithmetic decides the
+// direction, and results that do not fit in 32 bits.
+
+#define FIXED_FORMAT_MAX_DECIMALS 8
+#define FIXED_FORMAT_SIZE 52 // sign, 39 digits of FLT_MAX, point, 8 decimals, NUL
+
+// Writes into out (at least FIXED_FORMAT_SIZE bytes), returns the length
+inline size_t formatFixed(char* out, float v, unsigned int decimals) {
+  static const uint32_t pow10[FIXED_FORMAT_MAX_DECIMALS + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+  };
+  if (decimals > FIXED_FORMAT_MAX_DECIMALS) decimals = FIXED_FORMAT_MAX_DECIMALS;
+
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  uint32_t biased = (bits >> 23) & 0xFF;
+  uint64_t mantissa = bits & 0x7FFFFF;
+  if (biased == 0xFF) {
+    memcpy(out, mantissa ? "nan" : "inf", 4);
+    return 3;
+  }
+  int exponent = biased ? (int)biased - 150 : -149;
+  if (biased) mantissa |= 0x800000;
+  bool negative = (bits >> 31) && mantissa != 0;
+
+  // scaled = round(|v| * 10^decimals) = round(mantissa * 10^decimals * 2^exponent)
+  uint64_t product = mantissa * pow10[decimals];
+  uint64_t scaled;
+  if (exponent >= 0) {
+    if (exponent > 31 || (product >> (32 - exponent)) != 0) goto fallback;
+    scaled = product << exponent;
+  } else if (exponent > -64) {
+    unsigned int shift = (unsigned int)-exponent;
+    uint64_t rest = product & ((1ULL << shift) - 1);
+    uint64_t half = 1ULL << (shift - 1);
+    if (rest == half) goto fallback;
+    scaled = (product >> shift) + (rest > half ? 1 : 0);
+  } else {
+    scaled = 0; // product < 2^51, far below half of 2^64
+  }
+  if (scaled > 0xFFFFFFFFULL) goto fallback;
+
+  {
+    uint32_t whole = (uint32_t)(scaled / pow10[decimals]);
+    uint32_t frac = (uint32_t)(scaled % pow10[decimals]);
+
+    char digits[10];
+    size_t count = 0;
+    do {
+      digits[count++] = (char)('0' + whole % 10);
+      whole /= 10;
+    } while (whole);
+
+    size_t n = 0;
+    if (decimals == 0 && !negative && count == 1) out[n++] = ' '; // dtostrf width padding
+    if (negative) out[n++] = '-';
+    while (count) out[n++] = digits[--count];
+    if (decimals) {
+      out[n++] = '.';
+      for (unsigned int i = decimals; i-- > 0;) {
+        out[n + i] = (char)('0' + frac % 10);
+        frac /= 10;
+      }
+      n += decimals;
+    }
+    out[n] = '\0';
+    return n;
+  }
+
+fallback:
+  dtostrf(v, decimals + 2, decimals, out);
+  return strlen(out);
+}
+
+#endif // FIXED_FORMAT_H
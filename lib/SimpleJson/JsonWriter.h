@@ -0,0 +1,150 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Print.h>
+#include "FixedFormat.h"
+#include <cstring>
+#include <cstddef>
+
+// Streaming JSON writer with zero heap use.
+// Output goes either into a caller-supplied buffer or straight to a Print sink
+// (Serial, a client, ...). In buffer mode the result is always NUL-terminated and
+// length() keeps counting past the end, so callers can tell exactly how big the
+// document is and whether it was truncated (same contract as snprintf).
+class JsonWriter {
+public:
+  JsonWriter(char* buffer, size_t bufSize)
+    : buf(buffer), cap(bufSize), sink(nullptr), len(0), first(true) {
+    if (cap > 0) buf[0] = '\0';
+  }
+
+  explicit JsonWriter(Print& out)
+    : buf(nullptr), cap(0), sink(&out), len(0), first(true) {}
+
+  // Bytes of the full document so far (excluding the NUL terminator)
+  size_t length() const { return len; }
+
+  // True if the document did not fit in the buffer (buffer mode only)
+  bool truncated() const { return sink == nullptr && len >= cap; }
+
+  // --- Structure ---
+  void beginObject() { put('{'); first = true; }
+  void endObject() { put('}'); first = false; }
+  void beginArray() { put('['); first = true; }
+  void endArray() { put(']'); first = false; }
+
+  // Separator before each array element
+  void item() {
+    if (!first) put(',');
+    first = false;
+  }
+
+  void key(const char* k) {
+    if (!first) put(',');
+    first = false;
+    put('"');
+    raw(k);
+    put('"');
+    put(':');
+  }
+
+  // --- Values ---
+  void value(int v) {
+    char tmp[12];
+    raw(tmp, formatInt(tmp, v));
+  }
+
+  void value(unsigned int v) {
+    char tmp[12];
+    raw(tmp, formatUInt(tmp, v));
+  }
+
+  void value(long v) { value((int)v); }
+  void value(unsigned long v) { value((unsigned int)v); }
+
+  // Same output as String(v, decimals), without the generic float printer
+  void value(float v, unsigned int decimals = 2) {
+    char tmp[FIXED_FORMAT_SIZE];
+    raw(tmp, formatFixed(tmp, v, decimals));
+  }
+
+  void value(bool v) { raw(v ? "true" : "false"); }
+
+  void value(const char* s) { value(s, strlen(s)); }
+
+  // Writes n bytes of s; s need not be NUL-terminated
+  void value(const char* s, size_t n) {
+    put('"');
+    for (const char* end = s + n; s < end; s++) {
+      char c = *s;
+      if (c == '"' || c == '\\') {
+        put('\\');
+        put(c);
+      } else if ((unsigned char)c < 0x20) {
+        static const char hex[] = "0123456789abcdef";
+        raw("\\u00");
+        put(hex[(c >> 4) & 0x0F]);
+        put(hex[c & 0x0F]);
+      } else {
+        put(c);
+      }
+    }
+    put('"');
+  }
+
+  void null() { raw("null"); }
+
+  // --- Raw output ---
+  void raw(const char* s) { raw(s, strlen(s)); }
+
+  void raw(const char* s, size_t n) {
+    if (sink) {
+      sink->write((const uint8_t*)s, n);
+    } else if (len + 1 < cap) {
+      size_t room = cap - 1 - len;
+      size_t m = n < room ? n : room;
+      memcpy(buf + len, s, m);
+      buf[len + m] = '\0';
+    }
+    len += n;
+  }
+
+  void put(char c) {
+    if (sink) {
+      sink->write((uint8_t)c);
+    } else if (len + 1 < cap) {
+      buf[len] = c;
+      buf[len + 1] = '\0';
+    }
+    len++;
+  }
+
+  // Writes the decimal form of v into out (no terminator), returns its length
+  static size_t formatUInt(char* out, unsigned int v) {
+    char rev[10];
+    size_t n = 0;
+    do {
+      rev[n++] = (char)('0' + v % 10);
+      v /= 10;
+    } while (v);
+    for (size_t i = 0; i < n; i++) out[i] = rev[n - 1 - i];
+    return n;
+  }
+
+  static size_t formatInt(char* out, int v) {
+    if (v < 0) {
+      out[0] = '-';
+      return 1 + formatUInt(out + 1, 0u - (unsigned int)v);
+    }
+    return formatUInt(out, (unsigned int)v);
+  }
+
+private:
+  char* buf;
+  size_t cap;
+  Print* sink;
+  size_t len;
+  bool first;
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,69 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer sequence lock for handing a plain-data value between tasks/cores.
+//
+// The writer never waits: it bumps the sequence to odd, stores the value, and
+// bumps it back to even. Readers copy the value and retry if the sequence was odd
+// or changed underneath them, so they only ever see a complete write. The value is
+// stored as relaxed atomic words, which keeps the concurrent copy well-defined.
+template <typename T>
+class Seqlock {
+  static_assert(std::is_trivially_copyable<T>::value, "Seqlock needs plain data");
+
+public:
+  Seqlock() : seq(0) {
+    for (size_t i = 0; i < WORDS; i++) words[i].store(0, std::memory_order_relaxed);
+  }
+
+  // Publish a new value. Only one task may call this.
+  void write(const T& value) {
+    uint32_t buf[WORDS] = {};
+    memcpy(buf, &value, sizeof(T));
+
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; i++) words[i].store(buf[i], std::memory_order_relaxed);
+    seq.store(s + 2, std::memory_order_release);
+  }
+
+  // One copy attempt; false if a write was in progress or raced with us
+  bool tryRead(T& out) const {
+    uint32_t s1 = seq.load(std::memory_order_acquire);
+    if (s1 & 1u) return false;
+
+    uint32_t buf[WORDS];
+    for (size_t i = 0; i < WORDS; i++) buf[i] = words[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq.load(std::memory_order_relaxed) != s1) return false;
+
+    memcpy(&out, buf, sizeof(T));
+    return true;
+  }
+
+  // Retries a few times; returns false (out untouched) rather than waiting on the
+  // writer, e.g. when the writer was preempted mid-update on the same core.
+  bool read(T& out, int attempts = 8) const {
+    while (attempts-- > 0) {
+      if (tryRead(out)) return true;
+    }
+    return false;
+  }
+
+  // Number of completed writes
+  uint32_t version() const { return seq.load(std::memory_order_acquire) >> 1; }
+
+private:
+  static const size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+  std::atomic<uint32_t> seq;
+  std::atomic<uint32_t> words[WORDS];
+};
+
+#endif // SEQLOCK_H
@@ -0,0 +1,80 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Bounded single-producer/single-consumer ring for handing plain-data items
+// from one task (or core) to another in order, without locks.
+//
+// Each side owns one index: the producer publishes a slot by storing head
+// with release order after writing it, the consumer frees one by storing
+// tail after copying it out. Each side also keeps a copy of the other's
+// index and only reloads it with acquire order when the ring looks full (or
+// empty), so a busy stream does not synchronise the cores on every item.
+//
+// The producer never waits: push() on a full ring drops the item and counts
+// it, which is the back-pressure signal to watch (with highWater()).
+template <typename T, size_t N>
+class SpscQueue {
+  static_assert(std::is_trivially_copyable<T>::value, "SpscQueue needs plain data");
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+  SpscQueue() : head(0), tail(0), producer_tail(0), consumer_head(0), pushed_count(0), dropped_count(0), high_water(0) {}
+
+  // Producer only. False (and counted) if the consumer is N items behind.
+  bool push(const T& item) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - producer_tail >= N) {
+      producer_tail = tail.load(std::memory_order_acquire);
+      if (h - producer_tail >= N) {
+        dropped_count.store(dropped_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    items[h & (N - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+    pushed_count.store(pushed_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    // Against the consumer's actual tail: the cached copy only moves when the
+    // ring looks full, so it would report a consumer that keeps up as N behind
+    uint32_t depth = h + 1 - tail.load(std::memory_order_relaxed);
+    if (depth > high_water.load(std::memory_order_relaxed)) high_water.store(depth, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Consumer only. False if there is nothing to take.
+  bool pop(T& out) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == consumer_head) {
+      consumer_head = head.load(std::memory_order_acquire);
+      if (t == consumer_head) return false;
+    }
+    out = items[t & (N - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Items waiting; exact from either side, a snapshot from anywhere else
+  size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+  static size_t capacity() { return N; }
+
+  // Any task
+  uint32_t pushed() const { return pushed_count.load(std::memory_order_relaxed); }
+  uint32_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+  uint32_t highWater() const { return high_water.load(std::memory_order_relaxed); } // deepest the ring has been
+
+private:
+  std::atomic<uint32_t> head;    // next slot to write (producer)
+  std::atomic<uint32_t> tail;    // next slot to read (consumer)
+  uint32_t producer_tail;        // producer's copy of tail
+  uint32_t consumer_head;        // consumer's copy of head
+  std::atomic<uint32_t> pushed_count;
+  std::atomic<uint32_t> dropped_count;
+  std::atomic<uint32_t> high_water;
+  T items[N];
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,126 @@
+#include "Telemetry.h"
+#include <cstddef>
+
+// -------- Schema table --------
+const TelemetryFieldDesc telemetryFields[TEL_FIELD_COUNT] = {
+#define TELEMETRY_DESC(id, member, name, type, prec) \
+  { name, (TelemetryKind)TelemetryKindOf<type>::value, prec, (uint16_t)offsetof(TelemetryFrame, member) },
+  TELEMETRY_FIELDS(TELEMETRY_DESC)
+#undef TELEMETRY_DESC
+};
+
+TelemetryIp makeTelemetryIp(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+  TelemetryIp ip = { { a, b, c, d } };
+  return ip;
+}
+
+TelemetryText makeTelemetryText(const char* s) {
+  TelemetryText t;
+  strncpy(t.str, s ? s : "", TELEMETRY_TEXT_LENGTH - 1);
+  t.str[TELEMETRY_TEXT_LENGTH - 1] = '\0';
+  return t;
+}
+
+// -------- Typed text formatting (one overload per field type) --------
+static size_t copyText(char* out, size_t outSize, const char* text, size_t n) {
+  if (outSize == 0) return 0;
+  if (n >= outSize) n = outSize - 1;
+  memcpy(out, text, n);
+  out[n] = '\0';
+  return n;
+}
+
+static size_t formatValue(char* out, size_t outSize, float v, int precision) {
+  char tmp[FIXED_FORMAT_SIZE];
+  return copyText(out, outSize, tmp, formatFixed(tmp, v, precision < 0 ? 0 : precision));
+}
+
+static size_t formatValue(char* out, size_t outSize, bool v, int) {
+  return v ? copyText(out, outSize, "true", 4) : copyText(out, outSize, "false", 5);
+}
+
+static size_t formatValue(char* out, size_t outSize, int32_t v, int) {
+  char tmp[12];
+  return copyText(out, outSize, tmp, JsonWriter::formatInt(tmp, (int)v));
+}
+
+static size_t formatValue(char* out, size_t outSize, uint32_t v, int) {
+  char tmp[12];
+  return copyText(out, outSize, tmp, JsonWriter::formatUInt(tmp, (unsigned int)v));
+}
+
+static size_t formatValue(char* out, size_t outSize, const TelemetryIp& v, int) {
+  char tmp[16];
+  size_t n = 0;
+  for (int i = 0; i < 4; i++) {
+    if (i) tmp[n++] = '.';
+    n += JsonWriter::formatUInt(tmp + n, v.octets[i]);
+  }
+  return copyText(out, outSize, tmp, n);
+}
+
+static size_t formatValue(char* out, size_t outSize, const TelemetryText& v, int) {
+  return copyText(out, outSize, v.str, strlen(v.str));
+}
+
+// -------- JSON values --------
+static void writeValue(JsonWriter& w, float v, int precision) { w.value(v, precision); }
+static void writeValue(JsonWriter& w, bool v, int) { w.value(v); }
+static void writeValue(JsonWriter& w, int32_t v, int) { w.value((int)v); }
+static void writeValue(JsonWriter& w, uint32_t v, int) { w.value((unsigned int)v); }
+static void writeValue(JsonWriter& w, const TelemetryText& v, int) { w.value(v.str); }
+
+static void writeValue(JsonWriter& w, const TelemetryIp& v, int) {
+  char tmp[16];
+  formatValue(tmp, sizeof(tmp), v, 0);
+  w.value(tmp);
+}
+
+// -------- Frame --------
+void TelemetryFrame::merge(const TelemetryFrame& src) {
+#define TELEMETRY_MERGE(id, member, name, type, prec) \
+  if (src.has(TEL_##id)) set<TEL_##id>(src.member);
+  TELEMETRY_FIELDS(TELEMETRY_MERGE)
+#undef TELEMETRY_MERGE
+}
+
+void TelemetryFrame::write(JsonWriter& w, uint32_t fields) const {
+  fields &= present;
+  w.beginObject();
+#define TELEMETRY_WRITE(id, member, name, type, prec) \
+  if (fields & (1u << TEL_##id)) { w.key(name); writeValue(w, member, prec); }
+  TELEMETRY_FIELDS(TELEMETRY_WRITE)
+#undef TELEMETRY_WRITE
+  w.endObject();
+}
+
+size_t TelemetryFrame::format(TelemetryField f, char* out, size_t outSize, int precision) const {
+  if (outSize > 0) out[0] = '\0';
+  if (f >= TEL_FIELD_COUNT || !has(f)) return 0;
+  switch (f) {
+#define TELEMETRY_FORMAT(id, member, name, type, prec) \
+    case TEL_##id: return formatValue(out, outSize, member, precision < 0 ? prec : precision);
+    TELEMETRY_FIELDS(TELEMETRY_FORMAT)
+#undef TELEMETRY_FORMAT
+    default: return 0;
+  }
+}
+
+// -------- LCD --------
+size_t renderTelemetryLine(const TelemetryFrame& frame, const TelemetryLcdCell* cells, size_t count, char* out, size_t outSize) {
+  if (outSize == 0) return 0;
+  size_t n = 0;
+  out[0] = '\0';
+  for (size_t i = 0; i < count && n + 1 < outSize; i++) {
+    const TelemetryLcdCell& cell = cells[i];
+    n += copyText(out + n, outSize - n, cell.label, strlen(cell.label));
+    if (frame.has(cell.field)) {
+      n += frame.format(cell.field, out + n, outSize - n, cell.precision);
+    } else {
+      // Same as reading a missing value before: zero at the cell's precision
+      n += formatValue(out + n, outSize - n, 0.0f, cell.precision < 0 ? telemetryFields[cell.field].precision : cell.precision);
+    }
+    n += copyText(out + n, outSize - n, cell.unit, strlen(cell.unit));
+  }
+  return n;
+}
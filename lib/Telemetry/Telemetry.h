@@ -0,0 +1,260 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include <cstdint>
+#include <cstring>
+#include "JsonWriter.h"
+
+// ========== Schema ==========
+// One row per published field: X(ID, member, "json key", C++ type, decimals)
+// Everything else in this file (struct layout, field ids, JSON serializer, LCD
+// formatting) is generated from this list, so adding a field is a one-line change.
+// Append only: field ids are the CBOR keys. aux0-aux9 are for sensors added to
+// the registry at runtime (SensorRegistry.h); t_wh..soc are the energy
+// counters (EnergyMeter.h).
+#define TELEMETRY_FIELDS(X) \
+  X(TEMP,        temp,        "temp",        float,         2) \
+  X(FAN_STATE,   fan_state,   "fan_state",   bool,          0) \
+  X(B_V,         b_v,         "b_v",         float,         2) \
+  X(B_C,         b_c,         "b_c",         float,         2) \
+  X(T_V,         t_v,         "t_v",         float,         2) \
+  X(T_C,         t_c,         "t_c",         float,         2) \
+  X(C_V,         c_v,         "c_v",         float,         2) \
+  X(C_C,         c_c,         "c_c",         float,         2) \
+  X(UPTIME,      uptime,      "uptime",      uint32_t,      0) \
+  X(ACTIVE_CONN, active_conn, "active_conn", int32_t,       0) \
+  X(SIG_RSSI,    sig_rssi,    "sig_rssi",    int32_t,       0) \
+  X(BLE_STATUS,  ble_status,  "ble_status",  bool,          0) \
+  X(IP,          ip,          "ip",          TelemetryIp,   0) \
+  X(VER,         ver,         "ver",         TelemetryText, 0) \
+  X(TC_STATUS,   tc_status,   "tc_status",   int32_t,       0) \
+  X(AUX0,        aux0,        "aux0",        float,         2) \
+  X(AUX1,        aux1,        "aux1",        float,         2) \
+  X(AUX2,        aux2,        "aux2",        float,         2) \
+  X(AUX3,        aux3,        "aux3",        float,         2) \
+  X(AUX4,        aux4,        "aux4",        float,         2) \
+  X(AUX5,        aux5,        "aux5",        float,         2) \
+  X(AUX6,        aux6,        "aux6",        float,         2) \
+  X(AUX7,        aux7,        "aux7",        float,         2) \
+  X(AUX8,        aux8,        "aux8",        float,         2) \
+  X(AUX9,        aux9,        "aux9",        float,         2) \
+  X(T_WH,        t_wh,        "t_wh",        float,         2) \
+  X(C_WH,        c_wh,        "c_wh",        float,         2) \
+  X(B_WH,        b_wh,        "b_wh",        float,         2) \
+  X(B_AH,        b_ah,        "b_ah",        float,         3) \
+  X(SOC,         soc,         "soc",         float,         1)
+
+#define TELEMETRY_TEXT_LENGTH 12
+
+// IPv4 address, octets in transmission order
+struct TelemetryIp {
+  uint8_t octets[4];
+};
+
+struct TelemetryText {
+  char str[TELEMETRY_TEXT_LENGTH];
+};
+
+enum TelemetryField : uint8_t {
+#define TELEMETRY_ENUM(id, member, name, type, prec) TEL_##id,
+  TELEMETRY_FIELDS(TELEMETRY_ENUM)
+#undef TELEMETRY_ENUM
+  TEL_FIELD_COUNT
+};
+
+static_assert(TEL_FIELD_COUNT <= 32, "present mask is 32 bits");
+
+#define TEL_ALL_FIELDS 0xFFFFFFFFu
+
+enum TelemetryKind : uint8_t {
+  TEL_KIND_FLOAT,
+  TEL_KIND_BOOL,
+  TEL_KIND_INT,
+  TEL_KIND_UINT,
+  TEL_KIND_IP,
+  TEL_KIND_TEXT
+};
+
+template <typename T> struct TelemetryKindOf;
+template <> struct TelemetryKindOf<float> { enum { value = TEL_KIND_FLOAT }; };
+template <> struct TelemetryKindOf<bool> { enum { value = TEL_KIND_BOOL }; };
+template <> struct TelemetryKindOf<int32_t> { enum { value = TEL_KIND_INT }; };
+template <> struct TelemetryKindOf<uint32_t> { enum { value = TEL_KIND_UINT }; };
+template <> struct TelemetryKindOf<TelemetryIp> { enum { value = TEL_KIND_IP }; };
+template <> struct TelemetryKindOf<TelemetryText> { enum { value = TEL_KIND_TEXT }; };
+
+// Runtime view of the schema, for code that walks fields by id
+struct TelemetryFieldDesc {
+  const char* key;
+  TelemetryKind kind;
+  uint8_t precision;
+  uint16_t offset;
+};
+
+extern const TelemetryFieldDesc telemetryFields[TEL_FIELD_COUNT];
+
+template <TelemetryField F> struct TelemetryFieldInfo;
+
+// ========== Frame ==========
+// Fixed-layout record of every field plus a bit per field that has been set.
+// Plain data: safe to memcpy, compare and hand between tasks.
+//
+// Every set that changes a field's value (or sets it for the first time) stamps
+// that field with the next change epoch, so a publisher can ask which fields
+// changed since the epoch it last sent (changedSince()).
+struct TelemetryFrame {
+#define TELEMETRY_MEMBER(id, member, name, type, prec) type member;
+  TELEMETRY_FIELDS(TELEMETRY_MEMBER)
+#undef TELEMETRY_MEMBER
+  uint32_t present;
+  uint32_t epoch;                        // last epoch handed out
+  uint32_t changedAt[TEL_FIELD_COUNT];   // epoch of each field's last change
+
+  TelemetryFrame() { clear(); }
+
+  void clear() { memset(this, 0, sizeof(*this)); }
+
+  bool has(TelemetryField f) const { return (present >> f) & 1u; }
+
+  // Marks a field as not set (it is left out of output and merges)
+  void unset(TelemetryField f) { present &= ~(1u << f); }
+
+  template <TelemetryField F>
+  void set(const typename TelemetryFieldInfo<F>::Type& value) {
+    typename TelemetryFieldInfo<F>::Type& member = TelemetryFieldInfo<F>::ref(*this);
+    if (!has(F) || memcmp(&member, &value, sizeof(member)) != 0) {
+      member = value;
+      touch(F);
+    }
+  }
+
+  template <TelemetryField F>
+  const typename TelemetryFieldInfo<F>::Type& get() const {
+    return TelemetryFieldInfo<F>::ref(*this);
+  }
+
+  // Sets a float field chosen at runtime (sensor tables); ignores other kinds
+  void setFloat(TelemetryField f, float value) {
+    if (f >= TEL_FIELD_COUNT || telemetryFields[f].kind != TEL_KIND_FLOAT) return;
+    uint8_t* member = (uint8_t*)this + telemetryFields[f].offset;
+    if (!has(f) || memcmp(member, &value, sizeof(value)) != 0) {
+      memcpy(member, &value, sizeof(value));
+      touch(f);
+    }
+  }
+
+  float getFloat(TelemetryField f, float defaultValue = 0.0f) const {
+    if (f >= TEL_FIELD_COUNT || !has(f) || telemetryFields[f].kind != TEL_KIND_FLOAT) return defaultValue;
+    float value;
+    memcpy(&value, (const uint8_t*)this + telemetryFields[f].offset, sizeof(value));
+    return value;
+  }
+
+  // Mask of set fields whose value changed after the given epoch
+  uint32_t changedSince(uint32_t since) const {
+    uint32_t mask = 0;
+    for (int f = 0; f < TEL_FIELD_COUNT; f++) {
+      if (changedAt[f] > since) mask |= 1u << f;
+    }
+    return mask & present;
+  }
+
+  // Copies every field that is set in src (fields src lacks are left alone).
+  // Change epochs are this frame's own: only values that differ are stamped.
+  void merge(const TelemetryFrame& src);
+
+  // --- Serialization ---
+  // 'fields' restricts output to a subset (e.g. a delta); unset fields are skipped
+  void write(JsonWriter& w, uint32_t fields = TEL_ALL_FIELDS) const;
+
+  void print(Print& s) const {
+    JsonWriter w(s);
+    write(w);
+  }
+
+  // Serializes into buffer (always NUL-terminated); false if it was truncated
+  bool serialize(char* buffer, size_t bufSize, size_t* length = nullptr, uint32_t fields = TEL_ALL_FIELDS) const {
+    JsonWriter w(buffer, bufSize);
+    write(w, fields);
+    if (length) *length = w.length();
+    return !w.truncated();
+  }
+
+  // Formats one field as text (no quotes); precision < 0 uses the schema's.
+  // Returns the formatted length, 0 if the field is not set.
+  size_t format(TelemetryField f, char* out, size_t outSize, int precision = -1) const;
+
+private:
+  void touch(TelemetryField f) {
+    present |= 1u << f;
+    changedAt[f] = ++epoch;
+  }
+};
+
+#define TELEMETRY_INFO(id, member, name, type, prec) \
+  template <> struct TelemetryFieldInfo<TEL_##id> { \
+    typedef type Type; \
+    enum { kind = TelemetryKindOf<type>::value, precision = prec }; \
+    static type& ref(TelemetryFrame& f) { return f.member; } \
+    static const type& ref(const TelemetryFrame& f) { return f.member; } \
+  };
+TELEMETRY_FIELDS(TELEMETRY_INFO)
+#undef TELEMETRY_INFO
+
+// Helpers for the non-scalar field types
+TelemetryIp makeTelemetryIp(uint8_t a, uint8_t b, uint8_t c, uint8_t d);
+TelemetryText makeTelemetryText(const char* s);
+
+// ========== Delta publishing ==========
+// Decides which fields go into the next message: a full keyframe every
+// 'keyframeInterval' messages (and whenever forceKeyframe() was called, e.g.
+// after a reconnect), otherwise only fields changed since the last message
+// that was actually published.
+class TelemetryDelta {
+public:
+  explicit TelemetryDelta(uint16_t keyframeInterval) : interval(keyframeInterval) {}
+
+  // Field mask for the next message; *keyframe tells the receiver how to apply it
+  uint32_t select(const TelemetryFrame& frame, bool* keyframe) {
+    pendingEpoch = frame.epoch;
+    pendingKeyframe = needKeyframe || sinceKeyframe + 1 >= interval;
+    if (keyframe) *keyframe = pendingKeyframe;
+    return pendingKeyframe ? frame.present : frame.changedSince(ackedEpoch);
+  }
+
+  // Call once the message built from the last select() was sent
+  void published() {
+    ackedEpoch = pendingEpoch;
+    if (pendingKeyframe) {
+      needKeyframe = false;
+      sinceKeyframe = 0;
+    } else {
+      sinceKeyframe++;
+    }
+  }
+
+  void forceKeyframe() { needKeyframe = true; }
+
+private:
+  uint16_t interval;
+  uint16_t sinceKeyframe = 0;
+  bool needKeyframe = true;
+  bool pendingKeyframe = true;
+  uint32_t ackedEpoch = 0;
+  uint32_t pendingEpoch = 0;
+};
+
+// ========== LCD rendering ==========
+// A display line is a list of cells "<label><value><unit>" taken from the frame
+struct TelemetryLcdCell {
+  TelemetryField field;
+  const char* label;
+  const char* unit;
+  int8_t precision; // -1 = schema precision
+};
+
+// Renders cells into out (NUL-terminated), returns the rendered length
+size_t renderTelemetryLine(const TelemetryFrame& frame, const TelemetryLcdCell* cells, size_t count, char* out, size_t outSize);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,175 @@
+#include "TelemetryCbor.h"
+#include <cmath>
+
+static const float cborScale[] = { 1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f, 100000.0f, 1000000.0f };
+
+#define TELEMETRY_CBOR_PRECISION_CHECK(id, member, name, type, prec) \
+  static_assert(prec < sizeof(cborScale) / sizeof(cborScale[0]), "decimals out of range for " name);
+TELEMETRY_FIELDS(TELEMETRY_CBOR_PRECISION_CHECK)
+#undef TELEMETRY_CBOR_PRECISION_CHECK
+
+// -------- Encoding (one overload per field type) --------
+static void encodeValue(CborWriter& w, float v, int precision) {
+  // Non-finite readings have no scaled form; send them as null
+  if (!std::isfinite(v)) {
+    w.null();
+    return;
+  }
+  w.integer((int64_t)lroundf(v * cborScale[precision]));
+}
+
+static void encodeValue(CborWriter& w, bool v, int) { w.boolean(v); }
+static void encodeValue(CborWriter& w, int32_t v, int) { w.integer(v); }
+static void encodeValue(CborWriter& w, uint32_t v, int) { w.uinteger(v); }
+static void encodeValue(CborWriter& w, const TelemetryIp& v, int) { w.bytes(v.octets, sizeof(v.octets)); }
+static void encodeValue(CborWriter& w, const TelemetryText& v, int) { w.text(v.str, strlen(v.str)); }
+
+bool encodeTelemetryCbor(const TelemetryFrame& frame, uint8_t* buffer, size_t bufSize, size_t* length, uint32_t fields) {
+  CborWriter w(buffer, bufSize);
+  fields &= frame.present;
+  uint32_t mask = fields;
+  size_t count = 0;
+  while (mask) {
+    count += mask & 1u;
+    mask >>= 1;
+  }
+  w.beginMap(count);
+#define TELEMETRY_CBOR_ENCODE(id, member, name, type, prec) \
+  if (fields & (1u << TEL_##id)) { w.uinteger(TEL_##id); encodeValue(w, frame.member, prec); }
+  TELEMETRY_FIELDS(TELEMETRY_CBOR_ENCODE)
+#undef TELEMETRY_CBOR_ENCODE
+  if (length) *length = w.length();
+  return !w.truncated();
+}
+
+// -------- Decoding --------
+struct CborReader {
+  const uint8_t* p;
+  const uint8_t* end;
+
+  // Reads an item head; returns false on truncated input or unsupported forms
+  bool head(uint8_t& major, uint64_t& arg) {
+    if (p >= end) return false;
+    uint8_t ib = *p++;
+    major = ib >> 5;
+    uint8_t info = ib & 0x1F;
+    if (info < 24) {
+      arg = info;
+      return true;
+    }
+    int n = info == 24 ? 1 : info == 25 ? 2 : info == 26 ? 4 : info == 27 ? 8 : 0;
+    if (n == 0 || end - p < n) return false; // indefinite lengths are not produced
+    arg = 0;
+    while (n--) arg = (arg << 8) | *p++;
+    return true;
+  }
+
+  bool integer(int64_t& v) {
+    uint8_t major;
+    uint64_t arg;
+    if (!head(major, arg)) return false;
+    if (major == 0) v = (int64_t)arg;
+    else if (major == 1) v = -1 - (int64_t)arg;
+    else return false;
+    return true;
+  }
+
+  bool string(uint8_t expectMajor, const uint8_t*& data, size_t& n) {
+    uint8_t major;
+    uint64_t arg;
+    if (!head(major, arg) || major != expectMajor || (uint64_t)(end - p) < arg) return false;
+    data = p;
+    n = (size_t)arg;
+    p += n;
+    return true;
+  }
+
+  // Skips one scalar or string item (the telemetry map never nests)
+  bool skip() {
+    uint8_t major;
+    uint64_t arg;
+    if (!head(major, arg)) return false;
+    if (major == 2 || major == 3) {
+      if ((uint64_t)(end - p) < arg) return false;
+      p += arg;
+      return true;
+    }
+    return major == 0 || major == 1 || major == 7;
+  }
+};
+
+static bool decodeValue(CborReader& r, float& v, int precision) {
+  if (r.p < r.end && *r.p == 0xF6) { // null
+    r.p++;
+    v = NAN;
+    return true;
+  }
+  int64_t i;
+  if (!r.integer(i)) return false;
+  v = (float)i / cborScale[precision];
+  return true;
+}
+
+static bool decodeValue(CborReader& r, bool& v, int) {
+  if (r.p >= r.end || (*r.p != 0xF4 && *r.p != 0xF5)) return false;
+  v = *r.p++ == 0xF5;
+  return true;
+}
+
+static bool decodeValue(CborReader& r, int32_t& v, int) {
+  int64_t i;
+  if (!r.integer(i)) return false;
+  v = (int32_t)i;
+  return true;
+}
+
+static bool decodeValue(CborReader& r, uint32_t& v, int) {
+  int64_t i;
+  if (!r.integer(i) || i < 0) return false;
+  v = (uint32_t)i;
+  return true;
+}
+
+static bool decodeValue(CborReader& r, TelemetryIp& v, int) {
+  const uint8_t* data;
+  size_t n;
+  if (!r.string(2, data, n) || n != sizeof(v.octets)) return false;
+  memcpy(v.octets, data, n);
+  return true;
+}
+
+static bool decodeValue(CborReader& r, TelemetryText& v, int) {
+  const uint8_t* data;
+  size_t n;
+  if (!r.string(3, data, n)) return false;
+  if (n >= TELEMETRY_TEXT_LENGTH) n = TELEMETRY_TEXT_LENGTH - 1;
+  memcpy(v.str, data, n);
+  v.str[n] = '\0';
+  return true;
+}
+
+bool decodeTelemetryCbor(const uint8_t* data, size_t length, TelemetryFrame& frame) {
+  CborReader r = { data, data + length };
+  uint8_t major;
+  uint64_t count;
+  if (!r.head(major, count) || major != 5) return false;
+
+  frame.clear();
+  while (count--) {
+    int64_t key;
+    if (!r.integer(key) || key < 0) return false;
+    bool ok;
+    switch (key) {
+#define TELEMETRY_CBOR_DECODE(id, member, name, type, prec) \
+      case TEL_##id: ok = decodeValue(r, frame.member, prec); break;
+      TELEMETRY_FIELDS(TELEMETRY_CBOR_DECODE)
+#undef TELEMETRY_CBOR_DECODE
+      default:
+        if (!r.skip()) return false;
+        continue;
+    }
+    if (!ok) return false;
+    frame.present |= 1u << key;
+  }
+  return r.p == r.end;
+}
@@ -0,0 +1,82 @@
+#ifndef TELEMETRY_CBOR_H
+#define TELEMETRY_CBOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Telemetry.h"
+
+// Compact binary form of a TelemetryFrame (RFC 8949 CBOR), for metered links.
+//
+// The frame is a CBOR map keyed by the TEL_* field id instead of the JSON key
+// string: one byte for ids below 24, two (0x18, id) from 24 on, so AUX9 and
+// the energy counters cost a byte more each. Values:
+//   float -> integer scaled by 10^decimals from the schema (25.34 @2 -> 2534),
+//            null if the reading is not finite
+//   bool  -> CBOR true/false          int/uint -> CBOR integer
+//   ip    -> 4-byte byte string       text     -> text string
+// Field ids are append-only: never renumber a field that has shipped.
+
+// Bounded CBOR writer; same truncation contract as JsonWriter
+class CborWriter {
+public:
+  CborWriter(uint8_t* buffer, size_t bufSize) : buf(buffer), cap(bufSize), len(0) {}
+
+  size_t length() const { return len; }
+  bool truncated() const { return len > cap; }
+
+  void beginMap(size_t count) { head(5, count); }
+  void uinteger(uint64_t v) { head(0, v); }
+  void integer(int64_t v) {
+    if (v < 0) head(1, (uint64_t)(-(v + 1)));
+    else head(0, (uint64_t)v);
+  }
+  void boolean(bool v) { put(v ? 0xF5 : 0xF4); }
+  void null() { put(0xF6); }
+  void bytes(const uint8_t* p, size_t n) { head(2, n); raw(p, n); }
+  void text(const char* s, size_t n) { head(3, n); raw((const uint8_t*)s, n); }
+
+private:
+  void put(uint8_t b) {
+    if (len < cap) buf[len] = b;
+    len++;
+  }
+
+  void raw(const uint8_t* p, size_t n) {
+    for (size_t i = 0; i < n; i++) put(p[i]);
+  }
+
+  void head(uint8_t major, uint64_t arg) {
+    uint8_t mt = (uint8_t)(major << 5);
+    if (arg < 24) {
+      put(mt | (uint8_t)arg);
+    } else if (arg <= 0xFF) {
+      put(mt | 24);
+      put((uint8_t)arg);
+    } else if (arg <= 0xFFFF) {
+      put(mt | 25);
+      put((uint8_t)(arg >> 8));
+      put((uint8_t)arg);
+    } else if (arg <= 0xFFFFFFFFull) {
+      put(mt | 26);
+      for (int s = 24; s >= 0; s -= 8) put((uint8_t)(arg >> s));
+    } else {
+      put(mt | 27);
+      for (int s = 56; s >= 0; s -= 8) put((uint8_t)(arg >> s));
+    }
+  }
+
+  uint8_t* buf;
+  size_t cap;
+  size_t len;
+};
+
+// Encodes the set fields of frame selected by 'fields'. Returns false if buffer was too small;
+// *length gets the full encoded size either way.
+bool encodeTelemetryCbor(const TelemetryFrame& frame, uint8_t* buffer, size_t bufSize, size_t* length = nullptr,
+                         uint32_t fields = TEL_ALL_FIELDS);
+
+// Host/server-side decoder. Unknown field ids are skipped so older decoders keep
+// working when fields are appended. Returns false on malformed input.
+bool decodeTelemetryCbor(const uint8_t* data, size_t length, TelemetryFrame& frame);
+
+#endif // TELEMETRY_CBOR_H
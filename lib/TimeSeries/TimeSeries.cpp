@@ -0,0 +1,252 @@
+#include "TimeSeries.h"
+#include <cstring>
+
+const uint32_t TimeSeries::periods[LEVELS] = { 1000, 60000, 3600000 };
+const uint16_t TimeSeries::sizes[LEVELS] = { SERIES_SECOND_BUCKETS, SERIES_MINUTE_BUCKETS, SERIES_HOUR_BUCKETS };
+const uint16_t TimeSeries::offsets[LEVELS] = { 0, SERIES_SECOND_BUCKETS, SERIES_SECOND_BUCKETS + SERIES_MINUTE_BUCKETS };
+
+static_assert(SERIES_MAX_POINTS >= SERIES_RAW_SAMPLES && SERIES_MAX_POINTS >= SERIES_SECOND_BUCKETS &&
+              SERIES_MAX_POINTS >= SERIES_MINUTE_BUCKETS && SERIES_MAX_POINTS >= SERIES_HOUR_BUCKETS,
+              "SERIES_MAX_POINTS covers every ring");
+
+static const char* const resolutionNames[SERIES_RESOLUTION_COUNT] = { "raw", "1s", "1m", "1h" };
+
+const char* seriesResolutionName(SeriesResolution res) {
+  return res < SERIES_RESOLUTION_COUNT ? resolutionNames[res] : "";
+}
+
+bool parseSeriesResolution(const char* name, SeriesResolution& out) {
+  for (uint8_t r = 0; r < SERIES_RESOLUTION_COUNT; r++) {
+    if (strcmp(name, resolutionNames[r]) == 0) {
+      out = (SeriesResolution)r;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t seriesPeriodMs(SeriesResolution res) {
+  static const uint32_t ms[SERIES_RESOLUTION_COUNT] = { 0, 1000, 60000, 3600000 };
+  return res < SERIES_RESOLUTION_COUNT ? ms[res] : 0;
+}
+
+// -------- Writer --------
+TimeSeries::TimeSeries() : seq(0) {
+  for (size_t i = 0; i < WORD_COUNT; i++) words[i].store(0, std::memory_order_relaxed);
+  memset(openNumber, 0, sizeof(openNumber));
+  memset(held, 0, sizeof(held));
+}
+
+float TimeSeries::floatWord(size_t i) const {
+  uint32_t bits = word(i);
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+void TimeSeries::storeFloat(size_t i, float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  store(i, bits);
+}
+
+void TimeSeries::clearBucket(uint8_t level, uint32_t number) {
+  size_t b = bucketWord(level, number);
+  for (size_t i = 0; i < BUCKET_WORDS; i++) store(b + i, 0);
+}
+
+void TimeSeries::merge(uint8_t level, uint32_t number, float min, float max, float sum, uint32_t count) {
+  if (count == 0) return;
+  size_t b = bucketWord(level, number);
+  uint32_t had = word(b + 3);
+  storeFloat(b + 0, had && floatWord(b + 0) < min ? floatWord(b + 0) : min);
+  storeFloat(b + 1, had && floatWord(b + 1) > max ? floatWord(b + 1) : max);
+  storeFloat(b + 2, floatWord(b + 2) + sum);
+  store(b + 3, had + count);
+}
+
+// Moves a level's open bucket to 'number': the old one closes into the open
+// bucket of the level above, skipped periods become empty buckets. Every
+// bucket is cleared once per period, so this is O(1) per sample amortised.
+void TimeSeries::advance(uint8_t level, uint32_t number) {
+  if (held[level] != 0 && number == openNumber[level]) return;
+
+  if (held[level] == 0 || number < openNumber[level]) {
+    // First sample, or millis() wrapped: start this level over
+    clearBucket(level, number);
+    held[level] = 1;
+  } else {
+    uint32_t old = openNumber[level];
+    if (level + 1 < LEVELS) {
+      size_t b = bucketWord(level, old);
+      merge(level + 1, openNumber[level + 1], floatWord(b + 0), floatWord(b + 1), floatWord(b + 2), word(b + 3));
+    }
+    uint32_t steps = number - old;
+    uint32_t cleared = steps < sizes[level] ? steps : sizes[level];
+    for (uint32_t k = 0; k < cleared; k++) clearBucket(level, number - k);
+    held[level] = (uint16_t)(held[level] + steps < sizes[level] ? held[level] + steps : sizes[level]);
+  }
+  openNumber[level] = number;
+  store(META_LEVEL + level * 2, number);
+  store(META_LEVEL + level * 2 + 1, held[level]);
+
+  // Keep the level above on the period that contains this bucket
+  if (level + 1 < LEVELS) advance(level + 1, (uint32_t)((uint64_t)number * periods[level] / periods[level + 1]));
+}
+
+void TimeSeries::add(uint32_t ms, float value) {
+  uint32_t s = seq.load(std::memory_order_relaxed);
+  seq.store(s + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  uint32_t n = word(META_SAMPLES);
+  size_t r = RAW_BASE + (n % SERIES_RAW_SAMPLES) * 2;
+  store(r, ms);
+  storeFloat(r + 1, value);
+  store(META_SAMPLES, n + 1);
+
+  uint32_t number = ms / periods[0];
+  advance(0, number);
+  merge(0, number, value, value, value, 1);
+
+  seq.store(s + 2, std::memory_order_release);
+}
+
+// -------- Readers --------
+size_t TimeSeries::tryRead(SeriesResolution res, SeriesPoint* out, size_t maxPoints, bool& ok) const {
+  ok = false;
+  uint32_t s1 = seq.load(std::memory_order_acquire);
+  if (s1 & 1u) return 0;
+
+  size_t n = 0;
+  if (res == SERIES_RAW) {
+    uint32_t total = word(META_SAMPLES);
+    n = total < SERIES_RAW_SAMPLES ? total : SERIES_RAW_SAMPLES;
+    if (n > maxPoints) n = maxPoints;
+    for (size_t i = 0; i < n; i++) {
+      size_t r = RAW_BASE + ((total - n + i) % SERIES_RAW_SAMPLES) * 2;
+      float v = floatWord(r + 1);
+      out[i].startMs = word(r);
+      out[i].min = v;
+      out[i].max = v;
+      out[i].mean = v;
+      out[i].count = 1;
+    }
+  } else if (res < SERIES_RESOLUTION_COUNT) {
+    uint8_t level = res - SERIES_SECONDS;
+    uint32_t open = word(META_LEVEL + level * 2);
+    n = word(META_LEVEL + level * 2 + 1);
+    if (n > maxPoints) n = maxPoints;
+    for (size_t i = 0; i < n; i++) {
+      uint32_t number = open - (uint32_t)(n - 1 - i);
+      size_t b = bucketWord(level, number);
+      float sum = floatWord(b + 2);
+      out[i].startMs = number * periods[level];
+      out[i].min = floatWord(b + 0);
+      out[i].max = floatWord(b + 1);
+      out[i].count = word(b + 3);
+      // The open bucket has not received the lower levels' open buckets yet
+      if (i == n - 1) {
+        for (uint8_t lower = 0; lower < level; lower++) {
+          size_t lb = bucketWord(lower, word(META_LEVEL + lower * 2));
+          uint32_t c = word(lb + 3);
+          if (c == 0) continue;
+          float lmin = floatWord(lb + 0), lmax = floatWord(lb + 1);
+          if (out[i].count == 0 || lmin < out[i].min) out[i].min = lmin;
+          if (out[i].count == 0 || lmax > out[i].max) out[i].max = lmax;
+          sum += floatWord(lb + 2);
+          out[i].count += c;
+        }
+      }
+      out[i].mean = out[i].count ? sum / out[i].count : 0;
+    }
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  ok = seq.load(std::memory_order_relaxed) == s1;
+  return n;
+}
+
+size_t TimeSeries::read(SeriesResolution res, SeriesPoint* out, size_t maxPoints) const {
+  for (int attempts = 8; attempts > 0; attempts--) {
+    bool ok;
+    size_t n = tryRead(res, out, maxPoints, ok);
+    if (ok) return n;
+  }
+  return 0;
+}
+
+// -------- Telemetry fields --------
+TelemetryHistory::TelemetryHistory(uint32_t fields) : count(0), mask(0) {
+  for (uint8_t f = 0; f < TEL_FIELD_COUNT && count < SERIES_MAX_FIELDS; f++) {
+    if (!((fields >> f) & 1u) || telemetryFields[f].kind != TEL_KIND_FLOAT) continue;
+    fieldOf[count++] = f;
+    mask |= 1u << f;
+  }
+}
+
+void TelemetryHistory::record(uint32_t ms, const TelemetryFrame& frame) {
+  for (uint8_t i = 0; i < count; i++) {
+    TelemetryField f = (TelemetryField)fieldOf[i];
+    if (frame.has(f)) store[i].add(ms, frame.getFloat(f));
+  }
+}
+
+const TimeSeries* TelemetryHistory::series(TelemetryField f) const {
+  for (uint8_t i = 0; i < count; i++) {
+    if (fieldOf[i] == f) return &store[i];
+  }
+  return nullptr;
+}
+
+void TelemetryHistory::printBudget(Print& out) const {
+  out.printf("History: %u field(s) x %u B = %u B static (%u raw samples, %u x 1 s, %u x 1 min, %u x 1 h buckets; %u slot(s) unused, %u B)\n",
+             count, (unsigned)sizeof(TimeSeries), (unsigned)(count * sizeof(TimeSeries)), SERIES_RAW_SAMPLES,
+             SERIES_SECOND_BUCKETS, SERIES_MINUTE_BUCKETS, SERIES_HOUR_BUCKETS, SERIES_MAX_FIELDS - count,
+             (unsigned)((SERIES_MAX_FIELDS - count) * sizeof(TimeSeries)));
+}
+
+// -------- JSON --------
+void writeSeriesJson(JsonWriter& w, const char* field, const TimeSeries& series, SeriesResolution res,
+                     SeriesPoint* points, size_t maxPoints, uint32_t nowMs) {
+  size_t n = series.read(res, points, maxPoints);
+
+  w.beginObject();
+  w.key("field");
+  w.value(field);
+  w.key("res");
+  w.value(seriesResolutionName(res));
+  w.key("period_ms");
+  w.value((unsigned int)seriesPeriodMs(res));
+  w.key("now_ms");
+  w.value((unsigned int)nowMs);
+  w.key("points");
+  w.beginArray();
+  for (size_t i = 0; i < n; i++) {
+    const SeriesPoint& p = points[i];
+    w.item();
+    w.beginArray();
+    w.item();
+    w.value((unsigned int)p.startMs);
+    if (p.count) {
+      w.item();
+      w.value(p.min);
+      w.item();
+      w.value(p.max);
+      w.item();
+      w.value(p.mean);
+    } else {
+      w.item();
+      w.null();
+      w.item();
+      w.null();
+      w.item();
+      w.null();
+    }
+    w.item();
+    w.value((unsigned int)p.count);
+    w.endArray();
+  }
+  w.endArray();
+  w.endObject();
+}
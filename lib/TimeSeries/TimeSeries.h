@@ -0,0 +1,127 @@
+#ifndef TIME_SERIES_H
+#define TIME_SERIES_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Telemetry.h"
+#include "JsonWriter.h"
+
+// Fixed-memory history of one value: the latest raw samples plus 1 s, 1 min
+// and 1 h buckets of min/max/mean/count. A sample updates the raw ring and the
+// open 1 s bucket; a bucket that closes is folded into the open bucket one level
+// up, so each level is maintained incrementally and readers get any resolution
+// without rescanning samples.
+//
+// One writer (the sensor task), any number of readers on other tasks: the
+// storage is relaxed atomic words behind a sequence counter, as in Seqlock.h,
+// and read() retries if the writer raced it.
+
+#define SERIES_RAW_SAMPLES 32
+#define SERIES_SECOND_BUCKETS 60 // last minute
+#define SERIES_MINUTE_BUCKETS 60 // last hour
+#define SERIES_HOUR_BUCKETS 24   // last day
+#define SERIES_MAX_FIELDS 7      // series per TelemetryHistory (temp + the six mux sensors)
+#define SERIES_MAX_POINTS 60     // largest ring, i.e. enough for any read()
+
+enum SeriesResolution : uint8_t {
+  SERIES_RAW,
+  SERIES_SECONDS,
+  SERIES_MINUTES,
+  SERIES_HOURS,
+  SERIES_RESOLUTION_COUNT
+};
+
+struct SeriesPoint {
+  uint32_t startMs; // sample time, or start of the bucket's period (millis())
+  float min;
+  float max;
+  float mean;
+  uint32_t count;   // samples in the bucket; 0 = none in that period
+};
+
+// "raw", "1s", "1m", "1h"
+const char* seriesResolutionName(SeriesResolution res);
+bool parseSeriesResolution(const char* name, SeriesResolution& out);
+uint32_t seriesPeriodMs(SeriesResolution res); // 0 for raw
+
+class TimeSeries {
+public:
+  TimeSeries();
+
+  // Writer only. Timestamps must not go backwards.
+  void add(uint32_t ms, float value);
+
+  // Oldest first, at most maxPoints of the newest. For bucket resolutions the
+  // last point is the period still open (partial). Returns the point count, 0
+  // if there is nothing yet or the writer kept racing us.
+  size_t read(SeriesResolution res, SeriesPoint* out, size_t maxPoints) const;
+
+  // Samples added since start
+  uint32_t samples() const { return words[META_SAMPLES].load(std::memory_order_relaxed); }
+
+private:
+  static const uint8_t LEVELS = 3;
+  static const size_t BUCKET_WORDS = 4; // min, max, sum, count
+  static const size_t RAW_BASE = 0;
+  static const size_t BUCKET_BASE = RAW_BASE + SERIES_RAW_SAMPLES * 2;
+  static const size_t BUCKET_COUNT = SERIES_SECOND_BUCKETS + SERIES_MINUTE_BUCKETS + SERIES_HOUR_BUCKETS;
+  static const size_t META_SAMPLES = BUCKET_BASE + BUCKET_COUNT * BUCKET_WORDS;
+  static const size_t META_LEVEL = META_SAMPLES + 1; // per level: open bucket number, buckets held
+  static const size_t WORD_COUNT = META_LEVEL + LEVELS * 2;
+
+  static const uint32_t periods[LEVELS];
+  static const uint16_t sizes[LEVELS];
+  static const uint16_t offsets[LEVELS];
+
+  void advance(uint8_t level, uint32_t number);
+  void merge(uint8_t level, uint32_t number, float min, float max, float sum, uint32_t count);
+  void clearBucket(uint8_t level, uint32_t number);
+  size_t bucketWord(uint8_t level, uint32_t number) const {
+    return BUCKET_BASE + (offsets[level] + number % sizes[level]) * BUCKET_WORDS;
+  }
+
+  uint32_t word(size_t i) const { return words[i].load(std::memory_order_relaxed); }
+  float floatWord(size_t i) const;
+  void store(size_t i, uint32_t v) { words[i].store(v, std::memory_order_relaxed); }
+  void storeFloat(size_t i, float v);
+
+  size_t tryRead(SeriesResolution res, SeriesPoint* out, size_t maxPoints, bool& ok) const;
+
+  std::atomic<uint32_t> seq;
+  std::atomic<uint32_t> words[WORD_COUNT];
+  // Writer's own copy of the level state
+  uint32_t openNumber[LEVELS];
+  uint16_t held[LEVELS];
+};
+
+// One TimeSeries per float telemetry field, fed a whole frame at a time
+class TelemetryHistory {
+public:
+  // Keeps the float fields in the mask (the first SERIES_MAX_FIELDS of them)
+  explicit TelemetryHistory(uint32_t fields);
+
+  // Adds every kept field the frame has. Writer only.
+  void record(uint32_t ms, const TelemetryFrame& frame);
+
+  // nullptr if the field is not kept
+  const TimeSeries* series(TelemetryField f) const;
+  uint32_t fields() const { return mask; }
+
+  // Static memory of the whole history, and a breakdown of it
+  size_t bytes() const { return sizeof(*this); }
+  void printBudget(Print& out) const;
+
+private:
+  TimeSeries store[SERIES_MAX_FIELDS];
+  uint8_t fieldOf[SERIES_MAX_FIELDS];
+  uint8_t count;
+  uint32_t mask;
+};
+
+// {"field":"b_v","res":"1m","period_ms":60000,"now_ms":...,"points":[[start_ms,min,max,mean,count],...]}
+// points is scratch for up to maxPoints readings
+void writeSeriesJson(JsonWriter& w, const char* field, const TimeSeries& series, SeriesResolution res,
+                     SeriesPoint* points, size_t maxPoints, uint32_t nowMs);
+
+#endif // TIME_SERIES_H
@@ -0,0 +1,1582 @@
+// Host benchmarks for the hot paths in lib/. Build and run with
+//   pio run -e native && .pio/build/native/program [filter] [--trace=<file>] [--replay=<file>]
+// Each case prints ns/op and heap allocations per op. Cases that must not
+// touch the heap fail the run (exit code 1) if they start allocating.
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "Telemetry.h"
+#include "TelemetryCbor.h"
+#include "Seqlock.h"
+#include "CommandDispatcher.h"
+#include "SensorMath.h"
+#include "GsmClient.h"
+#include "AdcSampler.h"
+#include "SyntheticAdcHal.h"
+#include "Calibration.h"
+#include "SensorMonitor.h"
+#include "ReplaySensorHal.h"
+#include "TimeSeries.h"
+#include "RecordLog.h"
+#include "FileFlashPartition.h"
+#include "EnergyMeter.h"
+#include "BurstCapture.h"
+#include "BurstWatcher.h"
+#include "SpscQueue.h"
+#include "Profiler.h"
+#include "MqttPacket.h"
+
+#define BENCH_MIN_TIME_MS 200
+#define ALLOCS_ANY -1.0
+
+typedef void (*BenchFn)(uint32_t iterations);
+
+struct BenchCase {
+  const char* name;
+  BenchFn run;
+  double maxAllocsPerOp; // ALLOCS_ANY = not checked
+};
+
+// Results are folded into this so the optimizer cannot drop the work
+static volatile uint32_t sink;
+
+// -------- Fixtures --------
+static TelemetryFrame frame;
+static uint8_t cborBuf[128];
+static size_t cborLen;
+
+static const char commandPayload[] = "{\"cmd\":\"interval\",\"ms\":10000,\"note\":\"bench\",\"flags\":[1,2,3]}";
+
+static void fillFixtures() {
+  // Same content the firmware publishes every cycle
+  frame.set<TEL_TEMP>(74.25f);
+  frame.set<TEL_FAN_STATE>(true);
+  frame.set<TEL_B_V>(12.61f);
+  frame.set<TEL_B_C>(1.37f);
+  frame.set<TEL_T_V>(5.82f);
+  frame.set<TEL_T_C>(0.44f);
+  frame.set<TEL_C_V>(13.9f);
+  frame.set<TEL_C_C>(0.91f);
+  frame.set<TEL_UPTIME>(86400);
+  frame.set<TEL_ACTIVE_CONN>(0);
+  frame.set<TEL_SIG_RSSI>(-67);
+  frame.set<TEL_BLE_STATUS>(false);
+  frame.set<TEL_IP>(makeTelemetryIp(192, 168, 1, 42));
+  frame.set<TEL_VER>(makeTelemetryText("1.4.2"));
+
+  encodeTelemetryCbor(frame, cborBuf, sizeof(cborBuf), &cborLen);
+}
+
+// Behaviour checks run before the timings; any failure fails the run
+static bool check(bool ok, const char* what) {
+  if (!ok) printf("FAIL: %s\n", what);
+  return ok;
+}
+
+// -------- Serialization --------
+// Payload size on the cellular link: the fixture as a keyframe, and as the
+// delta of a typical publish (temperature, two currents and the uptime moved)
+static bool payloadSizes(const char* name, const TelemetryFrame& f, uint32_t fields) {
+  char text[256];
+  uint8_t binary[128];
+  size_t jsonLen = 0, binaryLen = 0;
+  bool fits = f.serialize(text, sizeof(text), &jsonLen, fields);
+  fits &= encodeTelemetryCbor(f, binary, sizeof(binary), &binaryLen, fields);
+  printf("  %s: %u fields, JSON %u B, CBOR %u B, %.2fx\n", name, (unsigned)__builtin_popcount(fields & f.present),
+         (unsigned)jsonLen, (unsigned)binaryLen, (double)jsonLen / binaryLen);
+  return fits && jsonLen >= 3 * binaryLen;
+}
+
+// Every schema field at its widest, as the largest keyframe the firmware may
+// have to publish in one piece
+static TelemetryFrame widestFrame() {
+  TelemetryFrame f;
+  for (uint8_t i = 0; i < TEL_FIELD_COUNT; i++) {
+    if (telemetryFields[i].kind == TEL_KIND_FLOAT) f.setFloat((TelemetryField)i, -99999.999f);
+  }
+  f.set<TEL_FAN_STATE>(false);
+  f.set<TEL_BLE_STATUS>(false);
+  f.set<TEL_UPTIME>(0xFFFFFFFFu);
+  f.set<TEL_ACTIVE_CONN>(INT32_MIN);
+  f.set<TEL_SIG_RSSI>(INT32_MIN);
+  f.set<TEL_TC_STATUS>(INT32_MIN);
+  f.set<TEL_IP>(makeTelemetryIp(255, 255, 255, 255));
+  f.set<TEL_VER>(makeTelemetryText("12345678901"));
+  return f;
+}
+
+static bool reportPayloadSize() {
+  TelemetryFrame delta = frame;
+  uint32_t since = delta.epoch;
+  delta.set<TEL_TEMP>(74.5f);
+  delta.set<TEL_B_C>(1.41f);
+  delta.set<TEL_T_C>(0.45f);
+  delta.set<TEL_UPTIME>(86405);
+  printf("payload size:\n");
+  bool ok = check(payloadSizes("full frame", frame, TEL_ALL_FIELDS), "payload size: CBOR full frame not 3x smaller");
+  ok &= check(payloadSizes("delta", delta, delta.changedSince(since)), "payload size: CBOR delta not 3x smaller");
+
+  // Published through PubSubClient's buffer, which the firmware sizes for
+  // TELEMETRY_PAYLOAD_MAX on its longest telemetry topic
+  TelemetryFrame widest = widestFrame();
+  static char text[TELEMETRY_PAYLOAD_MAX + 64];
+  size_t jsonLen = 0;
+  bool fits = widest.serialize(text, sizeof(text), &jsonLen);
+  size_t packet = mqttPacketSize("cleanenv/stdout", jsonLen);
+  size_t buffer = mqttPacketSize("cleanenv/stdout", TELEMETRY_PAYLOAD_MAX);
+  printf("  every field at its widest: %u fields, JSON %u B, %u B packet on cleanenv/stdout, client buffer %u B\n",
+         (unsigned)__builtin_popcount(widest.present), (unsigned)jsonLen, (unsigned)packet, (unsigned)buffer);
+  ok &= check(widest.present == (uint32_t)((1ull << TEL_FIELD_COUNT) - 1), "payload size: the widest frame misses a field");
+  ok &= check(fits && jsonLen <= TELEMETRY_PAYLOAD_MAX && packet <= buffer,
+              "payload size: a full JSON keyframe does not fit the MQTT client buffer");
+  return ok;
+}
+
+static void benchTelemetryJson(uint32_t n) {
+  char buf[256];
+  size_t len = 0;
+  while (n--) {
+    frame.serialize(buf, sizeof(buf), &len);
+    sink += len;
+  }
+}
+
+static void benchTelemetryCbor(uint32_t n) {
+  uint8_t buf[128];
+  size_t len = 0;
+  while (n--) {
+    encodeTelemetryCbor(frame, buf, sizeof(buf), &len);
+    sink += len;
+  }
+}
+
+// -------- Float formatting --------
+// Spread of magnitudes and signs like a sensor sweep
+static const float formatInputs[8] = { 74.25f, 12.61f, -0.004f, 0.91f, 13.9f, 5.82f, 1023.456f, -3.3f };
+
+static void benchFormatDtostrf(uint32_t n) {
+  char buf[FIXED_FORMAT_SIZE];
+  while (n--) sink += (uint8_t)dtostrf(formatInputs[n & 7], 4, 2, buf)[1];
+}
+
+static void benchFormatSnprintf(uint32_t n) {
+  char buf[FIXED_FORMAT_SIZE];
+  while (n--) sink += snprintf(buf, sizeof(buf), "%.2f", formatInputs[n & 7]);
+}
+
+static void benchFormatFixed(uint32_t n) {
+  char buf[FIXED_FORMAT_SIZE];
+  while (n--) sink += formatFixed(buf, formatInputs[n & 7], 2);
+}
+
+static void benchLcdLine(uint32_t n) {
+  static const TelemetryLcdCell cells[] = {
+    {TEL_TEMP, "T:", "C", 1},
+    {TEL_B_V, " V:", "V", 2},
+    {TEL_B_C, " I:", "A", 2},
+  };
+  char line[21];
+  while (n--) sink += renderTelemetryLine(frame, cells, 3, line, sizeof(line));
+}
+
+// -------- Lookup --------
+static void benchLookupTyped(uint32_t n) {
+  while (n--) sink += (uint32_t)frame.get<TEL_C_C>();
+}
+
+// -------- Parsing --------
+static void benchTokenize(uint32_t n) {
+  JsonToken tokens[COMMAND_MAX_TOKENS];
+  while (n--) sink += jsonTokenize(commandPayload, sizeof(commandPayload) - 1, tokens, COMMAND_MAX_TOKENS);
+}
+
+static bool handleInterval(const JsonView& args) {
+  long ms;
+  return args.getInt("ms", ms);
+}
+
+static const CommandHandler benchHandlers[] = {
+  {"fan", nullptr},
+  {"snapshot", nullptr},
+  {"interval", handleInterval},
+};
+
+static void benchDispatch(uint32_t n) {
+  while (n--) sink += dispatchCommand(commandPayload, sizeof(commandPayload) - 1, benchHandlers, 3);
+}
+
+// -------- Command fuzzing --------
+
+static const uint32_t FUZZ_RUNS = 200000;
+
+static const char* const fuzzSeeds[] = {
+  commandPayload,
+  "{\"cmd\":\"fan\",\"on\":true}",
+  "{\"cmd\":\"snapshot\"}",
+  "{\"cmd\":\"cal\",\"ch\":1,\"value\":2.5e-1}",
+  "{\"cmd\":\"sensor\",\"ch\":3,\"field\":\"v_b\",\"filter\":\"median\",\"period_ms\":10}",
+  "{\"cmd\":\"burst\",\"ch\":1,\"above\":1450,\"slope\":-160,\"off\":false}",
+  "{\"cmd\":\"energy\",\"reset\":null,\"x\":{\"a\":[[],{},\"\\u00e9\\\"\"]}}",
+};
+
+// Bytes a mutation favours: the ones the grammar turns on
+static const char fuzzAlphabet[] = "{}[]\":,\\ -.0123456789eEtrufalsn";
+
+static uint32_t fuzzState = 0x9E3779B9u;
+
+static uint32_t fuzzRandom() {
+  fuzzState ^= fuzzState << 13;
+  fuzzState ^= fuzzState >> 17;
+  fuzzState ^= fuzzState << 5;
+  return fuzzState;
+}
+
+// The payload being dispatched, for the handler's bounds checks
+static const char* fuzzPayload;
+static size_t fuzzLength;
+static uint32_t fuzzViolations;
+
+// Reads every argument the real handlers ask for, in every type
+static bool handleFuzz(const JsonView& args) {
+  static const char* const keys[] = {"cmd", "ms", "ch", "value", "note", "on", "x", "field", "above", ""};
+  for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+    const char* str;
+    size_t length;
+    long l;
+    float f;
+    bool b;
+    if (args.getString(keys[k], str, length) &&
+        (str < fuzzPayload || str + length > fuzzPayload + fuzzLength)) {
+      fuzzViolations++;
+    }
+    int tok = args.find(keys[k]);
+    sink += args.getInt(keys[k], l) + args.getFloat(keys[k], f) + args.getBool(keys[k], b);
+    sink += args.toInt(tok, l) + args.toFloat(tok, f) + args.isString(tok, "fan");
+  }
+  return true;
+}
+
+static const CommandHandler fuzzHandlers[] = {
+  {"interval", handleFuzz}, {"fan", handleFuzz}, {"snapshot", handleFuzz}, {"cal", handleFuzz},
+  {"sensor", handleFuzz},   {"burst", handleFuzz}, {"energy", handleFuzz},
+};
+
+// A successful tokenization must describe a well-formed tree inside the input
+static bool fuzzTokensValid(const char* js, size_t length, const JsonToken* tokens, int count) {
+  if (tokens[0].parent != -1) return false;
+  uint16_t children[COMMAND_MAX_TOKENS] = {};
+  for (int i = 0; i < count; i++) {
+    const JsonToken& t = tokens[i];
+    if (t.start > t.end || t.end > length) return false;
+    if (i > 0 && (t.parent < 0 || t.parent >= i)) return false;
+    if (t.parent >= 0) {
+      const JsonToken& p = tokens[t.parent];
+      if (p.type != JSON_TOK_OBJECT && p.type != JSON_TOK_ARRAY) return false;
+      if (t.start < p.start || t.end > p.end) return false;
+      children[t.parent]++;
+    }
+    switch (t.type) {
+      case JSON_TOK_OBJECT:
+      case JSON_TOK_ARRAY:
+        if (t.end < t.start + 2 || js[t.start] != (t.type == JSON_TOK_OBJECT ? '{' : '[') ||
+            js[t.end - 1] != (t.type == JSON_TOK_OBJECT ? '}' : ']')) {
+          return false;
+        }
+        break;
+      case JSON_TOK_STRING:
+        if (t.start < 1 || t.end >= length || js[t.start - 1] != '"' || js[t.end] != '"') return false;
+        break;
+      case JSON_TOK_PRIMITIVE:
+        if (t.end == t.start) return false;
+        break;
+      default:
+        return false;
+    }
+  }
+  // An object's children are its keys and their values; its size counts the keys
+  for (int i = 0; i < count; i++) {
+    if (tokens[i].type == JSON_TOK_OBJECT && (children[i] % 2 || tokens[i].size != children[i] / 2)) return false;
+    if (tokens[i].type == JSON_TOK_ARRAY && tokens[i].size != children[i]) return false;
+  }
+  return true;
+}
+
+// Random, truncated and mutated commands through the tokenizer and the
+// dispatcher. Each payload sits in a heap block of its exact size, so a run
+// under -fsanitize=address also catches a read past its end.
+static bool checkCommandFuzz() {
+  uint32_t parsed = 0, rejected = 0, mismatches = 0;
+  fuzzViolations = 0;
+  char work[160];
+  for (uint32_t run = 0; run < FUZZ_RUNS; run++) {
+    size_t length;
+    uint32_t kind = fuzzRandom() % 4;
+    if (kind == 0) {
+      length = fuzzRandom() % 64; // noise
+      for (size_t i = 0; i < length; i++) {
+        work[i] = fuzzRandom() % 2 ? fuzzAlphabet[fuzzRandom() % (sizeof(fuzzAlphabet) - 1)] : (char)fuzzRandom();
+      }
+    } else {
+      const char* seed = fuzzSeeds[fuzzRandom() % (sizeof(fuzzSeeds) / sizeof(fuzzSeeds[0]))];
+      length = strlen(seed);
+      memcpy(work, seed, length);
+      if (kind == 1) {
+        length = fuzzRandom() % (length + 1); // truncated
+      } else {
+        for (uint32_t edits = 1 + fuzzRandom() % 4; edits > 0; edits--) {
+          size_t at = length ? fuzzRandom() % length : 0;
+          char c = fuzzRandom() % 4 ? fuzzAlphabet[fuzzRandom() % (sizeof(fuzzAlphabet) - 1)] : (char)fuzzRandom();
+          uint32_t op = fuzzRandom() % 3;
+          if (op == 0 && length) {
+            work[at] = c;
+          } else if (op == 1 && length < sizeof(work)) {
+            memmove(work + at + 1, work + at, length - at);
+            work[at] = c;
+            length++;
+          } else if (length) {
+            memmove(work + at, work + at + 1, length - at - 1);
+            length--;
+          }
+        }
+      }
+    }
+
+    char* payload = (char*)malloc(length ? length : 1);
+    memcpy(payload, work, length);
+    JsonToken tokens[COMMAND_MAX_TOKENS];
+    int maxTokens = 1 + fuzzRandom() % COMMAND_MAX_TOKENS;
+    int count = jsonTokenize(payload, length, tokens, maxTokens);
+    if (count > 0) {
+      if (count > maxTokens || !fuzzTokensValid(payload, length, tokens, count)) fuzzViolations++;
+    } else if (count != JSON_ERROR_INVALID && count != JSON_ERROR_NOMEM && count != JSON_ERROR_PARTIAL) {
+      fuzzViolations++;
+    }
+
+    fuzzPayload = payload;
+    fuzzLength = length;
+    count = jsonTokenize(payload, length, tokens, COMMAND_MAX_TOKENS);
+    CommandResult result = dispatchCommand(payload, length, fuzzHandlers, sizeof(fuzzHandlers) / sizeof(fuzzHandlers[0]));
+    if (result > CMD_BAD_ARGS || ((count < 1 || tokens[0].type != JSON_TOK_OBJECT) != (result == CMD_PARSE_ERROR))) {
+      mismatches++;
+    }
+    if (result == CMD_PARSE_ERROR) rejected++;
+    else parsed++;
+    free(payload);
+  }
+
+  printf("command fuzz: %u payloads, %u dispatched, %u rejected, %u token violations, %u bad results\n", FUZZ_RUNS,
+         parsed, rejected, fuzzViolations, mismatches);
+  bool ok = check(fuzzViolations == 0, "command fuzz: tokens or arguments outside the payload or malformed");
+  ok &= check(mismatches == 0, "command fuzz: dispatch result disagrees with the tokenizer");
+  return ok;
+}
+
+static void benchCborDecode(uint32_t n) {
+  TelemetryFrame out;
+  while (n--) {
+    out.clear();
+    sink += decodeTelemetryCbor(cborBuf, cborLen, out);
+  }
+}
+
+// Scripted SIM900 on the far end of the modem UART
+static HardwareSerial modemSerial(1);
+
+static void modemReply(HardwareSerial& port, const char* line, void*) {
+  if (strcmp(line, "AT+CSQ") == 0) port.inject("\r\n+CSQ: 17,0\r\n\r\nOK\r\n");
+  else port.inject("\r\nOK\r\n");
+}
+
+static void benchGsmCsq(uint32_t n) {
+  static GsmClient modem(modemSerial);
+  while (n--) {
+    sink += modem.csq();
+    modemSerial.clearTransmitted();
+  }
+}
+
+// -------- Sensors --------
+static void benchSensorMath(uint32_t n) {
+  uint32_t adc = 0;
+  while (n--) {
+    adc = (adc + 97) & 0xFFF;
+    float v = sensorVoltage((float)adc) + sensorCurrent((float)adc, (int)(adc & 7));
+    sink += (uint32_t)v;
+  }
+}
+
+// -------- Filters --------
+// Raw conversions of one channel, replayed through the filter chains. Load a
+// recorded trace with --trace=<file> (one 12-bit sample per line); otherwise an
+// ACS712-like channel is synthesized: 0 A offset, 50 Hz ripple, noise, spikes.
+#define TRACE_MAX 65536
+static uint16_t trace[TRACE_MAX];
+static size_t traceLen;
+static const char* traceSource = "synthetic ACS712";
+
+static bool loadTrace(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+  unsigned int v;
+  traceLen = 0;
+  while (traceLen < TRACE_MAX && fscanf(f, "%u", &v) == 1) trace[traceLen++] = (uint16_t)(v & 0x0FFF);
+  fclose(f);
+  traceSource = path;
+  return traceLen > 0;
+}
+
+static void synthesizeTrace() {
+  SyntheticAdcHal hal;
+  SyntheticWaveform wave = { 298.0f, 8.0f, 800, 25, 0, 0, 0.0f };
+  hal.setWaveform(0, wave);
+  hal.read(trace, TRACE_MAX, 0);
+  for (size_t i = 97; i < TRACE_MAX; i += 211) trace[i] = (uint16_t)(trace[i] + 600); // switching spikes
+  traceLen = TRACE_MAX;
+}
+
+static const ChannelFilterConfig MEAN_FILTER = { 5, 1, FILTER_IIR_ONE };
+static const ChannelFilterConfig CURRENT_FILTER = { 3, 5, FILTER_ALPHA(0.25) };
+static const ChannelFilterConfig HEAVY_FILTER = { 0, 7, FILTER_ALPHA(0.05) };
+
+// One op = one raw sample, fed in sweep-sized blocks
+static void runFilter(const ChannelFilterConfig& config, uint32_t n) {
+  static ChannelFilter filter;
+  static size_t pos;
+  filter.configure(config);
+  while (n) {
+    size_t k = n < ADC_DEFAULT_OVERSAMPLE ? n : ADC_DEFAULT_OVERSAMPLE;
+    if (pos + k > traceLen) pos = 0;
+    filter.push(trace + pos, k);
+    pos += k;
+    n -= (uint32_t)k;
+    sink += filter.value();
+  }
+}
+
+static void benchFilterMean(uint32_t n) { runFilter(MEAN_FILTER, n); }
+static void benchFilterCurrent(uint32_t n) { runFilter(CURRENT_FILTER, n); }
+static void benchFilterHeavy(uint32_t n) { runFilter(HEAVY_FILTER, n); }
+
+// Spread of one filter's output over the trace, in ADC counts
+static double filterSpread(const ChannelFilterConfig& config) {
+  ChannelFilter filter;
+  filter.configure(config);
+  double sum = 0, sumSq = 0;
+  size_t n = 0;
+  for (size_t pos = 0; pos + ADC_DEFAULT_OVERSAMPLE <= traceLen; pos += ADC_DEFAULT_OVERSAMPLE) {
+    filter.push(trace + pos, ADC_DEFAULT_OVERSAMPLE);
+    if (pos < traceLen / 4) continue; // let the history fill
+    double v = adcCounts(filter.value());
+    sum += v;
+    sumSq += v * v;
+    n++;
+  }
+  double mean = sum / n;
+  return sqrt(sumSq / n - mean * mean);
+}
+
+static bool reportTrace() {
+  ChannelFilterConfig raw = { 0, 1, FILTER_IIR_ONE };
+  double rawSpread = filterSpread(raw), meanSpread = filterSpread(MEAN_FILTER), currentSpread = filterSpread(CURRENT_FILTER);
+  printf("adc trace: %u samples (%s), sweep-to-sweep spread: raw %.2f, mean %.2f, current chain %.2f counts\n",
+         (unsigned int)traceLen, traceSource, rawSpread, meanSpread, currentSpread);
+  return check(meanSpread < rawSpread && currentSpread < rawSpread, "adc trace: a filter chain spreads more than raw");
+}
+
+// Six channels like the built-in registry; reports CPU cost per sweep (the synthetic HAL
+// delivers instantly, the real one is paced by the DMA sample rate)
+static void benchAdcSweep(uint32_t n) {
+  static SyntheticAdcHal hal;
+  static AdcSampler sampler(hal);
+  static bool started = false;
+  if (!started) {
+    static const uint8_t channels[] = {0, 1, 2, 3, 4, 5};
+    for (uint8_t ch = 0; ch < 6; ch++) {
+      SyntheticWaveform wave = { 1200.0f + 300.0f * ch, 40.0f, 800, 12, 0, 0, 0.0f };
+      hal.setWaveform(ch, wave);
+    }
+    started = sampler.begin(channels, 6);
+  }
+  AdcFrame frame;
+  while (n--) {
+    sampler.sweep(frame);
+    sink += frame.value[0];
+  }
+}
+
+// Same six conversions through the compiled tables (built-in curves)
+static void benchCalibrationConvert(uint32_t n) {
+  static CalibrationTables tables;
+  static const uint8_t channels[] = {0, 1, 2, 3, 4, 5};
+  if (tables.tableCount() == 0) {
+    for (uint8_t ch = 0; ch < 6; ch++) tables.set(ch, makeCalibration(ch & 1 ? CAL_DEFAULT_CURRENT : CAL_DEFAULT_VOLTAGE, ch));
+    tables.compile(channels, 6);
+  }
+  uint32_t q4 = 0;
+  while (n--) {
+    q4 = (q4 + 97 * 16 + 5) & 0xFFFF;
+    sink += (uint32_t)tables.convert((uint8_t)(q4 & 7) % 6, (uint16_t)q4);
+  }
+}
+
+// -------- Sensor task --------
+// SensorMonitor (sweep, conversion) and its thermal loop (thermocouple, fan
+// staging) on the replay HAL, each at its own task's pace. Load a trace
+// logged by the board with --replay=<file> (SENSOR_TRACE in Sensors.cpp);
+// otherwise a heat cycle is synthesized at 100 ms resolution: 25 -> 100 -> 40 C
+// over 40 minutes with the TEG output following the temperature, plus a short
+// thermocouple dropout.
+static const SensorRegistry benchRegistry = defaultSensorRegistry();
+
+// The board's six plus the other ten mux channels into aux0-aux9: pin
+// voltages every second, raw counts every 5 s
+static SensorRegistry fullRegistry() {
+  SensorRegistry registry = defaultSensorRegistry();
+  for (uint8_t ch = 6; ch < ADC_MAX_CHANNELS; ch++) {
+    bool raw = ch & 1;
+    SensorConfig sensor = { ch, (uint8_t)(raw ? SENSOR_DECODE_RAW : SENSOR_DECODE_PIN_V), (uint8_t)(TEL_AUX0 + ch - 6),
+                            SENSOR_FILTER_MEAN, (uint16_t)(raw ? 5000 : 1000), 0 };
+    setSensor(registry, sensor);
+  }
+  return registry;
+}
+#define SENSOR_TASK_PERIOD_MS 1000 // monitorSensorsTask's delay
+#define SYNTHETIC_TRACE_STEP_MS 100
+
+static SensorTrace sensorTrace;
+static const char* sensorTraceSource = "synthetic heat cycle";
+
+static void synthesizeSensorTrace() {
+  for (uint32_t ms = 0; ms <= 2400000; ms += SYNTHETIC_TRACE_STEP_MS) {
+    SensorTraceRow row;
+    memset(&row, 0, sizeof(row));
+    row.ms = ms;
+    float s = ms / 1000.0f;
+    float temp = s < 1200 ? 25.0f + 75.0f * s / 1200.0f : 100.0f - 60.0f * (s - 1200) / 1200.0f;
+    row.celsius = (s >= 600 && s < 603) ? NAN : roundf(temp * 4) / 4; // MAX6675 has 0.25 C steps
+    float heat = temp - 25.0f;
+    row.counts[0] = 1750;                           // battery, ~12.6 V
+    row.counts[1] = 650;                            // battery current, ~2 A (82 counts/A)
+    row.counts[2] = (uint16_t)(700 + 12 * heat);     // TEG voltage
+    row.counts[3] = (uint16_t)(180 + 3 * heat);      // TEG current
+    row.counts[4] = (uint16_t)(1800 + ((uint32_t)s / 300) % 2); // charger voltage
+    row.counts[5] = 380;                            // charger current, ~1 A
+    sensorTrace.add(row);
+  }
+}
+
+struct ReplayResult {
+  uint32_t steps, faults, thermalSamples;
+  double wallMs;
+  uint32_t worstLatencyMs; // trace crossing a stage's onC -> that stage's fans on
+  uint32_t stagesReached;
+};
+
+// Whole trace on the virtual clock, the tasks starting phaseMs into it. With
+// thermalTask the thermal loop runs at its conversion rate like
+// monitorThermalTask; without, it is polled once per sensor pass, as the fans
+// were staged before it had a task of its own.
+static ReplayResult runReplay(ReplaySensorHal& replay, bool thermalTask, uint32_t phaseMs, TelemetryFrame& readings) {
+  ReplayResult r;
+  memset(&r, 0, sizeof(r));
+  nativeUseVirtualClock(true);
+  SensorMonitor monitor(replay.hal(), benchRegistry);
+  ThermalLoop& thermal = monitor.thermal();
+  replay.restart();
+  monitor.begin();
+  vTaskDelay(phaseMs / portTICK_PERIOD_MS);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  uint32_t nextStep = millis();
+  while (!replay.finished()) {
+    if (thermalTask) thermal.poll(millis());
+    if ((int32_t)(millis() - nextStep) >= 0) {
+      if (!thermalTask) {
+        while (!thermal.poll(millis())) vTaskDelay(thermal.msUntilSample(millis()) / portTICK_PERIOD_MS);
+      }
+      if (monitor.step(readings)) r.steps++;
+      else r.faults++;
+      nextStep = millis() + SENSOR_TASK_PERIOD_MS;
+    }
+    uint32_t wait = nextStep - millis();
+    if (thermalTask && thermal.msUntilSample(millis()) < wait) wait = thermal.msUntilSample(millis());
+    if ((int32_t)wait > 0) vTaskDelay(wait / portTICK_PERIOD_MS);
+  }
+  r.wallMs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+  r.thermalSamples = thermal.samples();
+  nativeUseVirtualClock(false);
+
+  // Reaction time per stage, on the way up
+  FanControlConfig config = monitor.fans().config();
+  for (uint8_t s = 0; s < config.stageCount; s++) {
+    const FanStage& stage = config.stages[s];
+    uint32_t crossed = 0;
+    bool found = false;
+    for (size_t i = 0; i < sensorTrace.size() && !found; i++) {
+      if (sensorTrace.row(i).celsius >= stage.onC) {
+        crossed = sensorTrace.row(i).ms - sensorTrace.row(0).ms;
+        found = true;
+      }
+    }
+    if (!found) continue;
+    for (size_t i = 0; i < replay.fanChangeCount(); i++) {
+      const ReplaySensorHal::FanChange& c = replay.fanChange(i);
+      if (c.ms >= crossed && (c.mask & stage.mask) == stage.mask) {
+        if (c.ms - crossed > r.worstLatencyMs) r.worstLatencyMs = c.ms - crossed;
+        r.stagesReached++;
+        break;
+      }
+    }
+  }
+  return r;
+}
+
+// What the synthetic heat cycle must do to the fans, in order: the dropout at
+// 600 s puts them to the top stage, which holds for its minimum time and then
+// steps straight down (the trace is at ~62 C, below stage 1's offC); stage 1
+// at 80 C and all fans at 90 C on the way up; back to stage 1 below 85 C and
+// off below 70 C on the way down.
+enum FanExpect { FAN_ON_FAULT, FAN_ABOVE, FAN_BELOW };
+
+struct FanStep {
+  FanExpect when;
+  float celsius;
+  uint8_t mask;
+};
+
+static const FanStep heatCycleFans[] = {
+  {FAN_ON_FAULT, 0.0f, ALL_FANS},
+  {FAN_BELOW, FAN_STAGE_1_OFF, 0x00},
+  {FAN_ABOVE, FAN_STAGE_1_ON, STAGE_1_FANS},
+  {FAN_ABOVE, FAN_STAGE_2_ON, ALL_FANS},
+  {FAN_BELOW, FAN_STAGE_2_OFF, STAGE_1_FANS},
+  {FAN_BELOW, FAN_STAGE_1_OFF, 0x00},
+};
+
+// First trace time at or after fromMs where the step's condition holds
+static bool fanStepDue(const FanStep& step, uint32_t fromMs, uint32_t& dueMs) {
+  uint32_t origin = sensorTrace.row(0).ms;
+  for (size_t i = 0; i < sensorTrace.size(); i++) {
+    uint32_t ms = sensorTrace.row(i).ms - origin;
+    float c = sensorTrace.row(i).celsius;
+    if (ms < fromMs) continue;
+    bool due = step.when == FAN_ON_FAULT ? std::isnan(c)
+             : step.when == FAN_ABOVE    ? c >= step.celsius
+                                         : c < step.celsius;
+    if (due) {
+      dueMs = ms;
+      return true;
+    }
+  }
+  return false;
+}
+
+// The replay's fan changes against heatCycleFans: same masks in the same
+// order, none before its condition holds (or, stepping down, before the
+// stage before it has run FAN_MIN_HOLD_MS) and none later than one
+// conversion after, or THERMAL_FAULT_LIMIT conversions for a fault
+static bool fanSequenceValid(const ReplaySensorHal& replay, uint32_t& worstMs) {
+  const size_t steps = sizeof(heatCycleFans) / sizeof(heatCycleFans[0]);
+  if (replay.fanChangeCount() != steps + 1 || replay.fanChange(0).mask != 0x00) return false; // begin(): off
+  uint32_t previous = replay.fanChange(0).ms;
+  for (size_t i = 0; i < steps; i++) {
+    const FanStep& step = heatCycleFans[i];
+    const ReplaySensorHal::FanChange& c = replay.fanChange(i + 1);
+    uint32_t due;
+    if (c.mask != step.mask || !fanStepDue(step, previous, due)) return false;
+    if (step.when == FAN_BELOW && due < previous + FAN_MIN_HOLD_MS) due = previous + FAN_MIN_HOLD_MS;
+    uint32_t bound = step.when == FAN_ON_FAULT ? THERMAL_FAULT_LIMIT * THERMO_CONVERSION_MS : THERMO_CONVERSION_MS;
+    if (c.ms < due || c.ms - due > bound) return false;
+    if (step.when != FAN_ON_FAULT && c.ms - due > worstMs) worstMs = c.ms - due;
+    previous = c.ms;
+  }
+  return true;
+}
+
+// Reaction times depend on where the samples fall against the trace, so the
+// worst case is taken over start phases a tenth of the sensor period apart
+static bool reportReplay() {
+  bool synthetic = strcmp(sensorTraceSource, "synthetic heat cycle") == 0;
+  bool sequenceOk = true;
+  uint32_t worstStep = 0;
+  TelemetryFrame readings;
+  uint32_t worst[2] = {0, 0};
+  for (uint32_t phase = 0; phase < SENSOR_TASK_PERIOD_MS; phase += SENSOR_TASK_PERIOD_MS / 10) {
+    for (int thermalTask = 0; thermalTask < 2; thermalTask++) {
+      ReplaySensorHal run(sensorTrace, 12);
+      ReplayResult p = runReplay(run, thermalTask, phase, readings);
+      if (p.worstLatencyMs > worst[thermalTask]) worst[thermalTask] = p.worstLatencyMs;
+      if (thermalTask && synthetic) sequenceOk &= fanSequenceValid(run, worstStep);
+    }
+  }
+  ReplaySensorHal replay(sensorTrace, 12);
+  ReplayResult r = runReplay(replay, true, 0, readings);
+
+  printf("sensor replay: %u rows (%s), %u readings (%u without a temperature), %u thermal samples over %.1f min "
+         "in %.1f ms (%.0fx real time)\n",
+         (unsigned int)sensorTrace.size(), sensorTraceSource, r.steps + r.faults, r.faults, r.thermalSamples,
+         replay.elapsedMs() / 60000.0, r.wallMs, replay.elapsedMs() / r.wallMs);
+  printf("  fans:");
+  for (size_t i = 0; i < replay.fanChangeCount(); i++) {
+    const ReplaySensorHal::FanChange& c = replay.fanChange(i);
+    printf(" %.1fs=0x%02X", c.ms / 1000.0, c.mask);
+  }
+  printf("\n  fan reaction (worst over %u stages, 10 phases): %u ms on the thermal task, %u ms at the sensor task's pace\n",
+         r.stagesReached, worst[1], worst[0]);
+  printf("  last: temp %.2f, b_v %.2f, b_c %.2f, t_v %.2f, t_c %.2f\n", readings.temp, readings.b_v, readings.b_c,
+         readings.t_v, readings.t_c);
+  if (synthetic) printf("  fan sequence: worst %u ms behind the trace over 10 phases\n", worstStep);
+  bool ok = check(r.stagesReached > 0, "sensor replay: no fan stage engaged");
+  ok &= check(worst[1] <= THERMO_CONVERSION_MS, "sensor replay: the thermal task reacts later than one conversion");
+  ok &= check(sequenceOk, "sensor replay: fan sequence, hysteresis or min-hold differs from the heat cycle's");
+  return ok;
+}
+
+// Select-line transitions per sweep in channel order vs the Gray order
+// SensorMonitor sweeps in
+static bool reportSweepOrder(const char* name, const SensorRegistry& registry) {
+  uint8_t natural[SENSOR_MAX], gray[SENSOR_MAX], order[SENSOR_MAX];
+  uint8_t count = sensorSweepOrder(registry, order);
+  for (uint8_t i = 0; i < count; i++) {
+    natural[i] = registry.sensors[i].channel;
+    gray[i] = registry.sensors[order[i]].channel;
+  }
+  std::sort(natural, natural + count);
+  uint32_t naturalToggles = muxSelectToggles(natural, count), grayToggles = muxSelectToggles(gray, count);
+  printf("  %s: %u channels, %u select-line toggles per sweep in channel order, %u in Gray order:", name, count,
+         naturalToggles, grayToggles);
+  for (uint8_t i = 0; i < count; i++) printf(" %u", gray[i]);
+  printf("\n");
+  return check(grayToggles <= naturalToggles, "sweep order: Gray order toggles more select lines than channel order");
+}
+
+// The same 16 channels with the currents at 100 Hz and the board's voltages
+// at 10 Hz
+static SensorRegistry multiRateRegistry() {
+  SensorRegistry registry = fullRegistry();
+  for (uint8_t i = 0; i < registry.count; i++) {
+    SensorConfig& s = registry.sensors[i];
+    if (s.channel < 6) s.periodMs = s.decoder == SENSOR_DECODE_CURRENT ? 10 : 100;
+  }
+  return registry;
+}
+
+// The scheduler alone against a modelled ADC: every channel costs its
+// measured sweep time, and the task wakes on 1 ms ticks. Returns the runs
+// missed over all periods.
+static uint32_t reportSchedule(const char* name, const SensorRegistry& registry, uint32_t costUs) {
+  uint8_t order[SENSOR_MAX];
+  SensorConfig slots[SENSOR_MAX];
+  uint8_t count = sensorSweepOrder(registry, order);
+  for (uint8_t i = 0; i < count; i++) slots[i] = registry.sensors[order[i]];
+  SensorScheduler schedule;
+  schedule.reset(slots, count);
+
+  uint32_t now = 0, busy = 0, sweeps = 0;
+  const uint32_t duration = 60000000;
+  while (now < duration) {
+    uint16_t due = schedule.due(now);
+    if (due) {
+      uint32_t sweep = __builtin_popcount(due) * costUs;
+      schedule.completed(due, now, now + sweep);
+      now += sweep;
+      busy += sweep;
+      sweeps++;
+      continue;
+    }
+    now += (schedule.usUntilDue(now) + 999) / 1000 * 1000;
+  }
+
+  printf("  %s: %u sweeps/s, ADC busy %.1f %%;", name, sweeps / (duration / 1000000), 100.0 * busy / duration);
+  uint16_t periods[SENSOR_MAX];
+  uint8_t classes = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    bool seen = false;
+    for (uint8_t c = 0; c < classes; c++) seen |= periods[c] == slots[i].periodMs;
+    if (!seen) periods[classes++] = slots[i].periodMs;
+  }
+  std::sort(periods, periods + classes);
+  uint32_t missedTotal = 0;
+  for (uint8_t c = 0; c < classes; c++) {
+    uint32_t sensors = 0, runs = 0, missed = 0, jitterMax = 0;
+    uint64_t jitterSum = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      if (slots[i].periodMs != periods[c]) continue;
+      const SensorTiming& t = schedule.timing(i);
+      sensors++;
+      runs += t.runs;
+      missed += t.missed;
+      jitterSum += t.jitterSumUs;
+      if (t.jitterMaxUs > jitterMax) jitterMax = t.jitterMaxUs;
+    }
+    printf(" %u x %u ms: %u runs, %u missed, jitter %.0f/%u us;", sensors, periods[c], runs, missed,
+           runs ? (double)jitterSum / runs : 0.0, jitterMax);
+    missedTotal += missed;
+  }
+  printf("\n");
+  return missedTotal;
+}
+
+// The built-in and multi-rate registries fit the ADC without a missed run;
+// all 16 at 100 Hz does not, which is what per-sensor periods are for
+static bool reportSensorRegistry() {
+  printf("sensor registry: %u B in NVS, %u decoders, %u filter presets\n", (unsigned int)sizeof(SensorRegistry),
+         SENSOR_DECODER_COUNT, SENSOR_FILTER_COUNT);
+  bool ok = reportSweepOrder("built-in", benchRegistry);
+  ok &= reportSweepOrder("all 16", fullRegistry());
+
+  // What one fixed loop would need instead: all 16 at the fastest period
+  SensorRegistry fastest = multiRateRegistry();
+  for (uint8_t i = 0; i < fastest.count; i++) fastest.sensors[i].periodMs = 10;
+  printf("sensor schedule over 60 s at %u us per channel (mean, max jitter):\n", SCHEDULER_DEFAULT_COST_US);
+  ok &= check(reportSchedule("built-in", benchRegistry, SCHEDULER_DEFAULT_COST_US) == 0,
+              "sensor schedule: the built-in registry misses runs");
+  ok &= check(reportSchedule("16, currents 100 Hz", multiRateRegistry(), SCHEDULER_DEFAULT_COST_US) == 0,
+              "sensor schedule: 16 sensors with the currents at 100 Hz miss runs");
+  ok &= check(reportSchedule("16 all 100 Hz", fastest, SCHEDULER_DEFAULT_COST_US) > 0,
+              "sensor schedule: 16 sensors at 100 Hz fit an ADC they overload");
+  return ok;
+}
+
+// One op = one pass of the sensor task (step + its delay), looping the trace;
+// the thermal loop samples along the way as its task would
+static void runMonitorStep(ReplaySensorHal& replay, SensorMonitor& monitor, bool& started, uint32_t n) {
+  static TelemetryFrame readings;
+  nativeUseVirtualClock(true);
+  if (!started) {
+    replay.restart();
+    started = monitor.begin();
+  }
+  while (n--) {
+    if (replay.finished()) replay.restart();
+    sink += monitor.step(readings);
+    for (uint32_t ms = 0; ms < SENSOR_TASK_PERIOD_MS; ms += THERMO_CONVERSION_MS) {
+      monitor.thermal().poll(millis());
+      vTaskDelay(THERMO_CONVERSION_MS / portTICK_PERIOD_MS);
+    }
+  }
+  nativeUseVirtualClock(false);
+}
+
+static void benchMonitorStep(uint32_t n) {
+  static ReplaySensorHal replay(sensorTrace, 12);
+  static SensorMonitor monitor(replay.hal(), benchRegistry);
+  static bool started = false;
+  runMonitorStep(replay, monitor, started, n);
+}
+
+// Every mux channel registered (fullRegistry())
+static void benchMonitorStepAll(uint32_t n) {
+  static ReplaySensorHal replay(sensorTrace, 12);
+  static SensorMonitor monitor(replay.hal(), fullRegistry());
+  static bool started = false;
+  runMonitorStep(replay, monitor, started, n);
+}
+
+// One op = one thermal loop sample: thermocouple read + fan staging
+static void benchThermalPoll(uint32_t n) {
+  static ReplaySensorHal replay(sensorTrace, 0);
+  static ThermalLoop thermal(replay.hal().thermocouple, replay.hal().fans);
+  static bool started = false;
+  nativeUseVirtualClock(true);
+  if (!started) {
+    replay.restart();
+    started = thermal.begin();
+  }
+  while (n--) {
+    if (replay.finished()) replay.restart();
+    sink += thermal.poll(millis());
+    vTaskDelay(THERMO_CONVERSION_MS / portTICK_PERIOD_MS);
+  }
+  nativeUseVirtualClock(false);
+}
+
+// -------- History --------
+// One op = one reading of the seven sensor fields (7 TimeSeries::add), on a
+// 1010 ms cadence like the sensor task
+static TelemetryHistory history((1u << TEL_TEMP) | (1u << TEL_B_V) | (1u << TEL_B_C) | (1u << TEL_T_V) |
+                                (1u << TEL_T_C) | (1u << TEL_C_V) | (1u << TEL_C_C));
+static uint32_t historyMs;
+
+static void benchHistoryRecord(uint32_t n) {
+  while (n--) {
+    historyMs += 1010;
+    frame.setFloat(TEL_B_C, (float)(historyMs % 977) / 100.0f);
+    history.record(historyMs, frame);
+  }
+}
+
+// Full ring at each resolution
+static void runSeriesRead(SeriesResolution res, uint32_t n) {
+  static SeriesPoint points[SERIES_MAX_POINTS];
+  const TimeSeries* series = history.series(TEL_B_C);
+  while (n--) sink += (uint32_t)series->read(res, points, SERIES_MAX_POINTS);
+}
+
+static void benchSeriesReadSeconds(uint32_t n) { runSeriesRead(SERIES_SECONDS, n); }
+static void benchSeriesReadHours(uint32_t n) { runSeriesRead(SERIES_HOURS, n); }
+
+static void benchSeriesJson(uint32_t n) {
+  static SeriesPoint points[SERIES_MAX_POINTS];
+  static char out[4096];
+  const TimeSeries* series = history.series(TEL_B_C);
+  while (n--) {
+    JsonWriter w(out, sizeof(out));
+    writeSeriesJson(w, "b_c", *series, SERIES_MINUTES, points, SERIES_MAX_POINTS, historyMs);
+    sink += (uint32_t)w.length();
+  }
+}
+
+// Three minutes of 0, 1, 2 ... once a second into a fresh series: the raw ring
+// keeps the last 32 and the minute buckets account for every sample
+static bool reportHistory() {
+  Serial.setEcho(true);
+  history.printBudget(Serial);
+  Serial.setEcho(false);
+
+  static TimeSeries series;
+  static SeriesPoint points[SERIES_MAX_POINTS];
+  for (uint32_t i = 0; i < 180; i++) series.add(i * 1000, (float)i);
+  size_t raw = series.read(SERIES_RAW, points, SERIES_MAX_POINTS);
+  bool ok = check(raw == SERIES_RAW_SAMPLES && points[0].mean == 148.0f && points[raw - 1].mean == 179.0f,
+                  "history: the raw ring does not hold the last 32 samples");
+  size_t minutes = series.read(SERIES_MINUTES, points, SERIES_MAX_POINTS);
+  uint32_t count = 0;
+  float lo = 1e9f, hi = -1e9f;
+  for (size_t i = 0; i < minutes; i++) {
+    if (!points[i].count) continue;
+    count += points[i].count;
+    if (points[i].min < lo) lo = points[i].min;
+    if (points[i].max > hi) hi = points[i].max;
+  }
+  ok &= check(count == 180 && lo == 0.0f && hi == 179.0f, "history: the minute buckets lose samples");
+  return ok;
+}
+
+// -------- Record log --------
+// The 256 KB userdata partition, in memory. Records are CBOR telemetry frames
+// (the fixture frame), as logged during an outage.
+#define LOG_PARTITION_SIZE (256 * 1024)
+#define LOG_INTERVAL_S 5 // PUBLISH_DELAY: one record per publish interval while offline
+
+static FileFlashPartition logFlash(LOG_PARTITION_SIZE);
+static RecordLog recordLog(logFlash);
+
+static void startRecordLog() {
+  static bool started = false;
+  if (!started) started = recordLog.begin();
+}
+
+// One op = one append, with the erase-ahead run whenever it is due
+static void benchLogAppend(uint32_t n) {
+  startRecordLog();
+  while (n--) {
+    sink += recordLog.append(cborBuf, cborLen, 1);
+    recordLog.maintain();
+  }
+}
+
+// One op = backfill of one record (peek + mark sent), topped up by appends
+static void benchLogBackfill(uint32_t n) {
+  static uint8_t record[256];
+  startRecordLog();
+  RecordInfo info;
+  while (n--) {
+    if (!recordLog.peekUnsent(info, record, sizeof(record))) {
+      for (int i = 0; i < 64; i++) recordLog.append(cborBuf, cborLen, 1);
+      recordLog.maintain();
+      recordLog.peekUnsent(info, record, sizeof(record));
+    }
+    sink += recordLog.markSent(info);
+  }
+}
+
+// One op = the boot scan of a full partition
+static void benchLogRecovery(uint32_t n) {
+  startRecordLog();
+  while (n--) {
+    RecordLog log(logFlash);
+    sink += log.begin();
+  }
+}
+
+// Fill, cut the power mid-append, reboot and check what came back
+static bool reportRecordLog() {
+  FileFlashPartition flash(LOG_PARTITION_SIZE);
+  RecordLog log(flash);
+  log.begin();
+  while (log.stats().dropped == 0) {
+    log.append(cborBuf, cborLen, 1);
+    log.maintain();
+  }
+  uint32_t capacity = log.stats().records;
+  flash.failAfter(RECORD_LOG_RECORD_HEADER + (uint32_t)cborLen / 2);
+  log.append(cborBuf, cborLen, 1);
+  flash.powerOn();
+
+  RecordLog rebooted(flash);
+  rebooted.begin();
+  RecordLogStats s = rebooted.stats();
+  printf("record log: %u x %u B sectors, %u records of %u B (%.1f h of outage at %u s), "
+         "after a torn append: %u records, %u torn skipped\n",
+         (unsigned int)s.sectors, (unsigned int)flash.sectorSize(), (unsigned int)capacity, (unsigned int)cborLen,
+         capacity * (LOG_INTERVAL_S / 3600.0), LOG_INTERVAL_S, (unsigned int)s.records, (unsigned int)s.recovered);
+
+  static uint8_t record[256];
+  RecordInfo info;
+  bool same = rebooted.peekUnsent(info, record, sizeof(record)) && info.length == cborLen &&
+              memcmp(record, cborBuf, cborLen) == 0;
+  bool ok = check(same, "record log: the oldest record does not read back as written");
+  ok &= check(s.records == capacity && s.recovered == 1, "record log: a torn append changed the record count");
+
+  // The sealed sector is no longer the head on the boot after: 5 records, a
+  // torn one, reboot, one more, reboot, and drain
+  FileFlashPartition small(LOG_PARTITION_SIZE);
+  RecordLog first(small);
+  first.begin();
+  for (int i = 0; i < 5; i++) first.append(cborBuf, cborLen, 1);
+  small.failAfter(RECORD_LOG_RECORD_HEADER + (uint32_t)cborLen / 2);
+  first.append(cborBuf, cborLen, 1);
+  small.powerOn();
+  RecordLog second(small);
+  second.begin();
+  second.append(cborBuf, cborLen, 1);
+  RecordLog third(small);
+  third.begin();
+  uint32_t sent = 0;
+  while (third.peekUnsent(info, record, sizeof(record)) && third.markSent(info)) sent++;
+  RecordLogStats d = third.stats();
+  printf("  torn, append, reboot: %u records, %u sent, %u unsent, %u torn skipped\n", (unsigned int)d.records,
+         (unsigned int)sent, (unsigned int)d.unsent, (unsigned int)d.recovered);
+  ok &= check(sent == 6 && d.records == 6 && d.unsent == 0 && d.recovered == 1,
+              "record log: a torn record in a sealed sector counts as a record");
+  return ok;
+}
+
+// -------- Energy --------
+// The sensor replay at the sensor task's 1 s pace into an EnergyMeter, against
+// what a server integrating the 5 s publishes (each value held for 5 s) gets
+// from the same readings; plus the NVS saves the schedule makes and a torn
+// save falling back to the other slot.
+#define ENERGY_PUBLISH_MS 5000
+
+static bool reportEnergy() {
+  ReplaySensorHal replay(sensorTrace, 12);
+  SensorMonitor monitor(replay.hal(), benchRegistry);
+  EnergyMeter meter;
+  TelemetryFrame readings;
+  nativeUseVirtualClock(true);
+  replay.restart();
+  monitor.begin();
+
+  double serverTegWh = 0, serverChargerWh = 0;
+  uint32_t start = millis(), lastPublish = 0;
+  bool published = false;
+  EnergyCounters slots[2];
+  memset(slots, 0, sizeof(slots));
+  while (!replay.finished()) {
+    monitor.thermal().poll(millis());
+    monitor.step(readings);
+    uint32_t now = millis();
+    meter.update(readings, now);
+    if (meter.saveDue(now)) {
+      EnergyCounters c = meter.checkpoint();
+      slots[c.sequence & 1] = c;
+      meter.markSaved(c, now);
+    }
+    if (!published || now - lastPublish >= ENERGY_PUBLISH_MS) {
+      published = true;
+      lastPublish = now;
+      serverTegWh += readings.t_v * readings.t_c * ENERGY_PUBLISH_MS / 3.6e6;
+      serverChargerWh += readings.c_v * readings.c_c * ENERGY_PUBLISH_MS / 3.6e6;
+    }
+    vTaskDelay(SENSOR_TASK_PERIOD_MS / portTICK_PERIOD_MS);
+  }
+  uint32_t elapsed = millis() - start;
+  nativeUseVirtualClock(false);
+
+  const EnergyCounters& c = meter.counters();
+  double hours = elapsed / 3.6e6;
+  printf("energy: %.1f min at %u ms: TEG %.3f Wh on device, %.3f Wh from 5 s publishes; charger %.3f / %.3f Wh; "
+         "battery out %.3f Wh, net %.3f Ah, soc %.1f %%\n",
+         elapsed / 60000.0, SENSOR_TASK_PERIOD_MS, c.tegUj / UJ_PER_WH, serverTegWh, c.chargerUj / UJ_PER_WH,
+         serverChargerWh, c.batteryOutUj / UJ_PER_WH, (c.chargeInUc - c.chargeOutUc) / UC_PER_AH, meter.soc());
+
+  EnergyCounters newest, fallback;
+  bool found = newerEnergyCounters(slots[0], slots[1], newest);
+  EnergyCounters& torn = slots[newest.sequence & 1];
+  ((uint8_t*)&torn)[20] ^= 0x01; // power cut mid-write
+  bool recovered = newerEnergyCounters(slots[0], slots[1], fallback);
+  printf("  NVS: %u saves of %u B (%.0f/day), newest #%u; torn #%u falls back to #%u%s\n", meter.saves(),
+         (unsigned int)sizeof(EnergyCounters), meter.saves() / hours * 24, found ? newest.sequence : 0,
+         newest.sequence, recovered ? fallback.sequence : 0, recovered ? "" : " (none left)");
+
+  // Held 5 s values and the 1 s integration see the same slow trace
+  bool ok = check(fabs(c.tegUj / UJ_PER_WH - serverTegWh) < 0.01 * serverTegWh &&
+                  fabs(c.chargerUj / UJ_PER_WH - serverChargerWh) < 0.01 * serverChargerWh,
+                  "energy: device and publish integration differ by over 1 %");
+  ok &= check(found && recovered && fallback.sequence + 1 == newest.sequence,
+              "energy: a torn save does not fall back to the slot before it");
+  return ok;
+}
+
+// One op = one sensor pass worth of integration: five rails, SOC, schedule check
+static void benchEnergyUpdate(uint32_t n) {
+  static EnergyMeter meter;
+  static uint32_t ms;
+  TelemetryFrame readings = frame;
+  while (n--) {
+    ms += SENSOR_TASK_PERIOD_MS;
+    readings.setFloat(TEL_T_C, (float)(ms % 977) / 1000.0f);
+    meter.update(readings, ms);
+    sink += meter.saveDue(ms);
+  }
+}
+
+// -------- Burst capture --------
+// Battery current at rest (ch1: 0.39 V offset) with a 1000-count, 40 ms inrush
+// every 3 s; the charger (ch5) is only noise. One watch per sensor pass.
+static SyntheticAdcHal burstAdc() {
+  SyntheticAdcHal adc;
+  SyntheticWaveform battery = { 484.0f, 0.0f, 0, 6, 120000, 1600, 1000.0f };
+  SyntheticWaveform charger = { 298.0f, 0.0f, 0, 6, 0, 0, 0.0f };
+  adc.setWaveform(1, battery);
+  adc.setWaveform(5, charger);
+  return adc;
+}
+
+static bool reportBurst() {
+  SyntheticAdcHal adc = burstAdc();
+  BurstCapture capture;
+  BurstWatcher watcher(adc, capture);
+  static uint8_t blob[BURST_BLOB_MAX];
+  static uint8_t streamed[BURST_BLOB_MAX];
+  static BurstRecord decoded;
+  nativeUseVirtualClock(true);
+
+  uint32_t published = 0, bytes = 0, samples = 0, mismatches = 0, pre = 0, pieceMismatches = 0;
+  for (int pass = 0; pass < 10; pass++) {
+    watcher.watch(1000);
+    delay(1000); // the synthetic HAL does not block: move the clock over the watched second
+    const BurstRecord* record = capture.ready();
+    if (!record) continue;
+    size_t len = encodeBurst(*record, blob, sizeof(blob));
+    if (!decodeBurst(blob, len, decoded) || decoded.count != record->count ||
+        memcmp(decoded.value, record->value, record->count * sizeof(uint16_t)) ||
+        memcmp(decoded.tick, record->tick, record->count * sizeof(uint16_t))) {
+      mismatches++;
+    }
+    // As the board publishes it: sized, then encoded 128 B at a time
+    size_t total = encodeBurstPart(*record, 0, nullptr, 0);
+    for (size_t at = 0; at < total; at += 128) {
+      encodeBurstPart(*record, at, streamed + at, total - at < 128 ? total - at : 128);
+    }
+    if (total != len || memcmp(streamed, blob, len)) pieceMismatches++;
+    published++;
+    bytes += len;
+    samples += record->count;
+    pre = record->triggerIndex;
+    capture.release();
+  }
+  nativeUseVirtualClock(false);
+
+  printf("burst: %u triggers, %u captures, %u dropped over 10 s, %u blocks, %u short reads\n",
+         capture.triggers(), capture.captures(), capture.dropped(), watcher.blocks(), watcher.shortReads());
+  if (published) {
+    printf("  %u samples/capture (%u before the trigger), %u B/blob vs %u B raw, %u round-trip mismatches\n",
+           samples / published, pre, bytes / published, samples / published * 4, mismatches);
+  }
+  // An inrush every 3 s over 10 s
+  bool ok = check(published == 3 && capture.dropped() == 0, "burst: not one capture per inrush");
+  ok &= check(mismatches == 0, "burst: a capture does not survive the blob round trip");
+  ok &= check(pieceMismatches == 0, "burst: the piecewise encoding differs from the whole blob");
+  return ok;
+}
+
+// One op = one 256-conversion block of a quiet channel: decimate, ring, tests
+static void benchBurstFeed(uint32_t n) {
+  static SyntheticAdcHal adc = burstAdc();
+  static BurstCapture capture;
+  static uint16_t block[BURST_BLOCK];
+  static uint32_t us;
+  adc.selectChannel(5);
+  adc.read(block, BURST_BLOCK, 0);
+  capture.nextChannel();
+  while (n--) {
+    capture.feed(5, block, BURST_BLOCK, us, us / 1000, false);
+    us += BURST_BLOCK * 25;
+  }
+  sink += capture.triggers();
+}
+
+static void benchBurstEncode(uint32_t n) {
+  static SyntheticAdcHal adc = burstAdc();
+  static BurstRecord record;
+  static uint8_t blob[BURST_BLOB_MAX];
+  static uint16_t raw[BURST_MAX_SAMPLES];
+  adc.selectChannel(1);
+  adc.read(raw, BURST_MAX_SAMPLES, 0);
+  record.count = BURST_MAX_SAMPLES;
+  for (uint16_t i = 0; i < BURST_MAX_SAMPLES; i++) {
+    record.value[i] = raw[i] << 4;
+    record.tick[i] = i;
+  }
+  while (n--) sink += encodeBurst(record, blob, sizeof(blob));
+}
+
+// -------- Sensor pipeline --------
+// Acquisition -> processing handoff as on the board (Sensors.cpp): SensorSamples
+// through a 16-deep ring, one thread each side. The producer retries a full
+// ring here so every item arrives; the board drops instead.
+#define PIPELINE_QUEUE_DEPTH 16
+#define PIPELINE_ITEMS 1000000
+
+static SensorSample pipelineSample(uint32_t seq) {
+  SensorSample sample;
+  memset(&sample, 0, sizeof(sample));
+  sample.sequence = seq;
+  sample.count = 6;
+  for (uint8_t i = 0; i < sample.count; i++) {
+    sample.readings[i].channel = benchRegistry.sensors[i].channel;
+    sample.readings[i].field = benchRegistry.sensors[i].field;
+    sample.readings[i].raw = (uint16_t)(2000 << ADC_VALUE_FRAC_BITS);
+    sample.readings[i].value = 12.5f + i;
+  }
+  return sample;
+}
+
+struct PipelineRun {
+  uint32_t fullRetries;
+  uint32_t outOfOrder;
+  uint32_t highWater;
+};
+
+// Hands n samples from one thread to another; the consumer checks the order
+static PipelineRun runPipeline(uint32_t n) {
+  static SpscQueue<SensorSample, PIPELINE_QUEUE_DEPTH> queue;
+  static uint32_t sequence;
+  PipelineRun run = {0, 0, 0};
+  uint32_t dropsBefore = queue.dropped();
+  uint32_t first = sequence + 1;
+
+  std::thread producer([n]() {
+    SensorSample sample = pipelineSample(0);
+    for (uint32_t i = 0; i < n; i++) {
+      sample.sequence = ++sequence;
+      while (!queue.push(sample)) std::this_thread::yield();
+    }
+  });
+  SensorSample out;
+  for (uint32_t expect = first; expect < first + n;) {
+    if (!queue.pop(out)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (out.sequence != expect) run.outOfOrder++;
+    expect++;
+  }
+  producer.join();
+  run.fullRetries = queue.dropped() - dropsBefore;
+  run.highWater = queue.highWater();
+  return run;
+}
+
+// A consumer that keeps up leaves the ring at most one deep; a full one drops
+static bool checkSpscQueue() {
+  SpscQueue<int, 16> queue;
+  int out = 0;
+  bool ok = true;
+  for (int i = 0; i < 20; i++) ok &= queue.push(i) && queue.pop(out) && out == i;
+  ok &= check(queue.highWater() == 1 && queue.size() == 0, "SpscQueue: high water of a drained ring is not 1");
+  for (int i = 0; i < 17; i++) queue.push(i);
+  ok &= check(queue.highWater() == 16 && queue.dropped() == 1 && queue.size() == 16,
+              "SpscQueue: a full ring does not report 16 deep and one dropped");
+  return ok;
+}
+
+static bool reportPipeline() {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  PipelineRun run = runPipeline(PIPELINE_ITEMS);
+  double s = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / 1e9;
+  printf("pipeline: %u samples (%u B) across threads in %.3f s, %.2f M/s on %u hardware thread(s)\n",
+         PIPELINE_ITEMS, (unsigned)sizeof(SensorSample), s, PIPELINE_ITEMS / s / 1e6,
+         std::thread::hardware_concurrency());
+  printf("  ring %u deep: peak %u, %u pushes found it full, %u out of order\n", PIPELINE_QUEUE_DEPTH,
+         run.highWater, run.fullRetries, run.outOfOrder);
+  return check(run.outOfOrder == 0 && run.highWater <= PIPELINE_QUEUE_DEPTH, "pipeline: samples arrived out of order");
+}
+
+// One op = one sample pushed and popped on the same thread: the ring's own cost
+static void benchSpscPushPop(uint32_t n) {
+  static SpscQueue<SensorSample, PIPELINE_QUEUE_DEPTH> queue;
+  SensorSample sample = pipelineSample(0), out = sample;
+  while (n--) {
+    sample.sequence++;
+    queue.push(sample);
+    queue.pop(out);
+    sink += out.sequence;
+  }
+}
+
+// One op = one sample across threads (thread start included)
+static void benchSpscThreads(uint32_t n) { sink += runPipeline(n).outOfOrder; }
+
+// One op = one 6-reading sample merged into the frame by the processing stage
+static void benchSampleMerge(uint32_t n) {
+  static ReplaySensorHal replay(sensorTrace, 0);
+  static ThermalLoop thermal(replay.hal().thermocouple, replay.hal().fans);
+  static SensorProcessor processor(thermal);
+  static TelemetryFrame readings;
+  SensorSample sample = pipelineSample(0);
+  while (n--) {
+    sample.readings[0].value += 0.01f;
+    processor.merge(sample, readings);
+  }
+  sink += processor.merged();
+}
+
+// -------- Profiler --------
+#if PROFILER
+// A span fed known durations (its quantiles and histogram), and the host as a
+// profiled task that was busy a quarter of one window
+PROFILE_SPAN(spreadSpan, "bench.spread");
+PROFILE_SPAN(hostSpan, "bench.host");
+PROFILE_SPAN(scopeSpan, "bench.scope");
+
+static bool reportProfile() {
+  for (uint32_t i = 0; i < 1000; i++) spreadSpan.record(i < 990 ? 90 + i % 20 : 20000 + i);
+  nativeUseVirtualClock(true);
+  profileTask(hostSpan);
+  profileTick(millis());
+  for (int i = 0; i < 15; i++) hostSpan.record(1000000);
+  delay(PROFILE_WINDOW_MS);
+  bool sampled = profileTick(millis());
+  nativeUseVirtualClock(false);
+
+  ProfileStats stats;
+  spreadSpan.read(stats);
+  printf("profile: 990 runs of 90-109 us and 10 of ~20 ms: mean %u us, p50 <= %u us, p99 <= %u us, max %u us\n",
+         (unsigned)(stats.totalUs / stats.count), profileQuantileUs(stats, 0.5f),
+         profileQuantileUs(stats, 0.99f), stats.maxUs);
+  ProfileTasks tasks;
+  memset(&tasks, 0, sizeof(tasks));
+  if (sampled && profileTasks(tasks) && tasks.count) {
+    printf("  task %s: %.1f %% busy over %u ms (15 s of spans)\n", tasks.tasks[0].name, tasks.tasks[0].cpuPercent,
+           tasks.windowMs);
+  }
+  static char json[4096];
+  JsonWriter w(json, sizeof(json));
+  writeProfileJson(w);
+  printf("  JSON: %u B for %u spans%s\n", (unsigned)w.length(), profileSpanCount(), w.truncated() ? " (truncated)" : "");
+
+  // 90-109 us fall in the 64-127 us bucket; 15 s of a 60 s window is 25 %
+  bool ok = check(stats.count == 1000 && profileQuantileUs(stats, 0.5f) == 127 && stats.maxUs == 20999,
+                  "profile: span quantiles do not match the durations fed");
+  ok &= check(sampled && tasks.count && fabs(tasks.tasks[0].cpuPercent - 25.0f) < 0.5f,
+              "profile: the host task is not 25 % busy over the window");
+  ok &= check(!w.truncated(), "profile: /profile JSON truncated");
+  return ok;
+}
+
+// One op = an empty timed scope: two cycle counter and tick reads, one record
+static void benchProfileScope(uint32_t n) {
+  while (n--) {
+    PROFILE_SCOPE(scopeSpan);
+  }
+}
+
+static void benchProfileJson(uint32_t n) {
+  static char json[4096];
+  while (n--) {
+    JsonWriter w(json, sizeof(json));
+    writeProfileJson(w);
+    sink += w.length();
+  }
+}
+#endif // PROFILER
+
+static void benchSeqlockRead(uint32_t n) {
+  static Seqlock<TelemetryFrame> lock;
+  lock.write(frame);
+  TelemetryFrame out;
+  while (n--) sink += lock.read(out);
+}
+
+// -------- Seqlock stress --------
+
+static const uint32_t SEQLOCK_WRITES = 200000;
+
+// Write k: every float field, the epoch and every change epoch read k, so a
+// copy mixing two writes shows up as a field that disagrees with the epoch
+static void seqlockStressFrame(TelemetryFrame& f, uint32_t k) {
+  f.present = 0;
+  for (uint8_t i = 0; i < TEL_FIELD_COUNT; i++) {
+    if (telemetryFields[i].kind == TEL_KIND_FLOAT) f.setFloat((TelemetryField)i, (float)k);
+    f.changedAt[i] = k;
+  }
+  f.epoch = k;
+}
+
+static bool seqlockStressTorn(const TelemetryFrame& f) {
+  for (uint8_t i = 0; i < TEL_FIELD_COUNT; i++) {
+    if (f.changedAt[i] != f.epoch) return true;
+    if (telemetryFields[i].kind == TEL_KIND_FLOAT && f.getFloat((TelemetryField)i, -1.0f) != (float)f.epoch) return true;
+  }
+  return false;
+}
+
+// One writer and one reader thread hammer a Seqlock<TelemetryFrame>; every
+// copy the reader gets must be a single write, and never an older one
+static bool checkSeqlockThreads() {
+  static Seqlock<TelemetryFrame> lock;
+  std::atomic<bool> done(false);
+  uint32_t reads = 0, misses = 0, torn = 0, backwards = 0;
+
+  std::thread writer([&done]() {
+    TelemetryFrame f;
+    for (uint32_t k = 1; k <= SEQLOCK_WRITES; k++) {
+      seqlockStressFrame(f, k);
+      lock.write(f);
+    }
+    done.store(true, std::memory_order_release);
+  });
+  TelemetryFrame out;
+  uint32_t last = 0;
+  while (!done.load(std::memory_order_acquire)) {
+    if (!lock.read(out)) {
+      misses++;
+      continue;
+    }
+    reads++;
+    if (out.epoch == 0) continue; // before the first write
+    if (seqlockStressTorn(out)) torn++;
+    if (out.epoch < last) backwards++;
+    last = out.epoch;
+  }
+  writer.join();
+
+  printf("seqlock: %u writes of %u B, %u reads, %u gave up on the writer, %u torn, %u older than the last\n",
+         SEQLOCK_WRITES, (unsigned)sizeof(TelemetryFrame), reads, misses, torn, backwards);
+  bool ok = check(torn == 0, "Seqlock: a reader copied a torn frame");
+  ok &= check(backwards == 0, "Seqlock: a reader went back to an older frame");
+  return ok;
+}
+
+static const BenchCase benches[] = {
+  {"serialize/telemetry-json", benchTelemetryJson, 0},
+  {"serialize/telemetry-cbor", benchTelemetryCbor, 0},
+  {"format/dtostrf", benchFormatDtostrf, 0},
+  {"format/snprintf", benchFormatSnprintf, 0},
+  {"format/fixed", benchFormatFixed, 0},
+  {"format/lcd-line", benchLcdLine, 0},
+  {"lookup/telemetry-typed", benchLookupTyped, 0},
+  {"parse/command-tokenize", benchTokenize, 0},
+  {"parse/command-dispatch", benchDispatch, 0},
+  {"parse/telemetry-cbor", benchCborDecode, 0},
+  {"parse/gsm-csq", benchGsmCsq, ALLOCS_ANY},
+  {"sensors/convert", benchSensorMath, 0},
+  {"sensors/calibrated-convert", benchCalibrationConvert, 0},
+  {"sensors/seqlock-read", benchSeqlockRead, 0},
+  {"sensors/adc-sweep", benchAdcSweep, 0},
+  {"sensors/monitor-step", benchMonitorStep, 0},
+  {"sensors/monitor-step-16", benchMonitorStepAll, 0},
+  {"sensors/thermal-poll", benchThermalPoll, 0},
+  {"series/record-7-fields", benchHistoryRecord, 0},
+  {"series/read-1s-ring", benchSeriesReadSeconds, 0},
+  {"series/read-1h-ring", benchSeriesReadHours, 0},
+  {"series/json-1m", benchSeriesJson, 0},
+  {"log/append", benchLogAppend, 0},
+  {"log/backfill-one", benchLogBackfill, 0},
+  {"log/recovery-scan-256k", benchLogRecovery, 0},
+  {"energy/update", benchEnergyUpdate, 0},
+  {"burst/feed-256", benchBurstFeed, 0},
+  {"burst/encode-1536", benchBurstEncode, 0},
+  {"pipeline/spsc-push-pop", benchSpscPushPop, 0},
+  {"pipeline/spsc-2-threads", benchSpscThreads, ALLOCS_ANY},
+  {"pipeline/sample-merge", benchSampleMerge, 0},
+#if PROFILER
+  {"profile/scope", benchProfileScope, 0},
+  {"profile/json", benchProfileJson, 0},
+#endif
+  {"filter/mean-per-sample", benchFilterMean, 0},
+  {"filter/current-chain-per-sample", benchFilterCurrent, 0},
+  {"filter/median7-iir-per-sample", benchFilterHeavy, 0},
+};
+
+static double elapsedNs(std::chrono::steady_clock::time_point start) {
+  return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Doubles the iteration count until a run takes BENCH_MIN_TIME_MS, then
+// reports that run
+static bool runBench(const BenchCase& bench) {
+  bench.run(1); // warm up lazily initialised state
+
+  uint32_t iterations = 1;
+  for (;;) {
+    NativeHeapStats before = nativeHeap;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bench.run(iterations);
+    double ns = elapsedNs(start);
+
+    if (ns >= BENCH_MIN_TIME_MS * 1e6 || iterations >= (1u << 30)) {
+      double allocs = (double)(nativeHeap.allocs - before.allocs) / iterations;
+      double bytes = (double)(nativeHeap.bytes - before.bytes) / iterations;
+      bool ok = bench.maxAllocsPerOp < 0 || allocs <= bench.maxAllocsPerOp;
+      printf("%-32s %12.1f ns/op %8.2f allocs/op %8.1f B/op%s\n", bench.name, ns / iterations, allocs, bytes,
+             ok ? "" : "  FAIL: allocates");
+      return ok;
+    }
+    iterations *= 2;
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* filter = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--trace=", 8) == 0) {
+      if (!loadTrace(argv[i] + 8)) {
+        fprintf(stderr, "cannot read trace %s\n", argv[i] + 8);
+        return 2;
+      }
+    } else if (strncmp(argv[i], "--replay=", 9) == 0) {
+      if (!sensorTrace.load(argv[i] + 9)) {
+        fprintf(stderr, "cannot read sensor trace %s\n", argv[i] + 9);
+        return 2;
+      }
+      sensorTraceSource = argv[i] + 9;
+    } else {
+      filter = argv[i];
+    }
+  }
+
+  Serial.setEcho(false); // GsmClient debug output
+  modemSerial.onLine(modemReply);
+  fillFixtures();
+  if (traceLen == 0) synthesizeTrace();
+  if (sensorTrace.size() == 0) synthesizeSensorTrace();
+  bool ok = true;
+  if (!filter || strstr(filter, "serialize")) ok &= reportPayloadSize();
+  if (!filter || strstr(filter, "parse")) ok &= checkCommandFuzz();
+  if (!filter || strstr(filter, "filter")) ok &= reportTrace();
+  if (!filter || strstr(filter, "monitor")) ok &= reportSensorRegistry();
+  if (!filter || strstr(filter, "monitor")) ok &= reportReplay();
+  if (!filter || strstr(filter, "series")) ok &= reportHistory();
+  if (!filter || strstr(filter, "log")) ok &= reportRecordLog();
+  if (!filter || strstr(filter, "energy")) ok &= reportEnergy();
+  if (!filter || strstr(filter, "burst")) ok &= reportBurst();
+  if (!filter || strstr(filter, "seqlock")) ok &= checkSeqlockThreads();
+  if (!filter || strstr(filter, "pipeline")) ok &= checkSpscQueue();
+  if (!filter || strstr(filter, "pipeline")) ok &= reportPipeline();
+#if PROFILER
+  if (!filter || strstr(filter, "profile")) ok &= reportProfile();
+#endif
+
+  for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+    if (filter && !strstr(benches[i].name, filter)) continue;
+    ok &= runBench(benches[i]);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Minimal host build of the Arduino-ESP32 core, enough for the platform-free
+// parts of lib/ (see native/README)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "stdlib_noniso.h"
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+#include "HardwareSerial.h"
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+// Host only: with the virtual clock on, millis()/micros() stop following the
+// wall clock and move only by what delays skip, so replays are deterministic
+void nativeUseVirtualClock(bool enabled);
+
+#endif // NATIVE_ARDUINO_H
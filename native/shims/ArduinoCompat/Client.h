@@ -0,0 +1,7 @@
+#ifndef NATIVE_ARDUINO_COMPAT_CLIENT_H
+#define NATIVE_ARDUINO_COMPAT_CLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+
+#endif // NATIVE_ARDUINO_COMPAT_CLIENT_H
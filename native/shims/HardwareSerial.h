@@ -0,0 +1,48 @@
+#ifndef NATIVE_HARDWARE_SERIAL_H
+#define NATIVE_HARDWARE_SERIAL_H
+
+#include <string>
+#include "Stream.h"
+
+// A UART with a scriptable far end. Bytes the firmware writes are echoed to
+// stdout (unless muted) and collected into lines; a line handler can answer
+// by queueing bytes with inject(), which read() then returns. That is enough
+// to drive an AT-command modem conversation on the host.
+class HardwareSerial : public Stream {
+public:
+  typedef void (*LineHandler)(HardwareSerial& port, const char* line, void* context);
+
+  explicit HardwareSerial(int uart) : uart(uart), echo(uart == 0), handler(nullptr), handlerContext(nullptr) {}
+
+  void begin(unsigned long, uint32_t = 0, int8_t = -1, int8_t = -1) {}
+  void end() {}
+
+  void setEcho(bool enabled) { echo = enabled; }
+  void onLine(LineHandler h, void* context = nullptr) { handler = h; handlerContext = context; }
+  void inject(const char* data) { rx.append(data); }
+  void inject(const uint8_t* data, size_t size) { rx.append((const char*)data, size); }
+  const std::string& transmitted() const { return tx; }
+  void clearTransmitted() { tx.clear(); }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  int available() override { return (int)rx.size(); }
+  int read() override;
+  int peek() override { return rx.empty() ? -1 : (uint8_t)rx[0]; }
+  void flush() override {}
+
+private:
+  int uart;
+  bool echo;
+  LineHandler handler;
+  void* handlerContext;
+  std::string rx;
+  std::string tx;
+  std::string line;
+};
+
+extern HardwareSerial Serial;
+
+#endif // NATIVE_HARDWARE_SERIAL_H
@@ -0,0 +1,18 @@
+#ifndef NATIVE_IPADDRESS_H
+#define NATIVE_IPADDRESS_H
+
+#include <cstdint>
+
+class IPAddress {
+public:
+  IPAddress() : octets{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+
+  uint8_t operator[](int index) const { return octets[index]; }
+  uint8_t& operator[](int index) { return octets[index]; }
+
+private:
+  uint8_t octets[4];
+};
+
+#endif // NATIVE_IPADDRESS_H
@@ -0,0 +1,21 @@
+#ifndef NATIVE_HEAP_H
+#define NATIVE_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Heap traffic seen by the native build: operator new/delete and the String
+// shim both report here, so a benchmark can count allocations per operation.
+struct NativeHeapStats {
+  uint64_t allocs;
+  uint64_t frees;
+  uint64_t bytes;
+};
+
+extern NativeHeapStats nativeHeap;
+
+void* nativeMalloc(size_t size);
+void* nativeRealloc(void* ptr, size_t size);
+void nativeFree(void* ptr);
+
+#endif // NATIVE_HEAP_H
@@ -0,0 +1,150 @@
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+#include <cstdlib>
+#include <cstring>
+#include "NativeHeap.h"
+#include "Print.h"
+#include "stdlib_noniso.h"
+
+// Host stand-in for Arduino's String. It keeps the allocation behaviour of the
+// arduino-esp32 class that matters for benchmarks: a small inline buffer, then
+// exact-size reallocs every time the contents grow.
+class String {
+public:
+  String(const char* cstr = "") { init(); if (cstr) copy(cstr, strlen(cstr)); }
+  String(const String& other) { init(); copy(other.buffer(), other.len); }
+  String(String&& other) { init(); move(other); }
+  explicit String(char c) { init(); copy(&c, 1); }
+  explicit String(int value) { init(); format("%ld", (long)value); }
+  explicit String(unsigned int value) { init(); format("%lu", (unsigned long)value); }
+  explicit String(long value) { init(); format("%ld", value); }
+  explicit String(unsigned long value) { init(); format("%lu", value); }
+  explicit String(float value, unsigned int decimals = 2) { init(); fromDouble(value, decimals); }
+  explicit String(double value, unsigned int decimals = 2) { init(); fromDouble(value, decimals); }
+  ~String() { if (heap) nativeFree(heap); }
+
+  String& operator=(const String& rhs) { if (this != &rhs) copy(rhs.buffer(), rhs.len); return *this; }
+  String& operator=(String&& rhs) { if (this != &rhs) move(rhs); return *this; }
+  String& operator=(const char* cstr) { copy(cstr ? cstr : "", cstr ? strlen(cstr) : 0); return *this; }
+
+  bool reserve(unsigned int size) {
+    if (size <= capacity()) return true;
+    char* p = (char*)nativeRealloc(heap, size + 1);
+    if (!p) return false;
+    if (!heap) memcpy(p, sso, len + 1);
+    heap = p;
+    cap = size;
+    return true;
+  }
+
+  bool concat(const char* cstr, unsigned int length) {
+    if (!cstr) return false;
+    if (length == 0) return true;
+    if (!reserve(len + length)) return false;
+    memmove(wbuffer() + len, cstr, length);
+    len += length;
+    wbuffer()[len] = '\0';
+    return true;
+  }
+  bool concat(const char* cstr) { return cstr && concat(cstr, strlen(cstr)); }
+  bool concat(const String& s) { return concat(s.buffer(), s.len); }
+  bool concat(char c) { return concat(&c, 1); }
+
+  String& operator+=(const String& rhs) { concat(rhs); return *this; }
+  String& operator+=(const char* cstr) { concat(cstr); return *this; }
+  String& operator+=(char c) { concat(c); return *this; }
+  String& operator+=(int value) { String s(value); concat(s); return *this; }
+
+  friend String operator+(const String& lhs, const String& rhs) { String r(lhs); r += rhs; return r; }
+  friend String operator+(const String& lhs, const char* rhs) { String r(lhs); r += rhs; return r; }
+  friend String operator+(const char* lhs, const String& rhs) { String r(lhs); r += rhs; return r; }
+
+  bool operator==(const String& rhs) const { return len == rhs.len && memcmp(buffer(), rhs.buffer(), len) == 0; }
+  bool operator==(const char* cstr) const { return strcmp(buffer(), cstr ? cstr : "") == 0; }
+  bool operator!=(const String& rhs) const { return !(*this == rhs); }
+  bool operator!=(const char* cstr) const { return !(*this == cstr); }
+  char operator[](unsigned int index) const { return index < len ? buffer()[index] : '\0'; }
+
+  const char* c_str() const { return buffer(); }
+  unsigned int length() const { return len; }
+
+  int indexOf(char c, unsigned int from = 0) const {
+    if (from >= len) return -1;
+    const char* p = strchr(buffer() + from, c);
+    return p ? (int)(p - buffer()) : -1;
+  }
+  int indexOf(const char* s, unsigned int from = 0) const {
+    if (from >= len) return -1;
+    const char* p = strstr(buffer() + from, s);
+    return p ? (int)(p - buffer()) : -1;
+  }
+  int indexOf(const String& s, unsigned int from = 0) const { return indexOf(s.c_str(), from); }
+
+  String substring(unsigned int from) const { return substring(from, len); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    if (from >= len) return String();
+    if (to > len) to = len;
+    String out;
+    out.copy(buffer() + from, to - from);
+    return out;
+  }
+
+  long toInt() const { return atol(buffer()); }
+  float toFloat() const { return (float)atof(buffer()); }
+
+private:
+  enum { SSO_CAPACITY = 11 }; // matches the 32-bit arduino-esp32 layout
+
+  char sso[SSO_CAPACITY + 1];
+  char* heap;
+  unsigned int cap;
+  unsigned int len;
+
+  void init() { sso[0] = '\0'; heap = nullptr; cap = SSO_CAPACITY; len = 0; }
+  const char* buffer() const { return heap ? heap : sso; }
+  char* wbuffer() { return heap ? heap : sso; }
+  unsigned int capacity() const { return cap; }
+
+  void copy(const char* cstr, unsigned int length) {
+    if (!reserve(length)) return;
+    memmove(wbuffer(), cstr, length);
+    len = length;
+    wbuffer()[len] = '\0';
+  }
+
+  void move(String& rhs) {
+    if (heap) nativeFree(heap);
+    init();
+    if (rhs.heap) {
+      heap = rhs.heap;
+      cap = rhs.cap;
+      len = rhs.len;
+      rhs.init();
+    } else {
+      copy(rhs.sso, rhs.len);
+    }
+  }
+
+  void format(const char* fmt, long value) {
+    char buf[24];
+    int n = snprintf(buf, sizeof(buf), fmt, value);
+    copy(buf, (unsigned int)n);
+  }
+  void format(const char* fmt, unsigned long value) {
+    char buf[24];
+    int n = snprintf(buf, sizeof(buf), fmt, value);
+    copy(buf, (unsigned int)n);
+  }
+
+  void fromDouble(double value, unsigned int decimals) {
+    char buf[33];
+    dtostrf(value, decimals + 2, decimals, buf);
+    copy(buf, strlen(buf));
+  }
+};
+
+inline size_t Print::print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+
+#endif // NATIVE_WSTRING_H
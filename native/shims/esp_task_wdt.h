@@ -0,0 +1,15 @@
+#ifndef NATIVE_ESP_TASK_WDT_H
+#define NATIVE_ESP_TASK_WDT_H
+
+#include <cstdint>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+// The task watchdog is a no-op on the host
+inline esp_err_t esp_task_wdt_init(uint32_t, bool) { return ESP_OK; }
+inline esp_err_t esp_task_wdt_add(void*) { return ESP_OK; }
+inline esp_err_t esp_task_wdt_reset() { return ESP_OK; }
+inline esp_err_t esp_task_wdt_deinit() { return ESP_OK; }
+
+#endif // NATIVE_ESP_TASK_WDT_H
@@ -0,0 +1,11 @@
+#ifndef NATIVE_FREERTOS_TASK_H
+#define NATIVE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+// There is no scheduler on the host: a delay advances the simulated clock that
+// millis() reads instead of sleeping, so timeout loops finish immediately.
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+
+#endif // NATIVE_FREERTOS_TASK_H
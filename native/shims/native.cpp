@@ -0,0 +1,90 @@
+#include <Arduino.h>
+#include <chrono>
+#include <new>
+
+// -------- Clock --------
+// Real elapsed time plus whatever vTaskDelay()/delay() skipped over
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+static uint64_t skippedUs = 0;
+static bool virtualClock = false;
+
+static uint64_t realUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long micros() {
+  return (unsigned long)((virtualClock ? 0 : realUs()) + skippedUs);
+}
+
+// Folds the real time into the skipped time (or back out) so the clock never
+// jumps backwards
+void nativeUseVirtualClock(bool enabled) {
+  if (enabled == virtualClock) return;
+  if (enabled) skippedUs += realUs();
+  else skippedUs -= realUs();
+  virtualClock = enabled;
+}
+
+unsigned long millis() { return micros() / 1000; }
+
+void delay(uint32_t ms) { skippedUs += (uint64_t)ms * 1000; }
+
+void vTaskDelay(TickType_t ticks) { delay(ticks * portTICK_PERIOD_MS); }
+
+TickType_t xTaskGetTickCount() { return (TickType_t)(millis() / portTICK_PERIOD_MS); }
+
+// -------- Serial --------
+HardwareSerial Serial(0);
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (echo) fputc(c, stdout);
+  tx.push_back((char)c);
+  if (c == '\r' || c == '\n') {
+    if (!line.empty() && handler) handler(*this, line.c_str(), handlerContext);
+    line.clear();
+  } else {
+    line.push_back((char)c);
+  }
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  for (size_t i = 0; i < size; i++) write(buffer[i]);
+  return size;
+}
+
+int HardwareSerial::read() {
+  if (rx.empty()) return -1;
+  uint8_t c = (uint8_t)rx[0];
+  rx.erase(0, 1);
+  return c;
+}
+
+// -------- Heap accounting --------
+NativeHeapStats nativeHeap = {0, 0, 0};
+
+void* nativeMalloc(size_t size) { return nativeRealloc(nullptr, size); }
+
+void* nativeRealloc(void* ptr, size_t size) {
+  nativeHeap.allocs++;
+  nativeHeap.bytes += size;
+  return realloc(ptr, size);
+}
+
+void nativeFree(void* ptr) {
+  if (!ptr) return;
+  nativeHeap.frees++;
+  free(ptr);
+}
+
+void* operator new(size_t size) {
+  void* p = nativeMalloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { nativeFree(p); }
+void operator delete[](void* p) noexcept { nativeFree(p); }
+void operator delete(void* p, size_t) noexcept { nativeFree(p); }
+void operator delete[](void* p, size_t) noexcept { nativeFree(p); }
@@ -0,0 +1,69 @@
+#ifndef NATIVE_STDLIB_NONISO_H
+#define NATIVE_STDLIB_NONISO_H
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Same algorithm as arduino-esp32's cores/esp32/stdlib_noniso.c, so formatted
+// floats match the device byte for byte
+inline char* dtostrf(double number, signed int width, unsigned int prec, char* s) {
+  bool negative = false;
+
+  if (std::isnan(number)) {
+    strcpy(s, "nan");
+    return s;
+  }
+  if (std::isinf(number)) {
+    strcpy(s, "inf");
+    return s;
+  }
+
+  char* out = s;
+  int fillme = width;
+  if (prec > 0) fillme -= (prec + 1);
+
+  if (number < 0.0) {
+    negative = true;
+    fillme--;
+    number = -number;
+  }
+
+  // Round correctly so that print(1.999, 2) prints as "2.00"
+  double rounding = 2.0;
+  for (uint32_t i = 0; i < prec; ++i) rounding *= 10.0;
+  rounding = 1.0 / rounding;
+  number += rounding;
+
+  double tenpow = 1.0;
+  int digitcount = 1;
+  double nextpow;
+  while (number >= (nextpow = (10.0 * tenpow))) {
+    tenpow = nextpow;
+    digitcount++;
+  }
+
+  number *= 1 + DBL_EPSILON;
+  number /= tenpow;
+  fillme -= digitcount;
+
+  while (fillme-- > 0) *out++ = ' ';
+  if (negative) *out++ = '-';
+
+  digitcount += prec;
+  int8_t digit = 0;
+  while (digitcount-- > 0) {
+    digit = (int8_t)number;
+    if (digit > 9) digit = 9;
+    *out++ = (char)('0' | digit);
+    if ((digitcount == (int)prec) && (prec > 0)) *out++ = '.';
+    number -= digit;
+    number *= 10.0;
+  }
+
+  *out = 0;
+  return s;
+}
+
+#endif // NATIVE_STDLIB_NONISO_H
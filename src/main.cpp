@@ -1,6 +1,11 @@
 #include <Arduino.h>
 #include "Connectivity.h"
 #include "Sensors.h"
+#include "Calibration.h"
+#include "TelemetryCbor.h"
+#include "CommandDispatcher.h"
+#include "RecordLog.h"
+#include "Esp32FlashPartition.h"
 #include <Update.h>
 // #include "OTAUpdate.h"
 #include <LiquidCrystal.h>
@@ -21,6 +26,9 @@ const int LCD_D7 = 14;
 #define LCD_COLS 20
 #define LCD_ROWS 4
 #define DEBUG 0
+#define TELEMETRY_KEYFRAME_INTERVAL 12 // full document every 12th publish (~1 min)
+#define RECORD_TELEMETRY 1             // RecordLog record type: full CBOR telemetry frame
+#define PROFILE_JSON_MAX 4096          // the profile topic's payload (PROFILER builds)
 
 LiquidCrystal lcd(LCD_RS, LCD_EN, LCD_D4, LCD_D5, LCD_D6, LCD_D7);
 AsyncWebServer server(80);
@@ -28,6 +36,18 @@ AsyncWebServer server(80);
 TaskHandle_t connectivityHandle;
 TaskHandle_t sensorsHandle;
 IPAddress ip;
+TelemetryFrame data; // owned by loop(): sensor snapshot + connectivity fields
+TelemetryDelta telemetryDelta(TELEMETRY_KEYFRAME_INTERVAL);
+uint32_t publishedSession = 0;
+// Telemetry recorded while offline, sent on publishTopicBackfill after reconnect
+Esp32FlashPartition userdataPartition("userdata", 0x81);
+RecordLog telemetryLog(userdataPartition);
+bool telemetryLogReady = false;
+unsigned long lastLogged = 0;
+
+// The loop's work between its delays, and the LCD refresh within it (Profiler.h)
+PROFILE_SPAN(loopSpan, "loop");
+PROFILE_SPAN(lcdSpan, "loop.lcd");
 
 // ========== LCD Custom Characters ==========
 byte lcdBars[6][8] = {
@@ -166,6 +186,12 @@ void updateLCDLine(uint8_t row, const String &text);
 void monitorTaskSetup(); 
 void setupWebServer();
 void startWebServer();
+void handleSeriesRequest(AsyncWebServerRequest *request);
+void handleMqttCommand(const char* payload, size_t length);
+void logTelemetry(bool online);
+void publishBurst();
+void publishProfile();
+void handleProfileRequest(AsyncWebServerRequest *request);
 
 
 
@@ -174,12 +200,22 @@ void setup() {
     Serial.begin(115200);
     initLCD();
     displayHeader();
+    setMqttMessageHandler(handleMqttCommand);
+    telemetryLogReady = telemetryLog.begin();
+    if (!telemetryLogReady) Serial.println("Telemetry log: no userdata partition");
+    else if (DEBUG) {
+        RecordLogStats s = telemetryLog.stats();
+        Serial.printf("Telemetry log: %u records, %u unsent, %u torn skipped\n",
+                      (unsigned)s.records, (unsigned)s.unsent, (unsigned)s.recovered);
+    }
     monitorTaskSetup();
     setupWebServer(); // Set up server routes, but don't start it yet
+    PROFILE_TASK(loopSpan);
 }
 
 // ========== Loop ==========
 void loop() {
+    PROFILE_SCOPE(loopSpan);
 //     if (status.activeConnection == "WiFi" && WiFi.status() != WL_CONNECTED) {
 //         WiFi.reconnect();
 //     }
@@ -197,34 +233,126 @@ void loop() {
     // Serial.println("version: " + String(currentVersion));
 
     if (isUpdating) {
+        PROFILE_SCOPE_END(loopSpan);
         vTaskDelay(500 / portTICK_PERIOD_MS);
         return;
     }
+    // Take a consistent copy of the latest sensor sweep
+    TelemetryFrame sample;
+    if (sensorSnapshot.read(sample)) {
+        data.merge(sample);
+    }
+
     // Update LCD Display
-    displayConnectivity();
-    displaySensorData();
-    displayOtherStatus();
+    {
+        PROFILE_SCOPE(lcdSpan);
+        displayConnectivity();
+        displaySensorData();
+        displayOtherStatus();
+    }
 
     // Prepare and send JSON data
-    char payload[512];
-    data.set("uptime", String(millis() / 1000).c_str());
-    data.set("active_conn", status.activeConnection == "None" ? -1 : (status.activeConnection == "WiFi" ? 0: (status.activeConnection == "Cellular" ? 1 : -1)));
+    char payload[TELEMETRY_PAYLOAD_MAX];
+    data.set<TEL_UPTIME>(millis() / 1000);
+    data.set<TEL_ACTIVE_CONN>(status.activeConnection == "None" ? -1 : (status.activeConnection == "WiFi" ? 0: (status.activeConnection == "Cellular" ? 1 : -1)));
     if(status.activeConnection == "WiFi") {
-        data.set("sig_rssi", String(status.wifiRssi).c_str());
+        data.set<TEL_SIG_RSSI>(status.wifiRssi);
     } else if(status.activeConnection == "Cellular") {
-        data.set("sig_rssi", String(status.cellularCsq).c_str());
+        data.set<TEL_SIG_RSSI>(status.cellularCsq);
     }
-    data.set("ble_status", status.bleDeviceConnected);
+    data.set<TEL_BLE_STATUS>(status.bleDeviceConnected);
     // Serial.println("BLE status: " + String(status.bleDeviceConnected));
-    data.set("ip", ip.toString().c_str());
-    data.set("ver", String(currentVersion).c_str());
+    data.set<TEL_IP>(makeTelemetryIp(ip[0], ip[1], ip[2], ip[3]));
+    data.set<TEL_VER>(makeTelemetryText(currentVersion));
 
-    data.toCharArray(payload, sizeof(payload));
-    sendDataToMQTT(payload);
+    // Changed fields only, with a keyframe periodically and after every reconnect
+    if (status.mqttSessions != publishedSession || status.snapshotRequested) {
+        telemetryDelta.forceKeyframe();
+        publishedSession = status.mqttSessions;
+    }
+    bool keyframe = true;
+    uint32_t fields = telemetryDelta.select(data, &keyframe);
+
+    size_t payloadLen = 0;
+    bool published = false;
+    if (activePayloadFormat() == PAYLOAD_CBOR) {
+        if (encodeTelemetryCbor(data, (uint8_t*)payload, sizeof(payload), &payloadLen, fields)) {
+            published = sendDataToMQTT((const uint8_t*)payload, payloadLen, !keyframe);
+        } else {
+            Serial.printf("Payload truncated (%u > %u bytes), not sent\n", (unsigned)payloadLen, (unsigned)sizeof(payload));
+        }
+    } else if (data.serialize(payload, sizeof(payload), &payloadLen, fields)) {
+        published = sendDataToMQTT(payload, !keyframe);
+    } else {
+        Serial.printf("Payload truncated (%u > %u bytes), not sent\n", (unsigned)payloadLen, (unsigned)(sizeof(payload) - 1));
+    }
+    if (published) telemetryDelta.published();
+    logTelemetry(status.activeConnection != "None" && status.mqttConnected);
+    publishBurst();
+    publishProfile();
 
+    PROFILE_SCOPE_END(loopSpan);
     vTaskDelay(500 / portTICK_PERIOD_MS);
 }
 
+// Offline: record a full CBOR frame every publish interval. Online: send the
+// oldest unsent record, one per loop so live telemetry keeps its slot.
+void logTelemetry(bool online) {
+    if (!telemetryLogReady) return;
+    uint8_t record[256];
+    if (!online) {
+        if (millis() - lastLogged >= config.publishIntervalMs) {
+            size_t len = 0;
+            if (encodeTelemetryCbor(data, record, sizeof(record), &len, TEL_ALL_FIELDS)) {
+                telemetryLog.append(record, len, RECORD_TELEMETRY);
+            }
+            lastLogged = millis();
+        }
+    } else {
+        RecordInfo info;
+        if (telemetryLog.peekUnsent(info, record, sizeof(record))) {
+            bool ok = info.type != RECORD_TELEMETRY || info.length > sizeof(record) ||
+                      sendBackfillToMQTT(record, info.length);
+            if (ok) telemetryLog.markSent(info); // unknown or oversized records are skipped
+        }
+    }
+    telemetryLog.maintain();
+}
+
+// A captured transient goes out on its own topic as soon as it can; until
+// then it is held and later triggers are only counted (burstCapture.dropped()).
+// The blob is encoded piecewise as the client writes it, so none of it is held.
+static size_t burstBytes(size_t offset, uint8_t* out, size_t size, const void* record) {
+    size_t len = encodeBurstPart(*(const BurstRecord*)record, offset, out, size);
+    return offset < len ? min(size, len - offset) : 0;
+}
+
+void publishBurst() {
+    const BurstRecord* record = burstCapture.ready();
+    if (!record) return;
+    size_t len = encodeBurstPart(*record, 0, nullptr, 0);
+    if (len == 0 || sendBurstToMQTT(len, burstBytes, record)) burstCapture.release();
+}
+
+// Each profile window goes out once on the profile topic, with the spans as
+// they stand; a window missed while offline is replaced by the next
+void publishProfile() {
+#if PROFILER
+    static uint32_t publishedWindow = 0;
+    static char json[PROFILE_JSON_MAX];
+    ProfileTasks tasks;
+    if (!profileTasks(tasks) || tasks.sequence == publishedWindow) return;
+    JsonWriter w(json, sizeof(json));
+    writeProfileJson(w);
+    if (w.truncated()) {
+        Serial.printf("Profile truncated (> %u bytes), not sent\n", (unsigned)sizeof(json));
+        publishedWindow = tasks.sequence;
+    } else if (sendProfileToMQTT(json, w.length())) {
+        publishedWindow = tasks.sequence;
+    }
+#endif
+}
+
 // ========== Initialization Functions ==========
 void initLCD() {
     lcd.begin(LCD_COLS, LCD_ROWS);
@@ -268,15 +396,18 @@ void displayConnectivity() {
 }
 
 void displaySensorData() {
-    char line_data[32];
-    String line1 = "T:" + String(data.getFloat("temp"), 1) + "C";
-    line1 += " V:" + String(data.getFloat("b_v"), 2) + "V";
-    line1 += " I:" + String(data.getFloat("b_c"), 2) + "A";
+    static const TelemetryLcdCell sensorLine[] = {
+        {TEL_TEMP, "T:", "C", 1},
+        {TEL_B_V, " V:", "V", 2},
+        {TEL_B_C, " I:", "A", 2},
+    };
+    char line1[48];
+    size_t len = renderTelemetryLine(data, sensorLine, sizeof(sensorLine) / sizeof(sensorLine[0]), line1, sizeof(line1));
 
     updateLCDLine(1, line1);
 
-    if (line1.length() > LCD_COLS) {
-        updateLCDLine(2, line1.substring(LCD_COLS));
+    if (len > LCD_COLS) {
+        updateLCDLine(2, line1 + LCD_COLS);
     } else {
         updateLCDLine(2, "");
     }
@@ -297,10 +428,7 @@ void displayOtherStatus() {
                 updateLCDLine(3, "IP: " + WiFi.localIP().toString() + ":80");
                 break;
             case 2:
-                char uptime_buf[128];
-                data.getString("uptime", uptime_buf, sizeof(uptime_buf));
-                // uptime_buf[sizeof(uptime_buf)] = '\0';
-                updateLCDLine(3, "UPTIME: " + String(uptime_buf) + "s");
+                updateLCDLine(3, "UPTIME: " + String(data.get<TEL_UPTIME>()) + "s");
                 break;
             case 3:
                 updateLCDLine(3, "SERVER: " + String(serverRunning ? "Running" : "Not Running"));
@@ -340,6 +468,225 @@ void updateLCDLine(uint8_t row, const String &text) {
         lcd.print(text.substring(start, end));
     }
 }
+// ========== MQTT Commands ==========
+// {"cmd":"interval","ms":10000}  publish interval, 1 s .. 1 h
+static bool cmdInterval(const JsonView& args) {
+    long ms;
+    if (!args.getInt("ms", ms) || ms < 1000 || ms > 3600000) return false;
+    config.publishIntervalMs = (uint32_t)ms;
+    return true;
+}
+
+// {"cmd":"fan","mask":5} forces fans 0 and 2 on; {"cmd":"fan","auto":true} releases
+static bool cmdFan(const JsonView& args) {
+    bool automatic;
+    if (args.getBool("auto", automatic) && automatic) {
+        setFanOverride(-1);
+        return true;
+    }
+    long mask;
+    if (!args.getInt("mask", mask) || mask < 0 || mask > 0xFF) return false;
+    setFanOverride((int)mask);
+    return true;
+}
+
+// {"cmd":"fan_stage","stage":1,"on":80,"off":70} moves a stage's thresholds
+// (C, off < on, stages ascending); "mask" sets its fans and adds the stage
+// after the last one; "hold_ms" sets the minimum run before stepping down.
+// Stored in NVS.
+static bool cmdFanStage(const JsonView& args) {
+    FanControlConfig config = fanConfig();
+    long stage;
+    if (!args.getInt("stage", stage) || stage < 1 || stage > config.stageCount + 1 || stage > FAN_MAX_STAGES) return false;
+    FanStage& s = config.stages[stage - 1];
+    long mask;
+    if (args.getInt("mask", mask)) {
+        if (mask < 0 || mask > 0xFF) return false;
+        s.mask = (uint8_t)mask;
+    } else if (stage > config.stageCount) {
+        return false; // a new stage needs its fans
+    }
+    if (stage > config.stageCount) config.stageCount = (uint8_t)stage;
+    args.getFloat("on", s.onC);
+    args.getFloat("off", s.offC);
+    long holdMs;
+    if (args.getInt("hold_ms", holdMs)) {
+        if (holdMs < 0 || holdMs > 3600000) return false;
+        config.minHoldMs = (uint32_t)holdMs;
+    }
+    return configureFans(config);
+}
+
+// {"cmd":"sensor","ch":6,"decoder":"pin_v","field":"aux0"} reads mux channel
+// 6 into aux0 from the next sensor pass on, or changes what is set on a
+// channel that is already read. Decoders: voltage, current, pin_v, raw.
+// Optional "filter" (mean, voltage, current; default: the decoder's),
+// "period_ms" (10-60000; default 1000) and "deadline_ms" (read within this
+// of each period's start; default, or 0: the period). Stored in NVS.
+// {"cmd":"sensor_remove","ch":6} stops reading a channel.
+static int telemetryFieldByKey(const char* key, size_t length) {
+    for (int f = 0; f < TEL_FIELD_COUNT; f++) {
+        if (strlen(telemetryFields[f].key) == length && strncmp(telemetryFields[f].key, key, length) == 0) return f;
+    }
+    return -1;
+}
+
+static bool cmdSensor(const JsonView& args) {
+    long ch;
+    if (!args.getInt("ch", ch) || ch < 0 || ch >= ADC_MAX_CHANNELS) return false;
+    SensorRegistry registry = sensorRegistry();
+    int existing = findSensor(registry, (uint8_t)ch);
+    SensorConfig sensor;
+    if (existing >= 0) {
+        sensor = registry.sensors[existing];
+    } else {
+        memset(&sensor, 0, sizeof(sensor));
+        sensor.channel = (uint8_t)ch;
+        sensor.periodMs = 1000;
+    }
+
+    const char* name;
+    size_t length;
+    if (args.getString("decoder", name, length)) {
+        int decoder = sensorDecoderByName(name, length);
+        if (decoder < 0) return false;
+        if (existing < 0 || decoder != sensor.decoder) sensor.filter = sensorDecoders[decoder].filter;
+        sensor.decoder = (uint8_t)decoder;
+    } else if (existing < 0) {
+        return false; // a new sensor needs its decoder
+    }
+    if (args.getString("field", name, length)) {
+        int field = telemetryFieldByKey(name, length);
+        if (field < 0) return false;
+        sensor.field = (uint8_t)field;
+    } else if (existing < 0) {
+        return false; // ... and its field
+    }
+    if (args.getString("filter", name, length)) {
+        int filter = sensorFilterByName(name, length);
+        if (filter < 0) return false;
+        sensor.filter = (uint8_t)filter;
+    }
+    long ms;
+    if (args.getInt("period_ms", ms)) {
+        if (ms < SENSOR_MIN_PERIOD_MS || ms > SENSOR_MAX_PERIOD_MS) return false;
+        sensor.periodMs = (uint16_t)ms;
+    }
+    if (args.getInt("deadline_ms", ms)) {
+        if (ms < 0 || ms > sensor.periodMs) return false;
+        sensor.deadlineMs = (uint16_t)ms;
+    }
+    if (sensor.deadlineMs > sensor.periodMs) sensor.deadlineMs = 0; // a shorter period than before
+    return setSensor(registry, sensor) && configureSensors(registry);
+}
+
+static bool cmdSensorRemove(const JsonView& args) {
+    long ch;
+    if (!args.getInt("ch", ch) || ch < 0 || ch >= ADC_MAX_CHANNELS) return false;
+    SensorRegistry registry = sensorRegistry();
+    return removeSensor(registry, (uint8_t)ch) && configureSensors(registry);
+}
+
+// {"cmd":"energy","reset":true} zeroes the Wh/Ah counters; "soc":80 sets the
+// battery's state of charge (%) and "capacity_ah":10 its capacity
+static bool cmdEnergy(const JsonView& args) {
+    bool reset = false;
+    float soc = NAN, capacityAh = NAN;
+    args.getBool("reset", reset);
+    args.getFloat("soc", soc);
+    args.getFloat("capacity_ah", capacityAh);
+    if (!reset && std::isnan(soc) && std::isnan(capacityAh)) return false;
+    return configureEnergy(reset, soc, capacityAh);
+}
+
+// {"cmd":"burst","ch":1,"above":1450,"slope":160} captures ~300 ms of mux
+// channel 1 around the first sample (ADC counts, mean of 8 conversions) at or
+// over 1450, or 160 counts off the one before; "below" fires at or under a
+// level. Unset tests are off; an existing rule keeps the ones not given.
+// {"cmd":"burst","ch":1,"off":true} disarms the channel. Stored in NVS.
+static bool cmdBurst(const JsonView& args) {
+    long ch;
+    if (!args.getInt("ch", ch) || ch < 0 || ch >= ADC_MAX_CHANNELS) return false;
+    BurstConfig config = burstConfig();
+    bool off = false;
+    if (args.getBool("off", off) && off) return removeBurstRule(config, (uint8_t)ch) && configureBurst(config);
+
+    int existing = findBurstRule(config, (uint8_t)ch);
+    BurstRule rule;
+    if (existing >= 0) {
+        rule = config.rules[existing];
+    } else {
+        memset(&rule, 0, sizeof(rule));
+        rule.channel = (uint8_t)ch;
+    }
+    long counts;
+    if (args.getInt("above", counts)) rule.above = (uint16_t)(counts < 0 || counts > 4095 ? 0xFFFF : counts);
+    if (args.getInt("below", counts)) rule.below = (uint16_t)(counts < 0 || counts > 4095 ? 0xFFFF : counts);
+    if (args.getInt("slope", counts)) rule.slope = (uint16_t)(counts < 0 || counts > 4095 ? 0xFFFF : counts);
+    return setBurstRule(config, rule) && configureBurst(config); // out of range fails validation
+}
+
+// {"cmd":"snapshot"} publishes a full keyframe on the next loop
+static bool cmdSnapshot(const JsonView&) {
+    status.snapshotRequested = true;
+    return true;
+}
+
+// Calibration, per mux channel: apply a known reference, then
+// {"cmd":"cal","ch":1,"value":2.5} records the filtered reading against it.
+// After two or more points {"cmd":"cal_fit","ch":1} stores a fitted line
+// ("points":true: piecewise through the points; "efuse":true: fit against the
+// chip-characterised millivolts; "zero_below":5 reads values under 5 as 0).
+// {"cmd":"cal_reset","ch":1} returns to the built-in curve.
+static bool calibrationChannel(const JsonView& args, uint8_t& channel) {
+    long ch;
+    if (!args.getInt("ch", ch) || ch < 0 || ch >= CAL_MAX_CHANNELS) return false;
+    channel = (uint8_t)ch;
+    return true;
+}
+
+static bool cmdCal(const JsonView& args) {
+    uint8_t channel;
+    float value;
+    if (!calibrationChannel(args, channel) || !args.getFloat("value", value)) return false;
+    return captureCalibrationPoint(channel, value) > 0;
+}
+
+static bool cmdCalFit(const JsonView& args) {
+    uint8_t channel;
+    if (!calibrationChannel(args, channel)) return false;
+    bool piecewise = false, efuse = false;
+    float zeroBelow = 0;
+    args.getBool("points", piecewise);
+    args.getBool("efuse", efuse);
+    args.getFloat("zero_below", zeroBelow);
+    return fitChannelCalibration(channel, piecewise, efuse, zeroBelow);
+}
+
+static bool cmdCalReset(const JsonView& args) {
+    uint8_t channel;
+    return calibrationChannel(args, channel) && resetChannelCalibration(channel);
+}
+
+static const CommandHandler commandHandlers[] = {
+    {"interval", cmdInterval},
+    {"fan", cmdFan},
+    {"snapshot", cmdSnapshot},
+    {"cal", cmdCal},
+    {"cal_fit", cmdCalFit},
+    {"cal_reset", cmdCalReset},
+    {"fan_stage", cmdFanStage},
+    {"sensor", cmdSensor},
+    {"sensor_remove", cmdSensorRemove},
+    {"energy", cmdEnergy},
+    {"burst", cmdBurst},
+};
+
+void handleMqttCommand(const char* payload, size_t length) {
+    CommandResult result = dispatchCommand(payload, length, commandHandlers, sizeof(commandHandlers) / sizeof(commandHandlers[0]));
+    if (result != CMD_OK) Serial.printf("Command rejected: %s\n", commandResultName(result));
+}
+
 void monitorTaskSetup() {
     xTaskCreatePinnedToCore(
         monitorConnectivityTask,
@@ -351,17 +698,78 @@ void monitorTaskSetup() {
         0
     );
 
+    // Acquisition; starts the processing and aggregation stages
     xTaskCreatePinnedToCore(
         monitorSensorsTask,
         "MonitorSensors",
         2176, // 2.2 KB stack
         NULL,
-        1,
+        2,
         &sensorsHandle,
         1
     );
 }
 
+// ========== Sensor History ==========
+// GET /series lists the recorded fields; /series?field=b_v&res=1m&n=30 returns
+// the newest n points of one field as [start_ms,min,max,mean,count] (res: raw,
+// 1s, 1m or 1h; the last bucket is still filling). Served from the rollups, so
+// a request costs the same whatever the resolution.
+void handleSeriesRequest(AsyncWebServerRequest *request) {
+    static SeriesPoint points[SERIES_MAX_POINTS]; // web server task only
+
+    if (!request->hasParam("field")) {
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        JsonWriter w(*response);
+        w.beginObject();
+        w.key("fields");
+        w.beginArray();
+        for (int f = 0; f < TEL_FIELD_COUNT; f++) {
+            if (!((sensorHistory.fields() >> f) & 1u)) continue;
+            w.item();
+            w.value(telemetryFields[f].key);
+        }
+        w.endArray();
+        w.endObject();
+        request->send(response);
+        return;
+    }
+
+    SeriesResolution res = SERIES_MINUTES;
+    if (request->hasParam("res") && !parseSeriesResolution(request->getParam("res")->value().c_str(), res)) {
+        request->send(400, "text/plain", "res must be raw, 1s, 1m or 1h");
+        return;
+    }
+    long n = request->hasParam("n") ? request->getParam("n")->value().toInt() : SERIES_MAX_POINTS;
+    if (n < 1 || n > SERIES_MAX_POINTS) n = SERIES_MAX_POINTS;
+
+    const String& name = request->getParam("field")->value();
+    const TimeSeries* series = nullptr;
+    for (int f = 0; f < TEL_FIELD_COUNT && !series; f++) {
+        if (name == telemetryFields[f].key) series = sensorHistory.series((TelemetryField)f);
+    }
+    if (!series) {
+        request->send(404, "text/plain", "no history for that field");
+        return;
+    }
+
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    JsonWriter w(*response);
+    writeSeriesJson(w, name.c_str(), *series, res, points, (size_t)n, millis());
+    request->send(response);
+}
+
+// GET /profile: every span's count, mean, p50/p99 bounds, max and log2
+// histogram, and each task's CPU and free stack over the last window
+#if PROFILER
+void handleProfileRequest(AsyncWebServerRequest *request) {
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    JsonWriter w(*response);
+    writeProfileJson(w);
+    request->send(response);
+}
+#endif
+
 void startWebServer() {
   server.begin();
   if (DEBUG) Serial.println("HTTP server started");
@@ -381,6 +789,22 @@ void setupWebServer() {
     request->send(200, "text/html", serverIndex);
   });
 
+  // Sensor history (see handleSeriesRequest)
+  server.on("/series", HTTP_GET, [](AsyncWebServerRequest *request){
+    if(!request->authenticate(username, password))
+      return request->requestAuthentication();
+    handleSeriesRequest(request);
+  });
+
+#if PROFILER
+  // Timing spans and task load (see handleProfileRequest)
+  server.on("/profile", HTTP_GET, [](AsyncWebServerRequest *request){
+    if(!request->authenticate(username, password))
+      return request->requestAuthentication();
+    handleProfileRequest(request);
+  });
+#endif
+
   // OTA Update handling
   server.on("/update", HTTP_POST, [](AsyncWebServerRequest *request){
     // This is the success handler, which is called after the upload is complete.